@@ -0,0 +1,60 @@
+# Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Opt-in compression of the tensors sent between workers."""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import contextlib
+
+from tensorflow.core.framework import attr_value_pb2
+from tensorflow.python.framework import ops
+
+
+@contextlib.contextmanager
+def experimental_tensor_compression_scope(allow=True):
+  """Allows or forbids compressing the outputs of the ops in the scope.
+
+  NOTE: This is an experimental feature.
+
+  When the `RPCOptions.tensor_compression` of the session config is set, the
+  float outputs of the ops created in this scope are compressed with it when
+  they are sent to another worker. The outputs of other ops are always sent
+  uncompressed. The lossy compressions are only suited to values that
+  tolerate rounding, e.g. gradients, and should not be used for variables
+  read from parameter servers.
+
+  Example usage:
+    config = tf.ConfigProto()
+    config.rpc_options.tensor_compression = config.rpc_options.SHUFFLE_SNAPPY
+    with tf.device("/job:worker/task:1"):
+      with tf.contrib.distribute.experimental_tensor_compression_scope():
+        g = tf.gradients(loss, v)  # compressed when received by task 0
+      h = tf.square(x)  # not compressed
+
+  Args:
+    allow: Whether the outputs of the ops in the scope may be compressed.
+
+  Yields:
+    Nothing.
+  """
+  attrs = {
+      "_allow_tensor_compression": attr_value_pb2.AttrValue(b=bool(allow))
+  }
+  # pylint: disable=protected-access
+  with ops.get_default_graph()._attr_scope(attrs):
+    yield
+  # pylint: enable=protected-access
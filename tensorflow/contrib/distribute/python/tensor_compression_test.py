@@ -0,0 +1,48 @@
+# Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for the opt-in compression of the tensors sent between workers."""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+from tensorflow.contrib.distribute.python import tensor_compression
+from tensorflow.python.framework import constant_op
+from tensorflow.python.framework import ops
+from tensorflow.python.ops import math_ops
+from tensorflow.python.platform import test
+
+
+class TensorCompressionScopeTest(test.TestCase):
+
+  def testScope(self):
+    with ops.Graph().as_default():
+      a = constant_op.constant(1.0)
+      with tensor_compression.experimental_tensor_compression_scope():
+        b = math_ops.square(a)
+        with tensor_compression.experimental_tensor_compression_scope(
+            allow=False):
+          c = math_ops.square(b)
+        d = math_ops.square(c)
+
+    with self.assertRaises(ValueError):
+      a.op.get_attr("_allow_tensor_compression")
+    self.assertTrue(b.op.get_attr("_allow_tensor_compression"))
+    self.assertFalse(c.op.get_attr("_allow_tensor_compression"))
+    self.assertTrue(d.op.get_attr("_allow_tensor_compression"))
+
+
+if __name__ == "__main__":
+  test.main()
@@ -32,6 +32,7 @@ See the @{$python/contrib.layers} guide.
 @@dense_to_sparse
 @@dropout
 @@elu
+@@embedding_bag
 @@embedding_lookup_unique
 @@flatten
 @@fully_connected
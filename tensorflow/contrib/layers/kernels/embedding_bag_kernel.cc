@@ -0,0 +1,305 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Contains the fused EmbeddingBag op and its gradient.
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/bounds_check.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/prefetch.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+namespace {
+
+enum class Combiner { kSum, kMean, kSqrtn };
+
+Status ParseCombiner(const string& combiner, Combiner* result) {
+  if (combiner == "sum") {
+    *result = Combiner::kSum;
+  } else if (combiner == "mean") {
+    *result = Combiner::kMean;
+  } else if (combiner == "sqrtn") {
+    *result = Combiner::kSqrtn;
+  } else {
+    return errors::InvalidArgument("Unknown combiner: ", combiner);
+  }
+  return Status::OK();
+}
+
+// How many ids ahead of the one being combined the rows of params are
+// prefetched.  Embedding lookups are dominated by cache misses on rows
+// scattered over a large table.
+constexpr int64 kPrefetchDistance = 8;
+
+// Checks the segment_ids and weights inputs, and sets 'num_segments' to the
+// number of segments they define.
+Status ValidateSegments(const Tensor& segment_ids, const Tensor& weights,
+                        int64* num_segments) {
+  if (!TensorShapeUtils::IsVector(segment_ids.shape())) {
+    return errors::InvalidArgument("segment_ids must be a vector: ",
+                                   segment_ids.shape().DebugString());
+  }
+  if (!TensorShapeUtils::IsVector(weights.shape())) {
+    return errors::InvalidArgument("weights must be a vector: ",
+                                   weights.shape().DebugString());
+  }
+  const int64 num_ids = segment_ids.NumElements();
+  if (weights.NumElements() != 0 && weights.NumElements() != num_ids) {
+    return errors::InvalidArgument(
+        "weights must be empty or have one element per segment id, got ",
+        weights.NumElements(), " weights for ", num_ids, " segment ids");
+  }
+  auto segment_ids_vec = segment_ids.vec<int32>();
+  *num_segments = 0;
+  for (int64 i = 0; i < num_ids; ++i) {
+    const int32 segment_id = internal::SubtleMustCopy(segment_ids_vec(i));
+    if (segment_id < *num_segments - 1) {
+      return errors::InvalidArgument("segment ids are not increasing");
+    }
+    if (segment_id < 0) {
+      return errors::InvalidArgument("segment ids must be >= 0");
+    }
+    *num_segments = segment_id + 1;
+  }
+  return Status::OK();
+}
+
+// Returns the factor by which the weighted sum of the rows [start, end) is
+// multiplied.  A null 'weights' gives all rows a weight of 1.
+template <typename T>
+T CombinerScale(Combiner combiner, const T* weights, int64 start, int64 end) {
+  if (combiner == Combiner::kSum) return T(1);
+  if (weights == nullptr) {
+    const T count = static_cast<T>(end - start);
+    return combiner == Combiner::kMean ? T(1) / count
+                                       : T(1) / std::sqrt(count);
+  }
+  T sum = 0;
+  for (int64 i = start; i < end; ++i) {
+    sum += combiner == Combiner::kMean ? weights[i] : weights[i] * weights[i];
+  }
+  return combiner == Combiner::kMean ? T(1) / sum : T(1) / std::sqrt(sum);
+}
+
+// Calls combine_segment(segment, start, end) for every segment in
+// [0, num_segments), where [start, end) is the range of the sorted
+// 'segment_ids' equal to segment.  Segments are split into ranges combined on
+// the CPU worker threads, so that each segment is handled by a single thread.
+template <typename CombineSegment>
+void ForEachSegment(OpKernelContext* context, const int32* segment_ids,
+                    int64 num_ids, int64 num_segments, int64 row_size,
+                    const CombineSegment& combine_segment) {
+  auto work = [&](int64 begin_segment, int64 end_segment) {
+    int64 start =
+        std::lower_bound(segment_ids, segment_ids + num_ids, begin_segment) -
+        segment_ids;
+    for (int64 segment = begin_segment; segment < end_segment; ++segment) {
+      int64 end = start;
+      while (end < num_ids && segment_ids[end] == segment) ++end;
+      combine_segment(segment, start, end);
+      start = end;
+    }
+  };
+  const int64 ids_per_segment = std::max<int64>(num_ids / num_segments, 1);
+  auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers, num_segments,
+        ids_per_segment * row_size, work);
+}
+
+}  // namespace
+
+template <typename T, typename Tidx>
+class EmbeddingBagOp : public OpKernel {
+ public:
+  explicit EmbeddingBagOp(OpKernelConstruction* context) : OpKernel(context) {
+    string combiner;
+    OP_REQUIRES_OK(context, context->GetAttr("combiner", &combiner));
+    OP_REQUIRES_OK(context, ParseCombiner(combiner, &combiner_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& params = context->input(0);
+    const Tensor& ids = context->input(1);
+    const Tensor& segment_ids = context->input(2);
+    const Tensor& weights = context->input(3);
+
+    OP_REQUIRES(context, TensorShapeUtils::IsVectorOrHigher(params.shape()),
+                errors::InvalidArgument("params must be at least 1-D: ",
+                                        params.shape().DebugString()));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(ids.shape()),
+                errors::InvalidArgument("ids must be a vector: ",
+                                        ids.shape().DebugString()));
+    const int64 num_ids = ids.NumElements();
+    OP_REQUIRES(context, segment_ids.NumElements() == num_ids,
+                errors::InvalidArgument(
+                    "segment_ids and ids must have the same size, got ",
+                    segment_ids.NumElements(), " and ", num_ids));
+    int64 num_segments;
+    OP_REQUIRES_OK(context,
+                   ValidateSegments(segment_ids, weights, &num_segments));
+
+    // The ids are copied once and params are only indexed with the copies,
+    // so that a concurrent update of the input can't bypass the check.
+    const int64 num_rows = params.dim_size(0);
+    auto ids_vec = ids.vec<Tidx>();
+    std::vector<Tidx> ids_copy(num_ids);
+    for (int64 i = 0; i < num_ids; ++i) {
+      const Tidx id = internal::SubtleMustCopy(ids_vec(i));
+      OP_REQUIRES(context, FastBoundsCheck(id, num_rows),
+                  errors::InvalidArgument("ids[", i, "] = ", id,
+                                          " is out of range [0, ", num_rows,
+                                          ")"));
+      ids_copy[i] = id;
+    }
+
+    TensorShape output_shape = params.shape();
+    output_shape.set_dim(0, num_segments);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, output_shape, &output));
+    if (output->NumElements() == 0) return;
+
+    auto params_flat = params.flat_outer_dims<T>();
+    auto output_flat = output->flat_outer_dims<T>();
+    const int64 row_size = params_flat.dimension(1);
+    const int64 row_bytes = row_size * sizeof(T);
+    const Tidx* ids_data = ids_copy.data();
+    const T* weights_data =
+        weights.NumElements() == 0 ? nullptr : weights.vec<T>().data();
+
+    // Accumulates the rows of params for the ids [start, end) directly into
+    // the output, prefetching the rows of the next ids while doing so.
+    auto combine_segment = [&](int64 segment, int64 start, int64 end) {
+      auto out = output_flat.template chip<0>(segment);
+      out.setZero();
+      for (int64 i = start; i < end; ++i) {
+        if (i + kPrefetchDistance < num_ids) {
+          const char* row = reinterpret_cast<const char*>(
+              &params_flat(ids_data[i + kPrefetchDistance], 0));
+          for (int64 offset = 0; offset < row_bytes; offset += 64) {
+            port::prefetch<port::PREFETCH_HINT_T0>(row + offset);
+          }
+        }
+        auto row = params_flat.template chip<0>(ids_data[i]);
+        if (weights_data == nullptr) {
+          out += row;
+        } else {
+          out += row * weights_data[i];
+        }
+      }
+      if (combiner_ != Combiner::kSum && start < end) {
+        out = out * CombinerScale(combiner_, weights_data, start, end);
+      }
+    };
+    ForEachSegment(context, segment_ids.vec<int32>().data(), num_ids,
+                   num_segments, row_size, combine_segment);
+  }
+
+ private:
+  Combiner combiner_;
+};
+
+template <typename T>
+class EmbeddingBagGradOp : public OpKernel {
+ public:
+  explicit EmbeddingBagGradOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    string combiner;
+    OP_REQUIRES_OK(context, context->GetAttr("combiner", &combiner));
+    OP_REQUIRES_OK(context, ParseCombiner(combiner, &combiner_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& grad = context->input(0);
+    const Tensor& segment_ids = context->input(1);
+    const Tensor& weights = context->input(2);
+
+    OP_REQUIRES(context, TensorShapeUtils::IsVectorOrHigher(grad.shape()),
+                errors::InvalidArgument("grad must be at least 1-D: ",
+                                        grad.shape().DebugString()));
+    int64 num_segments;
+    OP_REQUIRES_OK(context,
+                   ValidateSegments(segment_ids, weights, &num_segments));
+    OP_REQUIRES(context, num_segments <= grad.dim_size(0),
+                errors::InvalidArgument("Segment id ", num_segments - 1,
+                                        " out of range [0, ", grad.dim_size(0),
+                                        ")"));
+
+    const int64 num_ids = segment_ids.NumElements();
+    TensorShape output_shape = grad.shape();
+    output_shape.set_dim(0, num_ids);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, output_shape, &output));
+    if (output->NumElements() == 0) return;
+
+    auto grad_flat = grad.flat_outer_dims<T>();
+    auto output_flat = output->flat_outer_dims<T>();
+    const T* weights_data =
+        weights.NumElements() == 0 ? nullptr : weights.vec<T>().data();
+
+    // Every id of a segment gets the gradient of the segment, scaled by its
+    // weight and by the combiner.
+    auto scatter_segment = [&](int64 segment, int64 start, int64 end) {
+      if (start == end) return;
+      const T scale = CombinerScale(combiner_, weights_data, start, end);
+      auto segment_grad = grad_flat.template chip<0>(segment);
+      for (int64 i = start; i < end; ++i) {
+        const T weight =
+            weights_data == nullptr ? scale : scale * weights_data[i];
+        output_flat.template chip<0>(i) = segment_grad * weight;
+      }
+    };
+    ForEachSegment(context, segment_ids.vec<int32>().data(), num_ids,
+                   num_segments, grad_flat.dimension(1), scatter_segment);
+  }
+
+ private:
+  Combiner combiner_;
+};
+
+#define REGISTER_KERNELS(type, index_type)                         \
+  REGISTER_KERNEL_BUILDER(Name("EmbeddingBag")                     \
+                              .Device(DEVICE_CPU)                  \
+                              .TypeConstraint<type>("T")           \
+                              .TypeConstraint<index_type>("Tidx"), \
+                          EmbeddingBagOp<type, index_type>);
+
+#define REGISTER_CPU_KERNELS(type)                               \
+  REGISTER_KERNELS(type, int32);                                 \
+  REGISTER_KERNELS(type, int64);                                 \
+  REGISTER_KERNEL_BUILDER(Name("EmbeddingBagGrad")               \
+                              .Device(DEVICE_CPU)                \
+                              .TypeConstraint<type>("T"),        \
+                          EmbeddingBagGradOp<type>);
+
+TF_CALL_float(REGISTER_CPU_KERNELS);
+TF_CALL_double(REGISTER_CPU_KERNELS);
+
+#undef REGISTER_CPU_KERNELS
+#undef REGISTER_KERNELS
+
+}  // namespace tensorflow
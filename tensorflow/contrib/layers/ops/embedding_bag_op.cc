@@ -0,0 +1,124 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/shape_inference.h"
+
+namespace tensorflow {
+
+using shape_inference::DimensionHandle;
+using shape_inference::InferenceContext;
+using shape_inference::ShapeHandle;
+
+namespace {
+
+// Checks that 'segment_ids' and 'weights' are vectors, and merges the number
+// of segment ids into 'num_ids'.
+Status ValidateSegmentIdsAndWeights(InferenceContext* c, int segment_ids_input,
+                                    int weights_input,
+                                    DimensionHandle* num_ids) {
+  ShapeHandle segment_ids;
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(segment_ids_input), 1, &segment_ids));
+  TF_RETURN_IF_ERROR(c->Merge(*num_ids, c->Dim(segment_ids, 0), num_ids));
+  ShapeHandle unused;
+  return c->WithRank(c->input(weights_input), 1, &unused);
+}
+
+// Sets the output to [num_rows] + shape(data)[1:].
+Status SetRowsOutput(InferenceContext* c, int data_input,
+                     DimensionHandle num_rows) {
+  ShapeHandle data;
+  TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(data_input), 1, &data));
+  ShapeHandle row_shape;
+  TF_RETURN_IF_ERROR(c->Subshape(data, 1, &row_shape));
+  ShapeHandle out;
+  TF_RETURN_IF_ERROR(c->Concatenate(c->Vector(num_rows), row_shape, &out));
+  c->set_output(0, out);
+  return Status::OK();
+}
+
+}  // namespace
+
+REGISTER_OP("EmbeddingBag")
+    .Input("params: T")
+    .Input("ids: Tidx")
+    .Input("segment_ids: int32")
+    .Input("weights: T")
+    .Output("output: T")
+    .Attr("combiner: {'sum', 'mean', 'sqrtn'} = 'mean'")
+    .Attr("T: {float, double}")
+    .Attr("Tidx: {int32, int64} = DT_INT64")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle ids;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &ids));
+      DimensionHandle num_ids = c->Dim(ids, 0);
+      TF_RETURN_IF_ERROR(ValidateSegmentIdsAndWeights(c, 2, 3, &num_ids));
+      return SetRowsOutput(c, 0, c->UnknownDim());
+    })
+    .Doc(R"doc(
+Looks up and combines the rows of `params` for bags of ids in a single pass.
+
+Computes the same result as `embedding_lookup_sparse` on a single
+(unpartitioned) `params` tensor, but streams the rows of `params` straight into
+the output instead of gathering them into an intermediate tensor first.
+
+For each segment `s`, with `i` ranging over the positions where
+`segment_ids[i] == s`:
+
+    sum:   output[s] = sum_i weights[i] * params[ids[i]]
+    mean:  output[s] = sum_i weights[i] * params[ids[i]] / sum_i weights[i]
+    sqrtn: output[s] = sum_i weights[i] * params[ids[i]] /
+                       sqrt(sum_i weights[i]^2)
+
+Segments with no ids are set to zero.
+
+params: The embedding tensor.
+ids: A 1-D tensor of indices into the first dimension of `params`.
+segment_ids: A 1-D tensor of sorted segment ids, one per id.  Typically the
+  first column of the indices of a `SparseTensor` of ids.
+weights: A 1-D tensor with one weight per id, or an empty tensor to give all
+  ids a weight of 1.
+output: Has the same shape as `params`, except for dimension 0 which is
+  `segment_ids[-1] + 1`.
+combiner: How the weighted rows of a segment are combined.
+)doc");
+
+REGISTER_OP("EmbeddingBagGrad")
+    .Input("grad: T")
+    .Input("segment_ids: int32")
+    .Input("weights: T")
+    .Output("output: T")
+    .Attr("combiner: {'sum', 'mean', 'sqrtn'} = 'mean'")
+    .Attr("T: {float, double}")
+    .SetShapeFn([](InferenceContext* c) {
+      DimensionHandle num_ids = c->UnknownDim();
+      TF_RETURN_IF_ERROR(ValidateSegmentIdsAndWeights(c, 1, 2, &num_ids));
+      return SetRowsOutput(c, 0, num_ids);
+    })
+    .Doc(R"doc(
+Computes the gradient of `EmbeddingBag` with respect to the gathered rows.
+
+`output[i]` is the gradient for `params[ids[i]]`, so that the gradient with
+respect to `params` is the `IndexedSlices` of `output` at `ids`.
+
+grad: The gradient of the output of `EmbeddingBag`.
+segment_ids: The `segment_ids` passed to `EmbeddingBag`.
+weights: The `weights` passed to `EmbeddingBag`.
+output: Has the same shape as `grad`, except for dimension 0 which is the
+  number of ids.
+combiner: The `combiner` of `EmbeddingBag`.
+)doc");
+
+}  // namespace tensorflow
@@ -0,0 +1,112 @@
+# Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for tf.contrib.layers.embedding_bag."""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import numpy as np
+
+from tensorflow.contrib.layers.python.ops import embedding_bag_op
+from tensorflow.python.framework import constant_op
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import errors
+from tensorflow.python.framework import ops
+from tensorflow.python.framework import sparse_tensor
+from tensorflow.python.ops import embedding_ops
+from tensorflow.python.ops import gradients_impl
+from tensorflow.python.ops import math_ops
+from tensorflow.python.platform import test
+
+
+class EmbeddingBagTest(test.TestCase):
+
+  def _sparse_ids_and_weights(self):
+    indices = [[0, 0], [0, 1], [0, 2], [1, 0], [3, 0], [3, 1]]
+    sp_ids = sparse_tensor.SparseTensor(
+        indices, constant_op.constant([1, 3, 1, 0, 7, 2], dtypes.int64),
+        [4, 3])
+    sp_weights = sparse_tensor.SparseTensor(
+        indices, constant_op.constant([2.0, 0.5, 1.0, 1.0, 3.0, -1.0]),
+        [4, 3])
+    return sp_ids, sp_weights
+
+  def testMatchesEmbeddingLookupSparse(self):
+    params = constant_op.constant(
+        np.random.rand(10, 4, 2).astype(np.float32))
+    sp_ids, sp_weights = self._sparse_ids_and_weights()
+    for combiner in ("sum", "mean", "sqrtn"):
+      for weights in (None, sp_weights):
+        with self.test_session():
+          expected = embedding_ops.embedding_lookup_sparse(
+              params, sp_ids, weights, combiner=combiner)
+          actual = embedding_bag_op.embedding_bag(
+              params, sp_ids, weights, combiner=combiner)
+          self.assertEqual([None, 4, 2], actual.get_shape().as_list())
+          expected, actual = expected.eval(), actual.eval()
+          # Row 2 has no ids.
+          self.assertAllClose(expected[[0, 1, 3]], actual[[0, 1, 3]])
+          self.assertAllEqual(np.zeros([4, 2]), actual[2])
+
+  def testGradientMatchesEmbeddingLookupSparse(self):
+    params = constant_op.constant(
+        np.random.rand(10, 3).astype(np.float64))
+    sp_ids, sp_weights = self._sparse_ids_and_weights()
+    sp_weights = sparse_tensor.SparseTensor(
+        sp_weights.indices, math_ops.to_double(sp_weights.values),
+        sp_weights.dense_shape)
+    for combiner in ("sum", "mean", "sqrtn"):
+      with self.test_session():
+        expected = embedding_ops.embedding_lookup_sparse(
+            params, sp_ids, sp_weights, combiner=combiner)
+        actual = embedding_bag_op.embedding_bag(
+            params, sp_ids, sp_weights, combiner=combiner)
+        expected_grad = gradients_impl.gradients(expected, params)[0]
+        actual_grad = gradients_impl.gradients(actual, params)[0]
+        self.assertTrue(isinstance(actual_grad, ops.IndexedSlices))
+        self.assertAllClose(
+            ops.convert_to_tensor(expected_grad).eval(),
+            ops.convert_to_tensor(actual_grad).eval())
+
+  def testOutOfRangeId(self):
+    params = constant_op.constant(np.ones([3, 2], np.float32))
+    sp_ids = sparse_tensor.SparseTensor(
+        [[0, 0], [1, 0]], constant_op.constant([1, 3], dtypes.int64), [2, 1])
+    with self.test_session():
+      with self.assertRaisesOpError(r"ids\[1\] = 3 is out of range \[0, 3\)"):
+        embedding_bag_op.embedding_bag(params, sp_ids).eval()
+
+  def testUnsortedSegments(self):
+    params = constant_op.constant(np.ones([3, 2], np.float32))
+    sp_ids = sparse_tensor.SparseTensor(
+        [[1, 0], [0, 0]], constant_op.constant([1, 2], dtypes.int64), [2, 1])
+    with self.test_session():
+      with self.assertRaisesOpError("segment ids are not increasing"):
+        embedding_bag_op.embedding_bag(params, sp_ids).eval()
+
+  def testWeightsSizeMismatch(self):
+    params = constant_op.constant(np.ones([3, 2], np.float32))
+    sp_ids = sparse_tensor.SparseTensor(
+        [[0, 0], [1, 0]], constant_op.constant([1, 2], dtypes.int64), [2, 1])
+    sp_weights = sparse_tensor.SparseTensor(
+        [[0, 0]], constant_op.constant([1.0]), [2, 1])
+    with self.test_session():
+      with self.assertRaises(errors.InvalidArgumentError):
+        embedding_bag_op.embedding_bag(params, sp_ids, sp_weights).eval()
+
+
+if __name__ == "__main__":
+  test.main()
@@ -0,0 +1,96 @@
+# Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Wrappers for the fused embedding bag operations."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+from tensorflow.contrib.layers.ops import gen_embedding_bag_op
+from tensorflow.contrib.util import loader
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import ops
+from tensorflow.python.framework import sparse_tensor
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import math_ops
+from tensorflow.python.platform import resource_loader
+
+_embedding_bag_op = loader.load_op_library(
+    resource_loader.get_path_to_datafile("_embedding_bag_op.so"))
+
+
+def embedding_bag(params, sp_ids, sp_weights=None, combiner="mean",
+                  name=None):
+  """Computes embeddings for the given ids and weights in a single op.
+
+  Computes the same result as `tf.nn.embedding_lookup_sparse` for a single
+  `params` tensor, without materializing the gathered embeddings: the rows of
+  `params` are streamed directly into the combined output. The gradient with
+  respect to `params` is an `IndexedSlices` with one row per id.
+
+  Args:
+    params: A `Tensor` or `Variable` holding the complete embedding tensor.
+      Partitioned embeddings should use `tf.nn.embedding_lookup_sparse`.
+    sp_ids: N x M `SparseTensor` of int32 or int64 ids, whose indices are in
+      canonical row-major order.
+    sp_weights: Either a `SparseTensor` of weights with the same indices as
+      `sp_ids`, or `None` to give all ids a weight of 1. The weights are treated
+      as constants: no gradient is computed for them.
+    combiner: A string specifying the reduction op. Currently "mean", "sqrtn"
+      and "sum" are supported.
+    name: Optional name for the op.
+
+  Returns:
+    A dense tensor with one row per row of `sp_ids`, up to the last non-empty
+    one, combining the embeddings of its ids. Rows with no ids are zero.
+
+  Raises:
+    TypeError: If `sp_ids` is not a `SparseTensor`, or if `sp_weights` is
+      neither `None` nor `SparseTensor`.
+    ValueError: If `combiner` is not one of {"mean", "sqrtn", "sum"}.
+  """
+  if combiner not in ("mean", "sqrtn", "sum"):
+    raise ValueError("combiner must be one of 'mean', 'sqrtn' or 'sum'")
+  if not isinstance(sp_ids, sparse_tensor.SparseTensor):
+    raise TypeError("sp_ids must be SparseTensor")
+  if sp_weights is not None and not isinstance(sp_weights,
+                                               sparse_tensor.SparseTensor):
+    raise TypeError("sp_weights must be either None or SparseTensor")
+
+  with ops.name_scope(name, "embedding_bag", [params, sp_ids]) as name:
+    params = ops.convert_to_tensor(params, name="params")
+    segment_ids = math_ops.cast(sp_ids.indices[:, 0], dtypes.int32)
+    if sp_weights is None:
+      weights = array_ops.zeros([0], dtype=params.dtype)
+    else:
+      weights = math_ops.cast(sp_weights.values, params.dtype)
+    return gen_embedding_bag_op.embedding_bag(
+        params, sp_ids.values, segment_ids, weights, combiner=combiner,
+        name=name)
+
+
+@ops.RegisterGradient("EmbeddingBag")
+def _EmbeddingBagGrad(op, grad):
+  """Gradient for EmbeddingBag op."""
+  params = op.inputs[0]
+  with ops.colocate_with(params):
+    params_shape = array_ops.shape(params, out_type=dtypes.int64)
+    params_shape = math_ops.to_int32(params_shape)
+  values = gen_embedding_bag_op.embedding_bag_grad(
+      grad, op.inputs[2], op.inputs[3], combiner=op.get_attr("combiner"))
+  return [ops.IndexedSlices(values, op.inputs[1], params_shape), None, None,
+          None]
+
+
+ops.NotDifferentiable("EmbeddingBagGrad")
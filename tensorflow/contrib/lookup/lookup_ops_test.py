@@ -715,6 +715,25 @@ class MutableHashTableOpTest(test.TestCase):
       result = output.eval()
       self.assertAllEqual((b"brain", b"salad", b"n/a"), result)
 
+  def testMutableHashTableManyConsecutiveKeys(self):
+    with self.test_session():
+      default_val = -1
+      num_keys = 10000
+      keys = constant_op.constant(np.arange(num_keys), dtypes.int64)
+      values = constant_op.constant(np.arange(num_keys) * 2, dtypes.int64)
+      table = lookup.MutableHashTable(dtypes.int64, dtypes.int64,
+                                      default_val)
+      table.insert(keys, values).run()
+      self.assertAllEqual(num_keys, table.size().eval())
+
+      input_keys = constant_op.constant(
+          np.arange(-10, num_keys + 10), dtypes.int64)
+      output = table.lookup(input_keys)
+
+      expected = np.concatenate(
+          [[default_val] * 10, np.arange(num_keys) * 2, [default_val] * 10])
+      self.assertAllEqual(expected, output.eval())
+
 
 class MutableDenseHashTableOpTest(test.TestCase):
 
@@ -0,0 +1,41 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef SHM_RENDEZVOUS_MGR_H_
+#define SHM_RENDEZVOUS_MGR_H_
+
+#include "tensorflow/contrib/shm/shm_transport.h"
+#include "tensorflow/core/distributed_runtime/base_rendezvous_mgr.h"
+#include "tensorflow/core/distributed_runtime/worker_env.h"
+#include "tensorflow/core/platform/macros.h"
+
+namespace tensorflow {
+
+class ShmRendezvousMgr : public BaseRendezvousMgr {
+ public:
+  explicit ShmRendezvousMgr(const WorkerEnv* env, ShmTransport* shm_transport);
+
+ protected:
+  BaseRemoteRendezvous* Create(int64 step_id, const WorkerEnv* worker_env);
+
+ private:
+  ShmTransport* shm_transport_;  // Not owned
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ShmRendezvousMgr);
+};
+
+}  // end namespace tensorflow
+
+#endif  // SHM_RENDEZVOUS_MGR_H_
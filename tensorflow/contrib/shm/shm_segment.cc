@@ -0,0 +1,256 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/contrib/shm/shm_segment.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+constexpr uint64 kSegmentMagic = 0x54465348534547ULL;  // "TFSHSEG"
+
+// Slots are aligned so that tensor content keeps its alignment in the
+// segment, and their headers don't share cache lines.
+constexpr uint64 kSlotAlignment = 64;
+
+// A slot that has not been read after this long is reclaimed, so that an
+// aborted step cannot block the ring forever.
+constexpr uint64 kSlotTimeoutMicros = 60 * 1000 * 1000;
+
+struct SegmentHeader {
+  uint64 magic;
+  uint64 capacity;
+};
+
+constexpr uint64 kDataOffset = kSlotAlignment;
+static_assert(sizeof(SegmentHeader) <= kDataOffset,
+              "SegmentHeader must fit before the data area");
+
+uint64 RoundUp(uint64 n, uint64 alignment) {
+  return (n + alignment - 1) / alignment * alignment;
+}
+
+Status ErrnoToStatus(const string& context, const string& name) {
+  return errors::Unavailable(context, " ", name, ": ", strerror(errno));
+}
+
+}  // namespace
+
+struct ShmSegment::SlotHeader {
+  // Sequence number of the write, or 0 once the slot has been read or
+  // reclaimed.  Readers and the writer race to reset it with a
+  // compare-and-swap, so that a reader can tell whether the content it has
+  // copied was overwritten.
+  std::atomic<uint64> sequence;
+  uint64 length;
+};
+
+ShmSegment::ShmSegment(const string& name, bool owner, int fd, char* base,
+                       uint64 mapped_bytes, uint64 capacity)
+    : name_(name),
+      owner_(owner),
+      fd_(fd),
+      base_(base),
+      mapped_bytes_(mapped_bytes),
+      capacity_(capacity) {}
+
+ShmSegment::~ShmSegment() {
+  munmap(base_, mapped_bytes_);
+  close(fd_);
+  if (owner_) {
+    shm_unlink(name_.c_str());
+  }
+}
+
+/* static */
+Status ShmSegment::Create(const string& name, uint64 capacity,
+                          std::unique_ptr<ShmSegment>* segment) {
+  capacity = RoundUp(capacity, kSlotAlignment);
+  const uint64 mapped_bytes = kDataOffset + capacity;
+  int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    return ErrnoToStatus("Failed to create shared memory segment", name);
+  }
+  if (ftruncate(fd, mapped_bytes) != 0) {
+    Status s = ErrnoToStatus("Failed to size shared memory segment", name);
+    close(fd);
+    shm_unlink(name.c_str());
+    return s;
+  }
+  void* base =
+      mmap(nullptr, mapped_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (base == MAP_FAILED) {
+    Status s = ErrnoToStatus("Failed to map shared memory segment", name);
+    close(fd);
+    shm_unlink(name.c_str());
+    return s;
+  }
+  SegmentHeader* header = reinterpret_cast<SegmentHeader*>(base);
+  header->capacity = capacity;
+  std::atomic_thread_fence(std::memory_order_release);
+  header->magic = kSegmentMagic;
+  segment->reset(new ShmSegment(name, true /*owner*/, fd,
+                                reinterpret_cast<char*>(base), mapped_bytes,
+                                capacity));
+  return Status::OK();
+}
+
+/* static */
+Status ShmSegment::Open(const string& name,
+                        std::unique_ptr<ShmSegment>* segment) {
+  int fd = shm_open(name.c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    return ErrnoToStatus("Failed to open shared memory segment", name);
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    Status s = ErrnoToStatus("Failed to stat shared memory segment", name);
+    close(fd);
+    return s;
+  }
+  const uint64 mapped_bytes = st.st_size;
+  if (mapped_bytes <= kDataOffset) {
+    close(fd);
+    return errors::DataLoss("Shared memory segment ", name, " is truncated");
+  }
+  void* base =
+      mmap(nullptr, mapped_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (base == MAP_FAILED) {
+    Status s = ErrnoToStatus("Failed to map shared memory segment", name);
+    close(fd);
+    return s;
+  }
+  const SegmentHeader* header = reinterpret_cast<const SegmentHeader*>(base);
+  if (header->magic != kSegmentMagic ||
+      header->capacity + kDataOffset > mapped_bytes) {
+    munmap(base, mapped_bytes);
+    close(fd);
+    return errors::DataLoss("Invalid shared memory segment ", name);
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+  segment->reset(new ShmSegment(name, false /*owner*/, fd,
+                                reinterpret_cast<char*>(base), mapped_bytes,
+                                header->capacity));
+  return Status::OK();
+}
+
+ShmSegment::SlotHeader* ShmSegment::Slot(uint64 offset) const {
+  static_assert(sizeof(std::atomic<uint64>) == sizeof(uint64) &&
+                    ATOMIC_LLONG_LOCK_FREE == 2,
+                "Shared memory slots require lock-free 64 bit atomics");
+  static_assert(sizeof(SlotHeader) <= kSlotAlignment,
+                "SlotHeader must fit in a cache line");
+  return reinterpret_cast<SlotHeader*>(base_ + kDataOffset + offset);
+}
+
+void ShmSegment::Reclaim() {
+  const uint64 now = Env::Default()->NowMicros();
+  while (!slots_.empty()) {
+    const WrittenSlot& oldest = slots_.front();
+    std::atomic<uint64>* sequence = &Slot(oldest.offset)->sequence;
+    if (sequence->load(std::memory_order_acquire) != 0) {
+      if (now - oldest.write_micros < kSlotTimeoutMicros) break;
+      // Take the slot back, unless the reader releases it first.
+      uint64 expected = oldest.sequence;
+      if (sequence->compare_exchange_strong(expected, 0,
+                                            std::memory_order_acq_rel)) {
+        LOG(WARNING) << "Reclaiming shared memory slot " << oldest.sequence
+                     << " of " << name_ << " that was never read";
+      }
+    }
+    slots_.pop_front();
+    if (slots_.empty()) {
+      head_ = 0;
+      tail_ = 0;
+    } else {
+      tail_ = slots_.front().offset;
+    }
+  }
+}
+
+bool ShmSegment::Write(const void* data, uint64 num_bytes, uint64* offset,
+                       uint64* sequence) {
+  CHECK(owner_) << "Only the owner of " << name_ << " can write to it";
+  const uint64 bytes = RoundUp(sizeof(SlotHeader) + num_bytes, kSlotAlignment);
+  mutex_lock l(mu_);
+  Reclaim();
+  uint64 start;
+  if (slots_.empty()) {
+    if (bytes > capacity_) return false;
+    start = 0;
+  } else if (head_ > tail_) {
+    // Free space is [head_, capacity_) and [0, tail_).
+    if (head_ + bytes <= capacity_) {
+      start = head_;
+    } else if (bytes <= tail_) {
+      start = 0;
+    } else {
+      return false;
+    }
+  } else {
+    // The ring has wrapped around: free space is [head_, tail_).
+    if (head_ + bytes > tail_) return false;
+    start = head_;
+  }
+
+  SlotHeader* slot = Slot(start);
+  slot->length = num_bytes;
+  memcpy(reinterpret_cast<char*>(slot) + sizeof(SlotHeader), data, num_bytes);
+  *offset = start;
+  *sequence = next_sequence_++;
+  slot->sequence.store(*sequence, std::memory_order_release);
+  slots_.push_back({start, *sequence, Env::Default()->NowMicros()});
+  head_ = start + bytes;
+  return true;
+}
+
+Status ShmSegment::Read(uint64 offset, uint64 sequence, void* data,
+                        uint64 num_bytes) {
+  if (offset % kSlotAlignment != 0 ||
+      offset + sizeof(SlotHeader) + num_bytes > capacity_) {
+    return errors::InvalidArgument("Invalid slot at offset ", offset,
+                                   " of shared memory segment ", name_);
+  }
+  SlotHeader* slot = Slot(offset);
+  if (slot->sequence.load(std::memory_order_acquire) != sequence ||
+      slot->length != num_bytes) {
+    return errors::DataLoss("Shared memory slot ", sequence, " of ", name_,
+                            " was reclaimed before it was read");
+  }
+  memcpy(data, reinterpret_cast<const char*>(slot) + sizeof(SlotHeader),
+         num_bytes);
+  uint64 expected = sequence;
+  if (!slot->sequence.compare_exchange_strong(expected, 0,
+                                              std::memory_order_acq_rel)) {
+    return errors::DataLoss("Shared memory slot ", sequence, " of ", name_,
+                            " was reclaimed while it was read");
+  }
+  return Status::OK();
+}
+
+}  // namespace tensorflow
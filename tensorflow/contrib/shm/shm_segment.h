@@ -0,0 +1,100 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef SHM_SEGMENT_H_
+#define SHM_SEGMENT_H_
+
+#include <deque>
+#include <memory>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A POSIX shared memory segment used as a ring buffer of variable size slots,
+// written by the process that created it and read by other processes on the
+// same host.
+//
+// The writer copies a buffer in a free slot and hands its (offset, sequence)
+// to a reader through some other channel.  The reader copies the slot out
+// and releases it, after which the writer can reuse its space.  Slots are
+// reclaimed in the order they were written, so a slot that is never read
+// holds back the ring until it times out.
+class ShmSegment {
+ public:
+  ~ShmSegment();
+
+  // Creates a new segment with room for 'capacity' bytes of slots, owned by
+  // this process.  The shared memory object is unlinked when the segment is
+  // destroyed.
+  static Status Create(const string& name, uint64 capacity,
+                       std::unique_ptr<ShmSegment>* segment);
+
+  // Maps an existing segment created by another process.
+  static Status Open(const string& name, std::unique_ptr<ShmSegment>* segment);
+
+  const string& name() const { return name_; }
+  uint64 capacity() const { return capacity_; }
+
+  // Copies 'num_bytes' from 'data' in a free slot.  Returns false, without
+  // blocking, if there is no room for it.  Only valid on the owner.
+  bool Write(const void* data, uint64 num_bytes, uint64* offset,
+             uint64* sequence);
+
+  // Copies the content of the slot written at 'offset' with 'sequence' to
+  // 'data' and releases the slot.  Fails if the slot has been reclaimed by
+  // the writer.
+  Status Read(uint64 offset, uint64 sequence, void* data, uint64 num_bytes);
+
+ private:
+  struct SlotHeader;
+
+  ShmSegment(const string& name, bool owner, int fd, char* base,
+             uint64 mapped_bytes, uint64 capacity);
+
+  // Returns the header of the slot at 'offset' in the data area.
+  SlotHeader* Slot(uint64 offset) const;
+
+  // Frees the oldest slots that have been read or have timed out.
+  void Reclaim() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const string name_;
+  const bool owner_;
+  const int fd_;
+  char* const base_;
+  const uint64 mapped_bytes_;
+  const uint64 capacity_;
+
+  // Writer state, only used on the owner.
+  struct WrittenSlot {
+    uint64 offset;
+    uint64 sequence;
+    uint64 write_micros;
+  };
+  mutex mu_;
+  std::deque<WrittenSlot> slots_ GUARDED_BY(mu_);
+  uint64 head_ GUARDED_BY(mu_) = 0;  // Where the next slot starts
+  uint64 tail_ GUARDED_BY(mu_) = 0;  // Where the oldest slot starts
+  uint64 next_sequence_ GUARDED_BY(mu_) = 1;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ShmSegment);
+};
+
+}  // namespace tensorflow
+
+#endif  // SHM_SEGMENT_H_
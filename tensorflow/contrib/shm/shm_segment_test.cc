@@ -0,0 +1,139 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/contrib/shm/shm_segment.h"
+
+#include <unistd.h>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Slots take 64 bytes for payloads of up to 48 bytes.
+const uint64 kCapacity = 4 * 64;
+const uint64 kPayloadBytes = 48;
+
+string SegmentName(const string& test) {
+  return strings::StrCat("/tf_shm_test_", getpid(), "_", test);
+}
+
+class ShmSegmentTest : public ::testing::Test {
+ protected:
+  void Init(const string& test) {
+    TF_ASSERT_OK(ShmSegment::Create(SegmentName(test), kCapacity, &writer_));
+    TF_ASSERT_OK(ShmSegment::Open(SegmentName(test), &reader_));
+    EXPECT_EQ(kCapacity, reader_->capacity());
+  }
+
+  // Writes a payload filled with 'value' and returns its slot.
+  bool Write(char value, uint64* offset, uint64* sequence) {
+    const string data(kPayloadBytes, value);
+    return writer_->Write(data.data(), data.size(), offset, sequence);
+  }
+
+  // Reads the slot and checks that it is filled with 'value'.
+  Status Read(uint64 offset, uint64 sequence, char value) {
+    string data(kPayloadBytes, '\0');
+    TF_RETURN_IF_ERROR(
+        reader_->Read(offset, sequence, &data[0], kPayloadBytes));
+    EXPECT_EQ(string(kPayloadBytes, value), data);
+    return Status::OK();
+  }
+
+  std::unique_ptr<ShmSegment> writer_;
+  std::unique_ptr<ShmSegment> reader_;
+};
+
+TEST_F(ShmSegmentTest, WriteRead) {
+  Init("WriteRead");
+  uint64 offset1, sequence1, offset2, sequence2;
+  ASSERT_TRUE(Write('a', &offset1, &sequence1));
+  ASSERT_TRUE(Write('b', &offset2, &sequence2));
+  EXPECT_NE(offset1, offset2);
+  EXPECT_NE(sequence1, sequence2);
+  // Slots can be read in any order.
+  TF_EXPECT_OK(Read(offset2, sequence2, 'b'));
+  TF_EXPECT_OK(Read(offset1, sequence1, 'a'));
+}
+
+TEST_F(ShmSegmentTest, CreateExisting) {
+  Init("CreateExisting");
+  std::unique_ptr<ShmSegment> segment;
+  EXPECT_FALSE(
+      ShmSegment::Create(SegmentName("CreateExisting"), kCapacity, &segment)
+          .ok());
+}
+
+TEST_F(ShmSegmentTest, OpenMissing) {
+  std::unique_ptr<ShmSegment> segment;
+  EXPECT_FALSE(ShmSegment::Open(SegmentName("OpenMissing"), &segment).ok());
+}
+
+TEST_F(ShmSegmentTest, FullAndWrapAround) {
+  Init("FullAndWrapAround");
+  uint64 offsets[4], sequences[4];
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(Write('a' + i, &offsets[i], &sequences[i]));
+  }
+  uint64 offset, sequence;
+  EXPECT_FALSE(Write('e', &offset, &sequence));
+
+  // Reading a slot other than the oldest one does not free any space.
+  TF_EXPECT_OK(Read(offsets[1], sequences[1], 'b'));
+  EXPECT_FALSE(Write('e', &offset, &sequence));
+
+  // Reading the oldest one frees both slots, and the ring wraps around.
+  TF_EXPECT_OK(Read(offsets[0], sequences[0], 'a'));
+  ASSERT_TRUE(Write('e', &offset, &sequence));
+  EXPECT_EQ(offsets[0], offset);
+  uint64 offset2, sequence2;
+  ASSERT_TRUE(Write('f', &offset2, &sequence2));
+  EXPECT_EQ(offsets[1], offset2);
+  EXPECT_FALSE(Write('g', &offset, &sequence));
+
+  TF_EXPECT_OK(Read(offset2, sequence2, 'f'));
+  TF_EXPECT_OK(Read(offsets[2], sequences[2], 'c'));
+}
+
+TEST_F(ShmSegmentTest, TooLarge) {
+  Init("TooLarge");
+  const string data(kCapacity, 'a');
+  uint64 offset, sequence;
+  EXPECT_FALSE(writer_->Write(data.data(), data.size(), &offset, &sequence));
+}
+
+TEST_F(ShmSegmentTest, ReadTwice) {
+  Init("ReadTwice");
+  uint64 offset, sequence;
+  ASSERT_TRUE(Write('a', &offset, &sequence));
+  TF_EXPECT_OK(Read(offset, sequence, 'a'));
+  EXPECT_TRUE(errors::IsDataLoss(Read(offset, sequence, 'a')));
+}
+
+TEST_F(ShmSegmentTest, InvalidSlot) {
+  Init("InvalidSlot");
+  uint64 offset, sequence;
+  ASSERT_TRUE(Write('a', &offset, &sequence));
+  EXPECT_TRUE(errors::IsInvalidArgument(Read(offset + 1, sequence, 'a')));
+  EXPECT_TRUE(errors::IsInvalidArgument(Read(kCapacity, sequence, 'a')));
+  EXPECT_TRUE(errors::IsDataLoss(Read(offset, sequence + 1, 'a')));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,92 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/contrib/shm/shm_server_lib.h"
+
+#include <stdlib.h>
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/distributed_runtime/server_lib.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/protobuf/rewriter_config.pb.h"
+#include "tensorflow/core/protobuf/tensorflow_server.pb.h"
+#include "tensorflow/core/public/session.h"
+
+namespace tensorflow {
+namespace {
+
+// Starts two "grpc+shm" servers in this process, which then exchange tensors
+// through shared memory, and runs a graph that sends a tensor from the
+// second one to the first one.
+TEST(ShmServerTest, SendsTensorsBetweenServers) {
+  setenv("TF_SHM_SEGMENT_BYTES", "1048576", 1);
+  const int kNumTasks = 2;
+  std::vector<int> ports(kNumTasks);
+  for (int i = 0; i < kNumTasks; ++i) {
+    ports[i] = testing::PickUnusedPortOrDie();
+  }
+  std::vector<std::unique_ptr<ServerInterface>> servers(kNumTasks);
+  for (int i = 0; i < kNumTasks; ++i) {
+    ServerDef server_def;
+    server_def.set_protocol("grpc+shm");
+    server_def.set_job_name("worker");
+    server_def.set_task_index(i);
+    JobDef* job_def = server_def.mutable_cluster()->add_job();
+    job_def->set_name("worker");
+    for (int j = 0; j < kNumTasks; ++j) {
+      (*job_def->mutable_tasks())[j] = strings::StrCat("localhost:", ports[j]);
+    }
+    TF_ASSERT_OK(NewServer(server_def, &servers[i]));
+    TF_ASSERT_OK(servers[i]->Start());
+  }
+
+  Scope root = Scope::NewRootScope();
+  const Tensor value = test::AsTensor<float>({1, 2, 3, 4, 5, 6}, {2, 3});
+  auto x = ops::Const(
+      root.WithOpName("x").WithDevice("/job:worker/replica:0/task:1/cpu:0"),
+      value);
+  ops::Identity(
+      root.WithOpName("y").WithDevice("/job:worker/replica:0/task:0/cpu:0"), x);
+  GraphDef graph_def;
+  TF_ASSERT_OK(root.ToGraphDef(&graph_def));
+
+  SessionOptions options;
+  options.target = servers[0]->target();
+  // Keeps "x" on task 1.
+  GraphOptions* graph_options = options.config.mutable_graph_options();
+  graph_options->mutable_optimizer_options()->set_opt_level(
+      OptimizerOptions::L0);
+  graph_options->mutable_rewrite_options()->set_constant_folding(
+      RewriterConfig::OFF);
+  std::unique_ptr<Session> session(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(graph_def));
+  // The first tensor is sent in the response, with the segment of task 1, and
+  // the next ones through the segment.
+  for (int i = 0; i < 3; ++i) {
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->Run({}, {"y:0"}, {}, &outputs));
+    ASSERT_EQ(1, outputs.size());
+    test::ExpectTensorEqual<float>(value, outputs[0]);
+  }
+  TF_ASSERT_OK(session->Close());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,195 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/contrib/shm/shm_transport.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include "tensorflow/contrib/shm/shm.pb.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+namespace {
+
+const int64 kDefaultSegmentBytes = 256LL << 20;
+
+// Returns the first line of a file in /proc, whose size is not known in
+// advance.
+string ReadProcFile(const char* path) {
+  FILE* file = fopen(path, "r");
+  if (file == nullptr) return "";
+  char buffer[128];
+  string line;
+  if (fgets(buffer, sizeof(buffer), file) != nullptr) {
+    line = buffer;
+  }
+  fclose(file);
+  str_util::StripTrailingWhitespace(&line);
+  return line;
+}
+
+// Two processes can share memory through shm_open if they were started
+// since the same boot of the same host and live in the same IPC namespace.
+string LocalHostId() {
+  const string boot_id = ReadProcFile("/proc/sys/kernel/random/boot_id");
+  char ipc_namespace[128];
+  const ssize_t length =
+      readlink("/proc/self/ns/ipc", ipc_namespace, sizeof(ipc_namespace));
+  if (boot_id.empty() || length <= 0) return "";
+  return strings::StrCat(boot_id, "/", string(ipc_namespace, length));
+}
+
+}  // namespace
+
+ShmTransport::ShmTransport(const string& host_id,
+                           std::unique_ptr<ShmSegment> segment)
+    : host_id_(host_id), segment_(std::move(segment)) {}
+
+/* static */
+Status ShmTransport::Create(std::unique_ptr<ShmTransport>* transport) {
+  int64 segment_bytes;
+  TF_RETURN_IF_ERROR(ReadInt64FromEnvVar(
+      "TF_SHM_SEGMENT_BYTES", kDefaultSegmentBytes, &segment_bytes));
+  if (segment_bytes <= 0) {
+    return errors::InvalidArgument("TF_SHM_SEGMENT_BYTES must be positive: ",
+                                   segment_bytes);
+  }
+  const string name =
+      strings::StrCat("/tf_shm_", getpid(), "_", random::New64());
+  std::unique_ptr<ShmSegment> segment;
+  TF_RETURN_IF_ERROR(ShmSegment::Create(name, segment_bytes, &segment));
+  const string host_id = LocalHostId();
+  if (host_id.empty()) {
+    LOG(WARNING) << "Cannot identify the host, shared memory transport is "
+                 << "disabled";
+  }
+  transport->reset(new ShmTransport(host_id, std::move(segment)));
+  return Status::OK();
+}
+
+void ShmTransport::ClientOptions(const string& peer,
+                                 ::google::protobuf::Any* transport_options) {
+  if (host_id_.empty()) return;
+  ShmClientOptions options;
+  {
+    mutex_lock l(mu_);
+    auto it = peers_.find(peer);
+    if (it != peers_.end()) {
+      if (it->second == nullptr) return;
+      options.set_segment_name(it->second->name());
+    }
+  }
+  options.set_host_id(host_id_);
+  transport_options->PackFrom(options);
+}
+
+bool ShmTransport::IsColocated(const ::google::protobuf::Any& transport_options,
+                               bool* mapped) const {
+  ShmClientOptions options;
+  if (host_id_.empty() || !transport_options.UnpackTo(&options) ||
+      options.host_id() != host_id_) {
+    return false;
+  }
+  *mapped = options.segment_name() == segment_->name();
+  return true;
+}
+
+void ShmTransport::SegmentInfo(
+    ::google::protobuf::Any* transport_options) const {
+  ShmSegmentInfo info;
+  info.set_segment_name(segment_->name());
+  transport_options->PackFrom(info);
+}
+
+bool ShmTransport::TransportOptionsFromTensor(
+    ::google::protobuf::Any* transport_options, const Tensor& tensor) {
+  const TensorBuffer* buffer = DMAHelper::buffer(&tensor);
+  uint64 offset;
+  uint64 sequence;
+  if (!segment_->Write(buffer->data(), buffer->size(), &offset, &sequence)) {
+    return false;
+  }
+  ShmTensorRegion region;
+  region.set_segment_name(segment_->name());
+  region.set_offset(offset);
+  region.set_length(buffer->size());
+  region.set_sequence(sequence);
+  transport_options->PackFrom(region);
+  return true;
+}
+
+Status ShmTransport::TensorFromTransportOptions(
+    const string& peer, Tensor* tensor,
+    const ::google::protobuf::Any& transport_options) {
+  ShmSegmentInfo info;
+  if (transport_options.UnpackTo(&info)) {
+    MapPeerSegment(peer, info.segment_name());
+    return Status::OK();
+  }
+  ShmTensorRegion region;
+  if (!transport_options.UnpackTo(&region)) {
+    return errors::Internal("Unexpected transport options for tensor");
+  }
+  TensorBuffer* buffer = DMAHelper::buffer(tensor);
+  if (buffer == nullptr || buffer->size() != region.length()) {
+    return errors::Internal("Tensor of ", tensor->TotalBytes(),
+                            " bytes does not match shared memory region of ",
+                            region.length(), " bytes");
+  }
+  ShmSegment* segment;
+  TF_RETURN_IF_ERROR(GetPeerSegment(region.segment_name(), &segment));
+  return segment->Read(region.offset(), region.sequence(), buffer->data(),
+                       region.length());
+}
+
+void ShmTransport::MapPeerSegment(const string& peer, const string& name) {
+  mutex_lock l(mu_);
+  auto it = peer_segments_.find(name);
+  if (it == peer_segments_.end()) {
+    std::unique_ptr<ShmSegment> peer_segment;
+    Status s = ShmSegment::Open(name, &peer_segment);
+    if (!s.ok()) {
+      // The peer keeps sending its tensors through gRPC.
+      LOG(WARNING) << "Cannot map the shared memory segment of " << peer
+                   << ", shared memory transport is disabled for it: " << s;
+      peers_[peer] = nullptr;
+      return;
+    }
+    it = peer_segments_.emplace(name, std::move(peer_segment)).first;
+  }
+  peers_[peer] = it->second.get();
+}
+
+Status ShmTransport::GetPeerSegment(const string& name,
+                                    ShmSegment** segment) {
+  mutex_lock l(mu_);
+  auto it = peer_segments_.find(name);
+  if (it == peer_segments_.end()) {
+    return errors::Internal("Shared memory segment ", name, " is not mapped");
+  }
+  *segment = it->second.get();
+  return Status::OK();
+}
+
+}  // namespace tensorflow
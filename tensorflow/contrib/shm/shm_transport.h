@@ -0,0 +1,104 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef SHM_TRANSPORT_H_
+#define SHM_TRANSPORT_H_
+
+#include <memory>
+#include <unordered_map>
+
+#include "google/protobuf/any.pb.h"
+#include "tensorflow/contrib/shm/shm_segment.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+
+// Moves tensor content between worker processes on the same host through
+// POSIX shared memory, leaving only the metadata on the gRPC channel.
+//
+// Each process writes the tensors it serves in a segment it owns. A client
+// maps the segment of a peer when the first response from that peer names
+// it, and the peer only writes the tensors for the client to its segment once
+// the client reports having mapped it. A client that cannot map the segment
+// of a peer receives all the tensors of that peer through gRPC.
+class ShmTransport {
+ public:
+  // Creates the segment of this process.  Its size is taken from the
+  // TF_SHM_SEGMENT_BYTES environment variable.
+  static Status Create(std::unique_ptr<ShmTransport>* transport);
+
+  // Identifies the host and IPC namespace of this process.  Empty if it
+  // cannot be determined, in which case no peer is considered co-located.
+  const string& host_id() const { return host_id_; }
+
+  // Fills the options a client attaches to its RecvTensorRequest to 'peer'
+  // to offer shared memory transport.  Nothing is offered to the peers whose
+  // segment cannot be mapped.
+  void ClientOptions(const string& peer,
+                     ::google::protobuf::Any* transport_options);
+
+  // Returns true if the client that sent 'transport_options' shares the host
+  // and IPC namespace of this process.  Sets '*mapped' to true if the client
+  // has also mapped the segment of this process.
+  bool IsColocated(const ::google::protobuf::Any& transport_options,
+                   bool* mapped) const;
+
+  // Describes the segment of this process in 'transport_options', for a
+  // co-located client that has not mapped it yet.
+  void SegmentInfo(::google::protobuf::Any* transport_options) const;
+
+  // Copies the content of 'tensor', which must be in host memory, to the
+  // segment of this process and describes where it is in
+  // 'transport_options'.  Returns false if the segment has no room for it.
+  bool TransportOptionsFromTensor(::google::protobuf::Any* transport_options,
+                                  const Tensor& tensor);
+
+  // Handles the 'transport_options' of a response from 'peer'.  If they
+  // describe a region of the segment of 'peer', copies its content to
+  // 'tensor', which must be in host memory and already have the right shape
+  // and type.  If they describe the segment of 'peer', the tensor is already
+  // in the response, and the segment is mapped for the next responses.
+  Status TensorFromTransportOptions(
+      const string& peer, Tensor* tensor,
+      const ::google::protobuf::Any& transport_options);
+
+ private:
+  ShmTransport(const string& host_id, std::unique_ptr<ShmSegment> segment);
+
+  // Maps the segment 'name' of 'peer', or marks 'peer' as not shareable if
+  // it cannot be mapped.
+  void MapPeerSegment(const string& peer, const string& name);
+
+  Status GetPeerSegment(const string& name, ShmSegment** segment);
+
+  const string host_id_;
+  std::unique_ptr<ShmSegment> segment_;
+
+  mutex mu_;
+  std::unordered_map<string, std::unique_ptr<ShmSegment>> peer_segments_
+      GUARDED_BY(mu_);
+  // The segment mapped for each peer, or nullptr if the segment of the peer
+  // cannot be mapped.  The peers not in the map have not sent their segment
+  // yet.
+  std::unordered_map<string, ShmSegment*> peers_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ShmTransport);
+};
+
+}  // namespace tensorflow
+
+#endif  // SHM_TRANSPORT_H_
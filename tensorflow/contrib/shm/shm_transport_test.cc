@@ -0,0 +1,101 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/contrib/shm/shm_transport.h"
+
+#include <stdlib.h>
+
+#include "google/protobuf/any.pb.h"
+#include "tensorflow/contrib/shm/shm.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class ShmTransportTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    setenv("TF_SHM_SEGMENT_BYTES", "65536", 1);
+    TF_ASSERT_OK(ShmTransport::Create(&server_));
+    TF_ASSERT_OK(ShmTransport::Create(&client_));
+  }
+
+  // Sends the options of a request from the client to the server, and
+  // returns whether the server sees the client as co-located.
+  bool IsColocated(bool* mapped) {
+    ::google::protobuf::Any request_options;
+    client_->ClientOptions("server", &request_options);
+    return server_->IsColocated(request_options, mapped);
+  }
+
+  std::unique_ptr<ShmTransport> server_;
+  std::unique_ptr<ShmTransport> client_;
+};
+
+TEST_F(ShmTransportTest, MapsSegmentBeforeWritingToIt) {
+  if (server_->host_id().empty()) {
+    LOG(INFO) << "Cannot identify the host, skipping test";
+    return;
+  }
+  bool mapped = true;
+  ASSERT_TRUE(IsColocated(&mapped));
+  EXPECT_FALSE(mapped);
+
+  // The first response names the segment of the server.
+  Tensor in_band = test::AsTensor<float>({1, 2, 3});
+  ::google::protobuf::Any response_options;
+  server_->SegmentInfo(&response_options);
+  TF_ASSERT_OK(client_->TensorFromTransportOptions("server", &in_band,
+                                                   response_options));
+  test::ExpectTensorEqual<float>(test::AsTensor<float>({1, 2, 3}), in_band);
+
+  ASSERT_TRUE(IsColocated(&mapped));
+  EXPECT_TRUE(mapped);
+  const Tensor val = test::AsTensor<float>({4, 5, 6});
+  ASSERT_TRUE(server_->TransportOptionsFromTensor(&response_options, val));
+  Tensor received(DT_FLOAT, val.shape());
+  TF_ASSERT_OK(client_->TensorFromTransportOptions("server", &received,
+                                                   response_options));
+  test::ExpectTensorEqual<float>(val, received);
+}
+
+TEST_F(ShmTransportTest, FallsBackToGrpcIfSegmentCannotBeMapped) {
+  if (server_->host_id().empty()) {
+    LOG(INFO) << "Cannot identify the host, skipping test";
+    return;
+  }
+  Tensor in_band = test::AsTensor<float>({1, 2, 3});
+  ShmSegmentInfo info;
+  info.set_segment_name("/tf_shm_test_does_not_exist");
+  ::google::protobuf::Any response_options;
+  response_options.PackFrom(info);
+  // The tensor in the response is still received.
+  TF_ASSERT_OK(client_->TensorFromTransportOptions("server", &in_band,
+                                                   response_options));
+
+  // No shared memory transport is offered to the server anymore.
+  ::google::protobuf::Any request_options;
+  client_->ClientOptions("server", &request_options);
+  bool mapped = false;
+  EXPECT_FALSE(server_->IsColocated(request_options, &mapped));
+  // Other peers are not affected.
+  client_->ClientOptions("other", &request_options);
+  EXPECT_TRUE(server_->IsColocated(request_options, &mapped));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,153 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/contrib/shm/shm_worker.h"
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#if GOOGLE_CUDA
+#include "tensorflow/core/common_runtime/gpu/gpu_util.h"
+#endif  // GOOGLE_CUDA
+#include "tensorflow/core/distributed_runtime/rendezvous_mgr_interface.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
+#include "tensorflow/core/distributed_runtime/worker.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/tracing.h"
+
+namespace tensorflow {
+
+ShmWorker::ShmWorker(WorkerEnv* worker_env, ShmTransport* shm_transport)
+    : GrpcWorker(worker_env),
+      shm_transport_(shm_transport),
+      recv_tensor_recent_request_ids_(100000) {}
+
+void ShmWorker::GrpcRecvTensorAsync(CallOptions* opts,
+                                    const RecvTensorRequest* request,
+                                    ::grpc::ByteBuffer* response,
+                                    StatusCallback done) {
+  bool mapped = false;
+  if (!request->has_transport_options() ||
+      !shm_transport_->IsColocated(request->transport_options(), &mapped)) {
+    GrpcWorker::GrpcRecvTensorAsync(opts, request, response, done);
+    return;
+  }
+
+  Status s = recv_tensor_recent_request_ids_.TrackUnique(
+      request->request_id(), "RecvTensor (ShmWorker)", *request);
+  if (!s.ok()) {
+    done(s);
+    return;
+  }
+
+  const int64 step_id = request->step_id();
+  const string& key = request->rendezvous_key();
+  TRACEPRINTF("RecvTensor: %lld %s", step_id, key.c_str());
+  Rendezvous::ParsedKey parsed;
+  s = Rendezvous::ParseKey(key, &parsed);
+  Device* src_dev = nullptr;
+  if (s.ok()) {
+    s = PrepareRecvTensor(parsed, &src_dev);
+  }
+  if (!s.ok()) {
+    done(s);
+    return;
+  }
+
+  // Request the tensor associated with the rendezvous key. Any time
+  // while waiting for the tensor to be produced, up until the start
+  // of execution of the callback lambda body below, an RPC
+  // cancellation should abort the rendezvous.
+  opts->SetCancelCallback([this, step_id]() { AbortStep(step_id); });
+  env_->rendezvous_mgr->RecvLocalAsync(
+      step_id, parsed,
+      [this, opts, response, done, src_dev, request, mapped](
+          const Status& status, const Rendezvous::Args& send_args,
+          const Rendezvous::Args&, const Tensor& val, const bool is_dead) {
+        opts->ClearCancelCallback();
+        if (!status.ok()) {
+          done(status);
+          return;
+        }
+        const bool on_host =
+            (src_dev->tensorflow_gpu_device_info() == nullptr) ||
+            send_args.alloc_attrs.on_host();
+        if (on_host && val.TotalBytes() > 0 && (!is_dead) &&
+            DMAHelper::CanUseDMA(&val)) {
+          RecvTensorResponse proto;
+          proto.set_is_dead(is_dead);
+          proto.set_send_start_micros(Env::Default()->NowMicros());
+          if (!mapped) {
+            // The client has not mapped the segment of this process yet.
+            // Sends the content in-band with the name of the segment, which
+            // the client maps for the next requests.
+            val.AsProtoTensorContent(proto.mutable_tensor());
+            shm_transport_->SegmentInfo(proto.mutable_transport_options());
+            grpc::EncodeRecvTensorResponseToByteBuffer(proto, response);
+            done(Status::OK());
+            return;
+          }
+          // Shared memory cases.  The client copies the content out of the
+          // segment of this process when it parses the response.
+          TensorProto* tensor_proto = proto.mutable_tensor();
+          tensor_proto->set_dtype(val.dtype());
+          val.shape().AsProto(tensor_proto->mutable_tensor_shape());
+          if (shm_transport_->TransportOptionsFromTensor(
+                  proto.mutable_transport_options(), val)) {
+            grpc::EncodeRecvTensorResponseToByteBuffer(proto, response);
+            done(Status::OK());
+            return;
+          }
+          VLOG(1) << "Shared memory segment is full, sending "
+                  << val.TotalBytes() << " bytes in-band";
+        }
+        // In-band cases.
+        if (!on_host) {
+#if GOOGLE_CUDA
+          const DeviceContext* send_dev_context = send_args.device_context;
+          AllocatorAttributes alloc_attrs;
+          alloc_attrs.set_gpu_compatible(true);
+          alloc_attrs.set_on_host(true);
+          Allocator* alloc = src_dev->GetAllocator(alloc_attrs);
+          Tensor* copy = new Tensor(alloc, val.dtype(), val.shape());
+          CHECK(send_dev_context)
+              << "send dev name: " << src_dev->name()
+              << " gpu_info: " << src_dev->tensorflow_gpu_device_info();
+          // "val" is on a GPU. Uses GPUUtil to fill the response proto.
+          StatusCallback copy_ready = [request, response, done, copy,
+                                       is_dead](const Status& s) {
+            // The value is now ready to be returned on the wire.
+            grpc::EncodeTensorToByteBuffer(is_dead, *copy,
+                                           request->compression(), response);
+            done(s);
+            delete copy;
+          };
+
+          GPUUtil::CopyGPUTensorToCPU(src_dev, send_dev_context, &val, copy,
+                                      copy_ready);
+#else
+          done(errors::Internal("No GPU device in process"));
+#endif  // GOOGLE_CUDA
+        } else {
+          grpc::EncodeTensorToByteBuffer(is_dead, val, request->compression(),
+                                         response);
+          done(Status::OK());
+        }
+      });
+}
+
+}  // namespace tensorflow
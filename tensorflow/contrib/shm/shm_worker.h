@@ -0,0 +1,47 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef SHM_WORKER_H_
+#define SHM_WORKER_H_
+
+#include "tensorflow/contrib/shm/shm_transport.h"
+
+#include "tensorflow/core/distributed_runtime/recent_request_ids.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service.h"
+
+namespace tensorflow {
+
+class ShmWorker : public GrpcWorker {
+ public:
+  ShmWorker(WorkerEnv* env, ShmTransport* shm_transport);
+
+  // Serve the RecvTensorRequest of a client on the same host but omit the
+  // tensor content and pass it through shared memory whenever possible.
+  // If it's not possible, it falls back to gRPC in-band tensor transport by
+  // encoding the tensor content into the grpc::ByteBuffer.
+  // Requests from other hosts are served by GrpcWorker.
+  virtual void GrpcRecvTensorAsync(CallOptions* opts,
+                                   const RecvTensorRequest* request,
+                                   ::grpc::ByteBuffer* response,
+                                   StatusCallback done) override;
+
+ private:
+  ShmTransport* shm_transport_;  // Not owned
+  RecentRequestIds recv_tensor_recent_request_ids_;
+};
+
+}  // namespace tensorflow
+
+#endif  // SHM_WORKER_H_
@@ -18,13 +18,25 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/copy_tensor.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/common_runtime/hierarchical_reducer.h"
 #include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/common_runtime/recursive_halving_reducer.h"
 #include "tensorflow/core/common_runtime/ring_reducer.h"
 #include "tensorflow/core/lib/core/notification.h"
 
 #define VALUE_IN_DEBUG_STRING false
 
 namespace tensorflow {
+CollectiveReductionAlgorithm SelectReductionAlgorithm(
+    const CollectiveParams& col_params) {
+  // The param resolver replaces AUTO_REDUCTION by an algorithm suited to the
+  // tensor size and group topology, so only params built without it get here.
+  if (col_params.instance.impl_details.reduction_algorithm == AUTO_REDUCTION) {
+    return RING_REDUCTION;
+  }
+  return col_params.instance.impl_details.reduction_algorithm;
+}
+
 /*static*/
 int64 CollectiveAdapter::AlignedChunkElts(int64 elt_bytes, int64 total_elts,
                                           int64 num_chunks) {
@@ -214,10 +226,8 @@ void BaseCollectiveExecutor::ExecuteAsync(OpKernelContext* ctx,
   string error;
   switch (col_params.instance.type) {
     case REDUCTION_COLLECTIVE: {
-      // TODO(tucker): support other reduction algorithms,
-      // e.g. tree-reduce, hybrid tree/ring, delegate-to-NCCL, etc.
       const Tensor* input = &ctx->input(0);
-      RingReducer* reducer =
+      CollectiveReducer* reducer =
           CreateReducer(ctx, CtxParams(ctx), col_params, exec_key, step_id_,
                         input, output, &error);
       if (!reducer) {
@@ -258,7 +268,7 @@ void BaseCollectiveExecutor::ExecuteAsync(OpKernelContext* ctx,
   }
 }
 
-RingReducer* BaseCollectiveExecutor::CreateReducer(
+CollectiveReducer* BaseCollectiveExecutor::CreateReducer(
     OpKernelContext* ctx, OpKernelContext::Params* params,
     const CollectiveParams& col_params, const string& exec_key, int64 step_id,
     const Tensor* input, Tensor* output, string* error) {
@@ -274,8 +284,19 @@ RingReducer* BaseCollectiveExecutor::CreateReducer(
     case DT_FLOAT:
     case DT_DOUBLE:
     case DT_INT64:
-      return new RingReducer(this, dev_mgr_, ctx, params, col_params, exec_key,
-                             step_id, input, output);
+      switch (SelectReductionAlgorithm(col_params)) {
+        case RECURSIVE_HALVING_REDUCTION:
+          return new RecursiveHalvingReducer(this, dev_mgr_, ctx, params,
+                                             col_params, exec_key, step_id,
+                                             input, output);
+        case HIERARCHICAL_REDUCTION:
+          return new HierarchicalReducer(this, dev_mgr_, ctx, params,
+                                         col_params, exec_key, step_id, input,
+                                         output);
+        default:
+          return new RingReducer(this, dev_mgr_, ctx, params, col_params,
+                                 exec_key, step_id, input, output);
+      }
       break;
     default:
       *error = strings::StrCat("Collective Reduce does not support datatype ",
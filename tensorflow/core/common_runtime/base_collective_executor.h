@@ -23,7 +23,23 @@ limitations under the License.
 namespace tensorflow {
 class Broadcaster;
 class DeviceMgr;
-class RingReducer;
+
+// Interface of the classes implementing an all-reduce algorithm for a
+// single device.
+class CollectiveReducer {
+ public:
+  virtual ~CollectiveReducer() {}
+
+  // Runs the reduction, possibly blocking the calling thread, and calls
+  // "done" once the output holds the reduced value or on error.
+  virtual void Run(StatusCallback done) = 0;
+};
+
+// Returns the algorithm to use for an all-reduce: the one set in
+// col_params, normally by the param resolver, or RING_REDUCTION if it is
+// still AUTO_REDUCTION.
+CollectiveReductionAlgorithm SelectReductionAlgorithm(
+    const CollectiveParams& col_params);
 
 // Helper interface that aliases regular subfields of a Tensor as separate
 // Tensors for in-place update.
@@ -133,12 +149,12 @@ class BaseCollectiveExecutor : public CollectiveExecutor {
   std::unique_ptr<PerStepCollectiveRemoteAccess> remote_access_;
 
  private:
-  RingReducer* CreateReducer(OpKernelContext* ctx,
-                             OpKernelContext::Params* params,
-                             const CollectiveParams& col_params,
-                             const string& exec_key, int64 step_id,
-                             const Tensor* input, Tensor* output,
-                             string* error);
+  CollectiveReducer* CreateReducer(OpKernelContext* ctx,
+                                   OpKernelContext::Params* params,
+                                   const CollectiveParams& col_params,
+                                   const string& exec_key, int64 step_id,
+                                   const Tensor* input, Tensor* output,
+                                   string* error);
 
   Broadcaster* CreateBroadcaster(OpKernelContext* ctx,
                                  OpKernelContext::Params* params,
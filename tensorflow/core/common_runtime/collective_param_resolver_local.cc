@@ -314,6 +314,38 @@ void SortDevicesAndTasks(CollectiveParams* cp) {
   SetDevPerTask(cp);
 }
 
+// Reductions of tensors smaller than this are latency bound: they use the
+// algorithm with the fewest rounds rather than the pipelined ring.
+constexpr int64 kSmallReductionBytes = 1 << 20;
+
+// If cp is a reduction that does not ask for a specific algorithm, pick one
+// from the tensor size and the group topology.  These are the same in every
+// task of the group, so all of its members make the same choice.
+void SetReductionAlgorithm(CollectiveParams* cp) {
+  CollImplDetails* impl = &cp->instance.impl_details;
+  if (cp->instance.type != REDUCTION_COLLECTIVE ||
+      impl->reduction_algorithm != AUTO_REDUCTION) {
+    return;
+  }
+  const int group_size = cp->group.group_size;
+  const int num_tasks = cp->group.num_tasks;
+  const int64 tensor_bytes = cp->instance.shape.num_elements() *
+                             DataTypeSize(cp->instance.data_type);
+  if (group_size <= 2) {
+    impl->reduction_algorithm = RING_REDUCTION;
+  } else if (tensor_bytes < kSmallReductionBytes) {
+    impl->reduction_algorithm = RECURSIVE_HALVING_REDUCTION;
+  } else if (num_tasks > 1 && num_tasks < group_size) {
+    // With several devices per task, reduce within each task first so that
+    // only one device per task sends the tensor over the network.
+    impl->reduction_algorithm = HIERARCHICAL_REDUCTION;
+  } else {
+    impl->reduction_algorithm = RING_REDUCTION;
+  }
+  VLOG(1) << "Reduction algorithm " << impl->reduction_algorithm
+          << " for instance " << cp->instance.instance_key;
+}
+
 // Establish the requested number of subdivision permutations based on the
 // ring order implicit in the device order.
 void GenerateSubdivPerms(const string& device, int source_rank,
@@ -453,6 +485,8 @@ void CollectiveParamResolverLocal::InitInstanceSharedParams(
   // corresponding order.
   SortDevicesAndTasks(&ir->shared);
 
+  SetReductionAlgorithm(&ir->shared);
+
   // Get Locality data for all devices.
 
   // Set is_local and task_names in *shared prior to invoking
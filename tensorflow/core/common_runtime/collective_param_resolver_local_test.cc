@@ -92,6 +92,9 @@ TEST_F(CollectiveParamResolverLocalTest, CompleteParamsReduction1Task) {
     }
     EXPECT_EQ(cps[i].subdiv_rank[0], i);
     EXPECT_EQ(cps[i].instance.impl_details.subdiv_source_rank.size(), 0);
+    // A small tensor over three devices.
+    EXPECT_EQ(cps[i].instance.impl_details.reduction_algorithm,
+              RECURSIVE_HALVING_REDUCTION);
     EXPECT_FALSE(cps[i].is_source);
     EXPECT_EQ(cps[i].default_rank, i);
     EXPECT_TRUE(cps[i].instance.same_num_devices_per_task);
@@ -0,0 +1,268 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/exchange_reducer.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace {
+
+// Used for executing a sub-operation, e.g. a merge_op instance, with an
+// OpKernelContext based on the one passed into the collective Op.
+class SubContext {
+ public:
+  SubContext(OpKernelContext* ctx, OpKernelContext::Params* params,
+             OpKernel* op, Tensor* output, Tensor* input)
+      : sub_params_(*params),
+        sub_inputs_({output, input}),
+        sub_input_attr_({ctx->input_alloc_attr(0), ctx->input_alloc_attr(0)}),
+        sub_input_dc_(
+            {ctx->input_device_context(0), ctx->input_device_context(0)}) {
+    sub_params_.op_kernel = op;
+    sub_params_.inputs = &sub_inputs_;
+    sub_params_.input_alloc_attrs = &sub_input_attr_;
+    sub_params_.input_device_contexts = &sub_input_dc_;
+    sub_params_.eigen_gpu_device = nullptr;
+    sub_params_.ensure_eigen_gpu_device();
+    sub_params_.forward_from_array = &forward_from_;
+    sub_ctx_.reset(new OpKernelContext(&sub_params_, 1));
+  }
+
+  OpKernelContext* sub_ctx() { return sub_ctx_.get(); }
+
+ private:
+  OpKernelContext::Params sub_params_;
+  gtl::InlinedVector<TensorValue, 4> sub_inputs_;
+  gtl::InlinedVector<AllocatorAttributes, 4> sub_input_attr_;
+  gtl::InlinedVector<DeviceContext*, 4> sub_input_dc_;
+  // The binary ops compute in-place on the first input.
+  int forward_from_ = 0;
+  std::unique_ptr<OpKernelContext> sub_ctx_;
+};
+
+}  // namespace
+
+ExchangeReducer::ExchangeReducer(CollectiveExecutor* col_exec,
+                                 const DeviceMgr* dev_mgr, OpKernelContext* ctx,
+                                 OpKernelContext::Params* op_params,
+                                 const CollectiveParams& col_params,
+                                 const string& exec_key, int64 step_id,
+                                 const Tensor* input, Tensor* output)
+    : col_params_(col_params),
+      rank_(col_params.default_rank),
+      group_size_(col_params.group.group_size),
+      col_exec_(col_exec),
+      dev_mgr_(dev_mgr),
+      ctx_(ctx),
+      op_params_(op_params),
+      exec_key_(exec_key),
+      step_id_(step_id),
+      input_(input),
+      output_(output),
+      device_(nullptr) {
+  CHECK_GT(group_size_, 0);
+  CHECK_EQ(group_size_,
+           static_cast<int>(col_params_.instance.device_names.size()));
+}
+
+void ExchangeReducer::Run(StatusCallback done) {
+  CHECK(dev_mgr_);
+  Status status = dev_mgr_->LookupDevice(
+      col_params_.instance.device_names[rank_], &device_);
+  if (!status.ok()) {
+    LOG(ERROR) << "Failed to find device "
+               << col_params_.instance.device_names[rank_];
+    done(status);
+    return;
+  }
+  device_locality_ = device_->attributes().locality();
+
+  VLOG(1) << this << " default_rank " << rank_ << " cp " << &col_params_
+          << ": " << col_params_.ToString();
+
+  status = CopyInputToOutput();
+  if (status.ok()) {
+    ca_.reset(MakeCollectiveAdapter(
+        output_, NumChunks(),
+        device_->GetAllocator(ctx_->output_alloc_attr(0))));
+    status = MakeGroupSizeTensor();
+  }
+  if (status.ok()) {
+    status = RunRounds();
+  }
+  if (status.ok()) {
+    ca_->ConsumeFinalValue(output_);
+  } else {
+    StartAbort(status);
+  }
+  {
+    mutex_lock l(status_mu_);
+    status = status_;
+  }
+  done(status);
+}
+
+// Start by copying input to output if they're not already the same, i.e. if
+// we're not computing in-place on the input tensor.
+Status ExchangeReducer::CopyInputToOutput() {
+  if ((input_ == output_) ||
+      (DMAHelper::base(input_) == DMAHelper::base(output_))) {
+    return Status::OK();
+  }
+  Status status;
+  Notification note;
+  CollectiveRemoteAccessLocal::MemCpyAsync(
+      ctx_->input_device_context(0), ctx_->op_device_context(), device_,
+      device_, ctx_->input_alloc_attr(0), ctx_->output_alloc_attr(0), input_,
+      output_, [&note, &status](const Status& s) {
+        status.Update(s);
+        note.Notify();
+      });
+  note.WaitForNotification();
+  return status;
+}
+
+// Creates an on-device scalar value from group_size_, for the final_op.
+Status ExchangeReducer::MakeGroupSizeTensor() {
+  if (!col_params_.final_op) return Status::OK();
+  Tensor group_size_val = ca_->Scalar(group_size_);
+  if (col_params_.group.device_type == "CPU") {
+    group_size_tensor_ = group_size_val;
+    return Status::OK();
+  }
+  group_size_tensor_ =
+      ca_->Scalar(device_->GetAllocator(ctx_->input_alloc_attr(0)));
+  Status status;
+  Notification note;
+  ctx_->op_device_context()->CopyCPUTensorToDevice(
+      &group_size_val, device_, &group_size_tensor_,
+      [&note, &status](const Status& s) {
+        status.Update(s);
+        note.Notify();
+      });
+  note.WaitForNotification();
+  return status;
+}
+
+void ExchangeReducer::StartAbort(const Status& s) {
+  bool abort_started = false;
+  {
+    mutex_lock l(status_mu_);
+    if (status_.ok()) {
+      LOG(ERROR) << "Aborting all-reduce with " << s;
+      abort_started = true;
+      status_.Update(s);
+    }
+  }
+  // Cancel the outstanding transfers of this device, and of the peers
+  // waiting on this device.
+  if (abort_started) {
+    col_exec_->StartAbort(s);
+  }
+}
+
+Tensor ExchangeReducer::ChunkRange(int first, int num) const {
+  const Tensor& flat = ca_->Value();
+  const int64 total_elts = flat.NumElements();
+  const int64 chunk_elts = CollectiveAdapter::AlignedChunkElts(
+      DataTypeSize(flat.dtype()), total_elts, NumChunks());
+  const int64 start = std::min(total_elts, first * chunk_elts);
+  const int64 limit = std::min(total_elts, (first + num) * chunk_elts);
+  return flat.Slice(start, limit);
+}
+
+Tensor ExchangeReducer::TempRange(int first, int num) const {
+  return Tensor(device_->GetAllocator(ctx_->output_alloc_attr(0)),
+                col_params_.instance.data_type,
+                TensorShape({ChunkRange(first, num).NumElements()}));
+}
+
+string ExchangeReducer::BufKey(const string& round, int src_rank,
+                               int dst_rank) const {
+  return strings::StrCat(exec_key_, ":", round, ":", src_rank, ":", dst_rank);
+}
+
+Status ExchangeReducer::Exchange(const string& round, int send_to,
+                                 const Tensor* send_value, int recv_from,
+                                 Tensor* recv_value) {
+  const bool do_send = send_to >= 0 && send_value->NumElements() > 0;
+  const bool do_recv = recv_from >= 0 && recv_value->NumElements() > 0;
+  mutex mu;
+  Status status;
+  Notification send_done;
+  Notification recv_done;
+  // On error abort right away: the other transfer may be waiting on a peer
+  // that will never show up.
+  auto done = [this, &mu, &status](Notification* note, const Status& s) {
+    if (!s.ok()) {
+      {
+        mutex_lock l(mu);
+        status.Update(s);
+      }
+      StartAbort(s);
+    }
+    note->Notify();
+  };
+  if (do_send) {
+    col_exec_->PostToPeer(
+        col_params_.instance.device_names[send_to],
+        col_params_.instance.task_names[send_to], BufKey(round, rank_, send_to),
+        device_, ctx_->op_device_context(), ctx_->output_alloc_attr(0),
+        send_value, device_locality_, [&done, &send_done](const Status& s) {
+          done(&send_done, s);
+        });
+  }
+  if (do_recv) {
+    col_exec_->RecvFromPeer(
+        col_params_.instance.device_names[recv_from],
+        col_params_.instance.task_names[recv_from],
+        col_params_.task.is_local[recv_from], BufKey(round, recv_from, rank_),
+        device_, ctx_->op_device_context(), ctx_->output_alloc_attr(0),
+        recv_value, device_locality_, [&done, &recv_done](const Status& s) {
+          done(&recv_done, s);
+        });
+  }
+  if (do_send) send_done.WaitForNotification();
+  if (do_recv) recv_done.WaitForNotification();
+  mutex_lock l(mu);
+  return status;
+}
+
+Status ExchangeReducer::Merge(Tensor* output, Tensor* input) {
+  if (output->NumElements() == 0) return Status::OK();
+  return ComputeBinOp(col_params_.merge_op.get(), output, input);
+}
+
+Status ExchangeReducer::Finalize(Tensor* value) {
+  if (!col_params_.final_op || value->NumElements() == 0) {
+    return Status::OK();
+  }
+  return ComputeBinOp(col_params_.final_op.get(), value, &group_size_tensor_);
+}
+
+Status ExchangeReducer::ComputeBinOp(OpKernel* op, Tensor* output,
+                                     Tensor* input) {
+  SubContext sub_ctx(ctx_, op_params_, op, output, input);
+  device_->Compute(op, sub_ctx.sub_ctx());
+  return sub_ctx.sub_ctx()->status();
+}
+
+}  // namespace tensorflow
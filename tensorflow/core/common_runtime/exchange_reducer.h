@@ -0,0 +1,108 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_EXCHANGE_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_EXCHANGE_REDUCER_H_
+
+#include <memory>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/device_attributes.pb.h"
+
+namespace tensorflow {
+class DeviceMgr;
+
+// Base class of the all-reduce algorithms that proceed in synchronous
+// rounds, in each of which a device exchanges a contiguous range of chunks
+// of the tensor with at most one peer in each direction.  Such algorithms
+// need fewer steps than RingReducer, whose number of steps is linear in the
+// group size, at the price of no overlap between the rounds.
+//
+// Devices are identified by their default rank, i.e. their index in
+// col_params.instance.device_names.
+class ExchangeReducer : public CollectiveReducer {
+ public:
+  ExchangeReducer(CollectiveExecutor* col_exec, const DeviceMgr* dev_mgr,
+                  OpKernelContext* ctx, OpKernelContext::Params* op_params,
+                  const CollectiveParams& col_params, const string& exec_key,
+                  int64 step_id, const Tensor* input, Tensor* output);
+
+  ~ExchangeReducer() override {}
+
+  // Blocks until the reduction is complete, so it must run in a blockable
+  // thread.
+  void Run(StatusCallback done) override;
+
+ protected:
+  // Number of chunks the tensor is divided into.
+  virtual int NumChunks() const = 0;
+
+  // Runs the rounds of the algorithm.  On entry the output holds the input
+  // value of this device, on exit it must hold the final reduced value.
+  virtual Status RunRounds() = 0;
+
+  // Returns a tensor aliasing chunks [first, first + num) of the output.
+  Tensor ChunkRange(int first, int num) const;
+
+  // Returns a tensor with its own backing buffer on the device, with the
+  // size of ChunkRange(first, num).
+  Tensor TempRange(int first, int num) const;
+
+  // Sends 'send_value' to the device of rank 'send_to' and receives
+  // 'recv_value' from the device of rank 'recv_from', then waits for both
+  // transfers to complete.  A negative rank or an empty tensor skips the
+  // corresponding transfer.  'round' must identify the round uniquely
+  // within the algorithm.
+  Status Exchange(const string& round, int send_to, const Tensor* send_value,
+                  int recv_from, Tensor* recv_value);
+
+  // Reduces 'input' into 'output' with the merge_op.
+  Status Merge(Tensor* output, Tensor* input);
+
+  // Applies the final_op, if any, to 'value' once it holds the reduction of
+  // the values of all the devices.
+  Status Finalize(Tensor* value);
+
+  const CollectiveParams& col_params_;
+  const int rank_;
+  const int group_size_;
+
+ private:
+  // Called when a bad status is received that implies we should terminate
+  // execution and return a bad status.
+  void StartAbort(const Status& s);
+  Status CopyInputToOutput();
+  Status MakeGroupSizeTensor();
+  Status ComputeBinOp(OpKernel* op, Tensor* output, Tensor* input);
+  string BufKey(const string& round, int src_rank, int dst_rank) const;
+
+  CollectiveExecutor* col_exec_;        // Not owned
+  const DeviceMgr* dev_mgr_;            // Not owned
+  OpKernelContext* ctx_;                // Not owned
+  OpKernelContext::Params* op_params_;  // Not owned
+  const string exec_key_;
+  const int64 step_id_;
+  const Tensor* input_;  // Not owned
+  Tensor* output_;       // Not owned
+  Device* device_;       // The device for which this instance labors
+  DeviceLocality device_locality_;
+  std::unique_ptr<CollectiveAdapter> ca_;
+  Tensor group_size_tensor_;
+  mutex status_mu_;
+  Status status_ GUARDED_BY(status_mu_);
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_EXCHANGE_REDUCER_H_
@@ -0,0 +1,95 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_reducer.h"
+
+#include <unordered_map>
+
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+
+HierarchicalReducer::HierarchicalReducer(
+    CollectiveExecutor* col_exec, const DeviceMgr* dev_mgr,
+    OpKernelContext* ctx, OpKernelContext::Params* op_params,
+    const CollectiveParams& col_params, const string& exec_key, int64 step_id,
+    const Tensor* input, Tensor* output)
+    : ExchangeReducer(col_exec, dev_mgr, ctx, op_params, col_params, exec_key,
+                      step_id, input, output),
+      task_idx_(-1) {
+  const std::vector<string>& task_names = col_params.instance.task_names;
+  std::unordered_map<string, int> task_leader;
+  for (int r = 0; r < group_size_; ++r) {
+    if (task_leader.emplace(task_names[r], r).second) {
+      leaders_.push_back(r);
+    }
+    if (task_names[r] == task_names[rank_]) {
+      task_ranks_.push_back(r);
+    }
+  }
+  for (int i = 0; i < leaders_.size(); ++i) {
+    if (leaders_[i] == task_ranks_[0]) task_idx_ = i;
+  }
+  CHECK_GE(task_idx_, 0);
+}
+
+Status HierarchicalReducer::RunRounds() {
+  const int num_tasks = leaders_.size();
+  Tensor all = ChunkRange(0, num_tasks);
+  const int leader = task_ranks_[0];
+  if (rank_ != leader) {
+    TF_RETURN_IF_ERROR(Exchange("gather", leader, &all, -1, nullptr));
+    return Exchange("bcast", -1, nullptr, leader, &all);
+  }
+
+  // Reduce the values of the task.
+  Tensor tmp = TempRange(0, num_tasks);
+  for (int i = 1; i < task_ranks_.size(); ++i) {
+    TF_RETURN_IF_ERROR(Exchange("gather", -1, nullptr, task_ranks_[i], &tmp));
+    TF_RETURN_IF_ERROR(Merge(&all, &tmp));
+  }
+
+  // Ring all-reduce among the leaders, with one chunk per task.  After the
+  // reduce-scatter pass, leader i holds the reduced value of chunk i + 1.
+  const int send_to = leaders_[(task_idx_ + 1) % num_tasks];
+  const int recv_from = leaders_[(task_idx_ + num_tasks - 1) % num_tasks];
+  for (int step = 0; step < num_tasks - 1; ++step) {
+    const int send_chunk = (task_idx_ + num_tasks - step) % num_tasks;
+    const int recv_chunk = (task_idx_ + num_tasks - step - 1) % num_tasks;
+    Tensor send = ChunkRange(send_chunk, 1);
+    Tensor recv = TempRange(recv_chunk, 1);
+    TF_RETURN_IF_ERROR(Exchange(strings::StrCat("rs", step), send_to, &send,
+                                recv_from, &recv));
+    Tensor acc = ChunkRange(recv_chunk, 1);
+    TF_RETURN_IF_ERROR(Merge(&acc, &recv));
+  }
+  Tensor owned = ChunkRange((task_idx_ + 1) % num_tasks, 1);
+  TF_RETURN_IF_ERROR(Finalize(&owned));
+  for (int step = 0; step < num_tasks - 1; ++step) {
+    const int send_chunk = (task_idx_ + 1 + num_tasks - step) % num_tasks;
+    const int recv_chunk = (task_idx_ + num_tasks - step) % num_tasks;
+    Tensor send = ChunkRange(send_chunk, 1);
+    Tensor recv = ChunkRange(recv_chunk, 1);
+    TF_RETURN_IF_ERROR(Exchange(strings::StrCat("ag", step), send_to, &send,
+                                recv_from, &recv));
+  }
+
+  // Broadcast the result to the task.
+  for (int i = 1; i < task_ranks_.size(); ++i) {
+    TF_RETURN_IF_ERROR(Exchange("bcast", task_ranks_[i], &all, -1, nullptr));
+  }
+  return Status::OK();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,55 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
+
+#include <vector>
+
+#include "tensorflow/core/common_runtime/exchange_reducer.h"
+
+namespace tensorflow {
+
+// Two-level implementation of collective all-reduce for groups spanning
+// several tasks with several devices each.  The devices of each task first
+// reduce their values into the first device of the task, its leader.  The
+// leaders then all-reduce with the ring algorithm, so that each task sends
+// the tensor over the network once per phase instead of once per device,
+// and each leader finally broadcasts the result to the devices of its task.
+class HierarchicalReducer : public ExchangeReducer {
+ public:
+  HierarchicalReducer(CollectiveExecutor* col_exec, const DeviceMgr* dev_mgr,
+                      OpKernelContext* ctx, OpKernelContext::Params* op_params,
+                      const CollectiveParams& col_params,
+                      const string& exec_key, int64 step_id,
+                      const Tensor* input, Tensor* output);
+
+  ~HierarchicalReducer() override {}
+
+ protected:
+  int NumChunks() const override { return leaders_.size(); }
+  Status RunRounds() override;
+
+ private:
+  // Rank of the leader of each task, in order of first appearance of the
+  // task in col_params.instance.task_names.
+  std::vector<int> leaders_;
+  // Index in leaders_ of the task of this device.
+  int task_idx_;
+  // Ranks of the devices of the task of this device, leader first.
+  std::vector<int> task_ranks_;
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
@@ -0,0 +1,103 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/recursive_halving_reducer.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace {
+int LargestPowerOfTwoNotAbove(int n) {
+  int p = 1;
+  while (p * 2 <= n) p *= 2;
+  return p;
+}
+}  // namespace
+
+RecursiveHalvingReducer::RecursiveHalvingReducer(
+    CollectiveExecutor* col_exec, const DeviceMgr* dev_mgr,
+    OpKernelContext* ctx, OpKernelContext::Params* op_params,
+    const CollectiveParams& col_params, const string& exec_key, int64 step_id,
+    const Tensor* input, Tensor* output)
+    : ExchangeReducer(col_exec, dev_mgr, ctx, op_params, col_params, exec_key,
+                      step_id, input, output),
+      pow2_(LargestPowerOfTwoNotAbove(group_size_)),
+      num_extra_(group_size_ - pow2_) {}
+
+int RecursiveHalvingReducer::RealRank(int virtual_rank) const {
+  return virtual_rank < num_extra_ ? 2 * virtual_rank + 1
+                                   : virtual_rank + num_extra_;
+}
+
+Status RecursiveHalvingReducer::RunRounds() {
+  Tensor all = ChunkRange(0, pow2_);
+  const bool paired = rank_ < 2 * num_extra_;
+  if (paired && rank_ % 2 == 0) {
+    // Hand the value over to the odd device of the pair, and wait for the
+    // result.
+    TF_RETURN_IF_ERROR(Exchange("pre", rank_ + 1, &all, -1, nullptr));
+    return Exchange("post", -1, nullptr, rank_ + 1, &all);
+  }
+  if (paired) {
+    Tensor tmp = TempRange(0, pow2_);
+    TF_RETURN_IF_ERROR(Exchange("pre", -1, nullptr, rank_ - 1, &tmp));
+    TF_RETURN_IF_ERROR(Merge(&all, &tmp));
+  }
+  const int virtual_rank = paired ? rank_ / 2 : rank_ - num_extra_;
+
+  // Reduce-scatter: in each round keep the half of the current range that
+  // the bit of virtual_rank selects, and send the other half to the peer
+  // that keeps it.  Device with virtual rank v ends up owning chunk v.
+  int first = 0;
+  int num = pow2_;
+  for (int dist = pow2_ / 2; dist > 0; dist /= 2) {
+    const int peer = RealRank(virtual_rank ^ dist);
+    num /= 2;
+    const bool keep_lower = (virtual_rank & dist) == 0;
+    const int keep_first = keep_lower ? first : first + num;
+    const int send_first = keep_lower ? first + num : first;
+    Tensor send = ChunkRange(send_first, num);
+    Tensor keep = ChunkRange(keep_first, num);
+    Tensor tmp = TempRange(keep_first, num);
+    TF_RETURN_IF_ERROR(
+        Exchange(strings::StrCat("rs", dist), peer, &send, peer, &tmp));
+    TF_RETURN_IF_ERROR(Merge(&keep, &tmp));
+    first = keep_first;
+  }
+  Tensor owned = ChunkRange(first, num);
+  TF_RETURN_IF_ERROR(Finalize(&owned));
+
+  // All-gather: in each round exchange the owned range with the peer owning
+  // the adjacent range of the same size, doubling the owned range.
+  for (int dist = 1; dist < pow2_; dist *= 2) {
+    const int peer = RealRank(virtual_rank ^ dist);
+    const bool own_lower = (virtual_rank & dist) == 0;
+    const int peer_first = own_lower ? first + num : first - num;
+    Tensor mine = ChunkRange(first, num);
+    Tensor theirs = ChunkRange(peer_first, num);
+    TF_RETURN_IF_ERROR(
+        Exchange(strings::StrCat("ag", dist), peer, &mine, peer, &theirs));
+    first = std::min(first, peer_first);
+    num *= 2;
+  }
+
+  if (paired) {
+    return Exchange("post", rank_ - 1, &all, -1, nullptr);
+  }
+  return Status::OK();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,58 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_RECURSIVE_HALVING_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_RECURSIVE_HALVING_REDUCER_H_
+
+#include "tensorflow/core/common_runtime/exchange_reducer.h"
+
+namespace tensorflow {
+
+// Recursive halving and doubling implementation of collective all-reduce
+// (Rabenseifner's algorithm).  The tensor is reduce-scattered in log2(n)
+// rounds, each exchanging half of the remaining range with a peer, then
+// all-gathered in log2(n) rounds in the opposite order.  It moves as many
+// bytes as the ring algorithm in O(log n) instead of O(n) steps, which makes
+// it preferable for small tensors whose reduction is latency bound.
+//
+// When the group size n is not a power of two, the first 2 * (n - p)
+// devices, where p is the largest power of two below n, are paired: the even
+// device of each pair hands its value to the odd one before the halving
+// rounds and receives the result after the doubling rounds.
+class RecursiveHalvingReducer : public ExchangeReducer {
+ public:
+  RecursiveHalvingReducer(CollectiveExecutor* col_exec,
+                          const DeviceMgr* dev_mgr, OpKernelContext* ctx,
+                          OpKernelContext::Params* op_params,
+                          const CollectiveParams& col_params,
+                          const string& exec_key, int64 step_id,
+                          const Tensor* input, Tensor* output);
+
+  ~RecursiveHalvingReducer() override {}
+
+ protected:
+  int NumChunks() const override { return pow2_; }
+  Status RunRounds() override;
+
+ private:
+  // Returns the rank of the device taking part in the halving and doubling
+  // rounds as the given virtual rank in [0, pow2_).
+  int RealRank(int virtual_rank) const;
+
+  const int pow2_;        // Largest power of two not above group_size_
+  const int num_extra_;   // group_size_ - pow2_
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_RECURSIVE_HALVING_REDUCER_H_
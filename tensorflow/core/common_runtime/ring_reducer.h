@@ -25,16 +25,16 @@ namespace tensorflow {
 class DeviceMgr;
 
 // Ring-algorithm implementation of collective all-reduce.
-class RingReducer {
+class RingReducer : public CollectiveReducer {
  public:
   RingReducer(CollectiveExecutor* col_exec, const DeviceMgr* dev_mgr,
               OpKernelContext* ctx, OpKernelContext::Params* op_params,
               const CollectiveParams& col_params, const string& exec_key,
               int64 step_id, const Tensor* input, Tensor* output);
 
-  virtual ~RingReducer();
+  ~RingReducer() override;
 
-  void Run(StatusCallback done);
+  void Run(StatusCallback done) override;
 
  private:
   // Called when a bad status is received that implies we should terminate
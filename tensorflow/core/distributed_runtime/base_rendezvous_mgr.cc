@@ -82,6 +82,18 @@ void BaseRendezvousMgr::RecvLocalAsync(int64 step_id,
   rendez->RecvLocalAsync(parsed, std::move(done_cb));
 }
 
+void BaseRendezvousMgr::RecvLocalBatchAsync(
+    int64 step_id, const std::vector<Rendezvous::ParsedKey>& parsed,
+    BatchDoneCallback done) {
+  auto rendez = FindOrCreate(step_id);
+  rendez->RecvLocalBatchAsync(
+      parsed, [rendez, done](const Status& s,
+                             const std::vector<BatchedTensor>& tensors) {
+        rendez->Unref();
+        done(s, tensors);
+      });
+}
+
 Status BaseRendezvousMgr::RecvLocal(int64 step_id,
                                     const Rendezvous::ParsedKey& parsed,
                                     Tensor* val, bool* is_dead) {
@@ -358,6 +370,99 @@ void BaseRemoteRendezvous::RecvLocalAsyncInternal(const ParsedKey& parsed,
   local_->RecvAsync(parsed, Args(), std::move(done));
 }
 
+void BaseRemoteRendezvous::RecvLocalBatchAsync(
+    const std::vector<ParsedKey>& parsed,
+    const RendezvousMgrInterface::BatchDoneCallback& done) {
+  auto batch = std::make_shared<BatchRecv>();
+  batch->done = done;
+  std::vector<size_t> to_recv;
+  {
+    mutex_lock l(batch_mu_);
+    for (size_t i = 0; i < parsed.size(); ++i) {
+      const string key = parsed[i].FullKey().ToString();
+      auto it = batched_values_.find(key);
+      if (it == batched_values_.end()) {
+        batched_values_[key].waiter = batch;
+        batch->keys.push_back(key);
+        to_recv.push_back(i);
+      } else if (it->second.ready) {
+        // Produced after an earlier call responded without it.
+        batch->status.Update(it->second.status);
+        batch->ready.push_back(std::move(it->second.tensor));
+        batched_values_.erase(it);
+      } else {
+        // Requested by an earlier call which responded without it.
+        it->second.waiter = batch;
+        batch->keys.push_back(key);
+      }
+    }
+  }
+
+  // The tensors that are already produced are delivered synchronously to
+  // "batch" while it is collecting.
+  for (size_t i : to_recv) {
+    const string key = parsed[i].FullKey().ToString();
+    Ref();
+    RecvLocalAsync(parsed[i],
+                   [this, key](const Status& s, const Rendezvous::Args& send_args,
+                               const Rendezvous::Args& recv_args,
+                               const Tensor& val, bool is_dead) {
+                     BatchedRecvDone(key, s, send_args, val, is_dead);
+                     Unref();
+                   });
+  }
+
+  {
+    mutex_lock l(batch_mu_);
+    batch->collecting = false;
+    if (batch->ready.empty() && batch->status.ok() && !batch->keys.empty()) {
+      // Wait for the first tensor to be produced.
+      return;
+    }
+    DetachBatchLocked(batch.get());
+  }
+  batch->done(batch->status, batch->ready);
+}
+
+void BaseRemoteRendezvous::BatchedRecvDone(const string& key, const Status& s,
+                                           const Rendezvous::Args& send_args,
+                                           const Tensor& val, bool is_dead) {
+  std::shared_ptr<BatchRecv> batch;
+  {
+    mutex_lock l(batch_mu_);
+    auto it = batched_values_.find(key);
+    if (it == batched_values_.end()) return;
+    BatchedValue& value = it->second;
+    RendezvousMgrInterface::BatchedTensor tensor;
+    tensor.key = key;
+    tensor.send_args = send_args;
+    tensor.val = val;
+    tensor.is_dead = is_dead;
+    if (value.waiter == nullptr) {
+      value.ready = true;
+      value.status = s;
+      value.tensor = std::move(tensor);
+      return;
+    }
+    batch = std::move(value.waiter);
+    batched_values_.erase(it);
+    batch->status.Update(s);
+    batch->ready.push_back(std::move(tensor));
+    if (batch->collecting) return;
+    DetachBatchLocked(batch.get());
+  }
+  batch->done(batch->status, batch->ready);
+}
+
+void BaseRemoteRendezvous::DetachBatchLocked(BatchRecv* batch) {
+  for (const string& key : batch->keys) {
+    auto it = batched_values_.find(key);
+    if (it != batched_values_.end() && it->second.waiter.get() == batch) {
+      it->second.waiter.reset();
+    }
+  }
+}
+
 void BaseRemoteRendezvous::StartAbort(const Status& s) {
   CHECK(!s.ok());
   local_->StartAbort(s);
@@ -372,6 +477,18 @@ void BaseRemoteRendezvous::StartAbort(const Status& s) {
       active_.clear();
     }
   }
+  {
+    // Drops the tensors parked for RecvLocalBatchAsync calls that will not
+    // come. The pending entries are completed by the aborted local recvs.
+    mutex_lock l(batch_mu_);
+    for (auto it = batched_values_.begin(); it != batched_values_.end();) {
+      if (it->second.ready) {
+        it = batched_values_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
 }
 
 void BaseRemoteRendezvous::RegisterCall(BaseRecvTensorCall* call) {
@@ -16,8 +16,11 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_BASE_RENDEZVOUS_MGR_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_BASE_RENDEZVOUS_MGR_H_
 
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "tensorflow/core/distributed_runtime/rendezvous_mgr_interface.h"
 #include "tensorflow/core/distributed_runtime/worker_env.h"
@@ -82,6 +85,14 @@ class BaseRendezvousMgr : public RendezvousMgrInterface {
   Status RecvLocal(int64 step_id, const Rendezvous::ParsedKey& parsed,
                    Tensor* val, bool* is_dead) override;
 
+  // Finds the local rendezvous instance for the "step_id" and receives a
+  // batch of tensors. See RendezvousMgrInterface::RecvLocalBatchAsync.
+  //
+  // This method is used by the rpc handler of RecvTensors.
+  void RecvLocalBatchAsync(int64 step_id,
+                           const std::vector<Rendezvous::ParsedKey>& parsed,
+                           BatchDoneCallback done) override;
+
   // Removes rendezvous for "step_id".
   //
   // TODO(zhifengc): Have a background thread in worker that
@@ -149,6 +160,15 @@ class BaseRemoteRendezvous : public RemoteRendezvous {
   // REQUIRES: "parsed" is one that will be Saved into the local rendezvous.
   void RecvLocalAsync(const ParsedKey& parsed, DoneCallback done);
 
+  // Batched version of RecvLocalAsync. Runs "done" as soon as at least one of
+  // the tensors for "parsed" is available or an error is detected, with all
+  // the tensors available at that time. The other tensors are buffered when
+  // they are produced, until a later call requests them again or the
+  // rendezvous is aborted.
+  void RecvLocalBatchAsync(
+      const std::vector<ParsedKey>& parsed,
+      const RendezvousMgrInterface::BatchDoneCallback& done);
+
  protected:
   virtual void RecvFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
                                    const Rendezvous::Args& args,
@@ -195,6 +215,33 @@ class BaseRemoteRendezvous : public RemoteRendezvous {
   // Active outstanding RecvTensor calls.
   gtl::FlatSet<BaseRecvTensorCall*> active_ GUARDED_BY(mu_);
 
+  // State of a RecvLocalBatchAsync call.
+  struct BatchRecv {
+    RendezvousMgrInterface::BatchDoneCallback done;
+    // Keys of the tensors the call is waiting for.
+    std::vector<string> keys;
+    // Tensors available for the call, and the first error if any.
+    std::vector<RendezvousMgrInterface::BatchedTensor> ready;
+    Status status;
+    // True while the call is registering its keys: the tensors available
+    // during that time are all returned together.
+    bool collecting = true;
+  };
+
+  // A tensor requested by a RecvLocalBatchAsync call and not returned yet.
+  struct BatchedValue {
+    // The call waiting for the tensor, if any.
+    std::shared_ptr<BatchRecv> waiter;
+    // True if the tensor was produced while no call was waiting for it.
+    bool ready = false;
+    Status status;
+    RendezvousMgrInterface::BatchedTensor tensor;
+  };
+
+  mutex batch_mu_;
+  std::unordered_map<string, BatchedValue> batched_values_
+      GUARDED_BY(batch_mu_);
+
   bool is_initialized_locked() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
     return session_ != nullptr;
   }
@@ -216,6 +263,14 @@ class BaseRemoteRendezvous : public RemoteRendezvous {
   // Must be called only if fully initialized.
   void RecvLocalAsyncInternal(const ParsedKey& parsed, DoneCallback done);
 
+  // Callback of the local recv of a tensor requested by RecvLocalBatchAsync.
+  void BatchedRecvDone(const string& key, const Status& s,
+                       const Rendezvous::Args& send_args, const Tensor& val,
+                       bool is_dead);
+
+  // Stops delivering tensors to "batch" once it has responded.
+  void DetachBatchLocked(BatchRecv* batch) EXCLUSIVE_LOCKS_REQUIRED(batch_mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(BaseRemoteRendezvous);
 };
 
@@ -180,7 +180,8 @@ class DeviceResDistTest : public ::testing::Test {
     wc_.AddWorker(worker_name, fw);
   }
 
-  void DefineCollectiveParams(int num_workers, int num_devices) {
+  void DefineCollectiveParams(int num_workers, int num_devices,
+                              const TensorShape& shape = TensorShape({64})) {
     const int kGroupKey = 5;
     const int kInstanceKey = 3;
     for (int wi = 0; wi < num_workers; ++wi) {
@@ -196,7 +197,7 @@ class DeviceResDistTest : public ::testing::Test {
         cp.instance.instance_key = kInstanceKey;
         cp.instance.type = REDUCTION_COLLECTIVE;
         cp.instance.data_type = DT_FLOAT;
-        cp.instance.shape = TensorShape({64});
+        cp.instance.shape = shape;
         cp.instance.impl_details.subdiv_offsets.push_back(0);
       }
     }
@@ -273,6 +274,8 @@ class DeviceResDistTest : public ::testing::Test {
             EXPECT_EQ(cp_[0].instance.task_names[i],
                       cp_[idx].instance.task_names[i]);
           }
+          EXPECT_EQ(cp_[0].instance.impl_details.reduction_algorithm,
+                    cp_[idx].instance.impl_details.reduction_algorithm);
         }
       }
     }
@@ -308,6 +311,8 @@ TEST_F(DeviceResDistTest, Workers2Devices2) {
   DefineCollectiveParams(num_workers, num_devices);
   IssueRequests(num_workers, num_devices);
   ValidateCollectiveParams(num_workers, num_devices);
+  EXPECT_EQ(cp_[0].instance.impl_details.reduction_algorithm,
+            RECURSIVE_HALVING_REDUCTION);
 }
 
 TEST_F(DeviceResDistTest, Workers4Devices3) {
@@ -319,5 +324,37 @@ TEST_F(DeviceResDistTest, Workers4Devices3) {
   ValidateCollectiveParams(num_workers, num_devices);
 }
 
+// 4MB tensors: large enough to be bandwidth bound.
+TEST_F(DeviceResDistTest, Workers4Devices3LargeTensor) {
+  const int num_workers = 4;
+  const int num_devices = 3;
+  DefineWorkers(num_workers, num_devices, "CPU");
+  DefineCollectiveParams(num_workers, num_devices, TensorShape({1 << 20}));
+  IssueRequests(num_workers, num_devices);
+  ValidateCollectiveParams(num_workers, num_devices);
+  EXPECT_EQ(cp_[0].instance.impl_details.reduction_algorithm,
+            HIERARCHICAL_REDUCTION);
+}
+
+TEST_F(DeviceResDistTest, Workers4Devices1LargeTensor) {
+  const int num_workers = 4;
+  const int num_devices = 1;
+  DefineWorkers(num_workers, num_devices, "CPU");
+  DefineCollectiveParams(num_workers, num_devices, TensorShape({1 << 20}));
+  IssueRequests(num_workers, num_devices);
+  ValidateCollectiveParams(num_workers, num_devices);
+  EXPECT_EQ(cp_[0].instance.impl_details.reduction_algorithm, RING_REDUCTION);
+}
+
+TEST_F(DeviceResDistTest, Workers2Devices1SmallTensor) {
+  const int num_workers = 2;
+  const int num_devices = 1;
+  DefineWorkers(num_workers, num_devices, "CPU");
+  DefineCollectiveParams(num_workers, num_devices);
+  IssueRequests(num_workers, num_devices);
+  ValidateCollectiveParams(num_workers, num_devices);
+  EXPECT_EQ(cp_[0].instance.impl_details.reduction_algorithm, RING_REDUCTION);
+}
+
 }  // namespace
 }  // namespace tensorflow
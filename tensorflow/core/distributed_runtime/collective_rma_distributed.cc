@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/distributed_runtime/cancellable_call.h"
+#include "tensorflow/core/distributed_runtime/tensor_compression.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/platform/protobuf_internal.h"
 #include "tensorflow/core/protobuf/transport_options.pb.h"
@@ -37,6 +38,7 @@ class RecvBufCall : public CancellableCall {
               const AllocatorAttributes& to_alloc_attr, Tensor* to_tensor,
               const DeviceLocality& client_locality,
               const DeviceLocality& server_locality,
+              RPCOptions::TensorCompression compression,
               CancellationManager* cancel_mgr, WorkerCacheInterface* wc)
       : CancellableCall(cancel_mgr, peer_task, wc) {
     req_.set_step_id(step_id);
@@ -47,6 +49,7 @@ class RecvBufCall : public CancellableCall {
     req_.set_buf_ptr(reinterpret_cast<int64>(DMAHelper::base(to_tensor)));
     req_.set_src_device(peer_device);
     req_.set_dst_device(to_device->name());
+    req_.set_compression(compression);
   }
 
   ~RecvBufCall() override {}
@@ -59,6 +62,19 @@ class RecvBufCall : public CancellableCall {
   RecvBufResponse resp_;
 };
 
+// Copies the content of a RecvBufResponse, encoded with "compression", into
+// the host tensor "*to_tensor".
+Status CopyRecvBufContent(RPCOptions::TensorCompression compression,
+                          const RecvBufRespExtra& extra, Tensor* to_tensor) {
+  if (compression != RPCOptions::NO_COMPRESSION) {
+    return UncompressTensorContent(compression, extra.tensor_content(),
+                                   to_tensor);
+  }
+  memcpy(DMAHelper::base(to_tensor), extra.tensor_content().data(),
+         extra.tensor_content().size());
+  return Status::OK();
+}
+
 }  // namespace
 
 void CollectiveRemoteAccessDistributed::RecvFromPeer(
@@ -90,8 +106,11 @@ void CollectiveRemoteAccessDistributed::RecvFromPeer(
       // them into the destination tensor here.
       RecvBufRespExtra extra;
       state->call->resp_.transport_options().UnpackTo(&extra);
+      const RPCOptions::TensorCompression compression =
+          state->call->resp_.compression();
       int64 num_bytes = extra.tensor_content().size();
-      if (num_bytes != to_tensor->TotalBytes()) {
+      if (compression == RPCOptions::NO_COMPRESSION &&
+          num_bytes != to_tensor->TotalBytes()) {
         done(errors::Internal("RecvBufResponse returned ", num_bytes,
                               " bytes where to_tensor expected ",
                               to_tensor->TotalBytes()));
@@ -113,8 +132,13 @@ void CollectiveRemoteAccessDistributed::RecvFromPeer(
         cpu_attr.set_gpu_compatible(true);
         Tensor* cpu_tensor = new Tensor(cpu_dev->GetAllocator(cpu_attr),
                                         to_tensor->dtype(), to_tensor->shape());
-        memcpy(DMAHelper::base(cpu_tensor), extra.tensor_content().data(),
-               num_bytes);
+        status = CopyRecvBufContent(compression, extra, cpu_tensor);
+        if (!status.ok()) {
+          delete cpu_tensor;
+          done(status);
+          delete state;
+          return;
+        }
         // Then copy it to the GPU.
         CopyTensor::ViaDMA("",  // edge name (non-existent)
                            nullptr /*send_dev_ctx*/, to_device_ctx, cpu_dev,
@@ -130,8 +154,12 @@ void CollectiveRemoteAccessDistributed::RecvFromPeer(
         return;
       } else {
         // CPU device
-        memcpy(DMAHelper::base(to_tensor), extra.tensor_content().data(),
-               num_bytes);
+        Status status = CopyRecvBufContent(compression, extra, to_tensor);
+        if (!status.ok()) {
+          done(status);
+          delete state;
+          return;
+        }
       }
     }
     if (!s.ok() && errors::IsFailedPrecondition(s)) {
@@ -154,6 +182,8 @@ void CollectiveRemoteAccessDistributed::RecvFromPeer(
       state->call.reset(new RecvBufCall(
           step_id_, peer_device, peer_task, key, to_device, to_device_ctx,
           to_alloc_attr, to_tensor, client_locality, state->server_locality,
+          compress_tensors_ ? RPCOptions::SHUFFLE_SNAPPY
+                            : RPCOptions::NO_COMPRESSION,
           &cancel_mgr_, worker_cache_));
       state->call->Start(recv_buf_callback);
     }
@@ -21,14 +21,20 @@ namespace tensorflow {
 class WorkerCacheInterface;
 
 // Extend CollectiveRemoteAccessLocal with access to remote peers.
+//
+// If "compress_tensors" is true, the float buffers received from remote
+// peers are requested with the lossless SHUFFLE_SNAPPY compression, see
+// RPCOptions.compress_collective_tensors.
 class CollectiveRemoteAccessDistributed : public CollectiveRemoteAccessLocal {
  public:
   CollectiveRemoteAccessDistributed(const DeviceMgr* dev_mgr,
                                     DeviceResolverInterface* dev_resolver,
                                     WorkerCacheInterface* worker_cache,
-                                    int64 step_id)
+                                    int64 step_id,
+                                    bool compress_tensors = false)
       : CollectiveRemoteAccessLocal(dev_mgr, dev_resolver, step_id),
-        worker_cache_(worker_cache) {}
+        worker_cache_(worker_cache),
+        compress_tensors_(compress_tensors) {}
 
   ~CollectiveRemoteAccessDistributed() override {}
 
@@ -43,6 +49,7 @@ class CollectiveRemoteAccessDistributed : public CollectiveRemoteAccessLocal {
 
  protected:
   WorkerCacheInterface* worker_cache_;  // Not owned
+  const bool compress_tensors_;
   CancellationManager cancel_mgr_;
 };
 
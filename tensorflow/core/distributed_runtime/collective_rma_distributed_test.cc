@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/distributed_runtime/device_resolver_distributed.h"
+#include "tensorflow/core/distributed_runtime/tensor_compression.h"
 #include "tensorflow/core/distributed_runtime/test_utils.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/lib/core/notification.h"
@@ -70,6 +71,11 @@ class FakeWorker : public TestWorkerInterface {
   // worker is supposed to have.
   BufRendezvous* buf_rendezvous() { return &buf_rendezvous_; }
 
+  // Compression used for the content of the last RecvBuf response.
+  RPCOptions::TensorCompression last_compression() const {
+    return last_compression_;
+  }
+
   void GetStatusAsync(const GetStatusRequest* request,
                       GetStatusResponse* response,
                       StatusCallback done) override {
@@ -103,10 +109,17 @@ class FakeWorker : public TestWorkerInterface {
             // Since this is not really RDMA into pre-allocated memory send the
             // bytes in the response.
             RecvBufRespExtra extra;
-            int64 num_bytes = h->prod_value->TotalBytes();
-            extra.set_tensor_content(string(
-                reinterpret_cast<const char*>(DMAHelper::base(h->prod_value)),
-                num_bytes));
+            if (ShouldCompressTensor(request->compression(), *h->prod_value) &&
+                CompressTensorContent(request->compression(), *h->prod_value,
+                                      extra.mutable_tensor_content())) {
+              response->set_compression(request->compression());
+            } else {
+              int64 num_bytes = h->prod_value->TotalBytes();
+              extra.set_tensor_content(string(
+                  reinterpret_cast<const char*>(DMAHelper::base(h->prod_value)),
+                  num_bytes));
+            }
+            last_compression_ = response->compression();
             response->mutable_transport_options()->PackFrom(extra);
           }
           done(s);
@@ -119,6 +132,8 @@ class FakeWorker : public TestWorkerInterface {
   DeviceMgr* device_mgr_;
   DeviceResolverDistributed* device_resolver_;
   BufRendezvous buf_rendezvous_;
+  RPCOptions::TensorCompression last_compression_ =
+      RPCOptions::NO_COMPRESSION;
 };
 
 class FakeCache : public TestWorkerCache {
@@ -328,6 +343,58 @@ TEST_F(CollRMADistTest, ConsFirstOK) {
   ValidateResultTensor();
 }
 
+TEST_F(CollRMADistTest, ProdFirstCompressedOK) {
+  rma_.reset(new CollectiveRemoteAccessDistributed(
+      device_mgrs_[0], dev_resolvers_["/job:worker/replica:0/task:0"], &wc_,
+      kStepId, true /*compress_tensors*/));
+  // Large enough to be compressed.
+  const int kNumElts = 4096;
+  expected_value_ = Tensor(DT_FLOAT, {kNumElts});
+  to_tensor_ = Tensor(DT_FLOAT, {kNumElts});
+  for (int i = 0; i < kNumElts; ++i) {
+    expected_value_.flat<float>()(i) = i % 16;
+    to_tensor_.flat<float>()(i) = -1;
+  }
+  Notification consumer_note;
+  Notification producer_note;
+  Status consumer_status;
+  Status producer_status;
+  FakeWorker* wi = workers_[1];
+  const string kBufKey = "fake_buf_key";
+  wi->buf_rendezvous()->ProvideBuf(
+      kBufKey, nullptr /*device*/, nullptr /*dev_ctx*/, &expected_value_,
+      AllocatorAttributes(),
+      [this, &producer_note, &producer_status](const Status& s) {
+        producer_status.Update(s);
+        producer_note.Notify();
+      });
+  Device* dst_device = nullptr;
+  string dev_name = "CPU:0";
+  TF_EXPECT_OK(device_mgrs_[0]->LookupDevice(dev_name, &dst_device));
+  DeviceContext* to_device_ctx = nullptr;
+  rma_->RecvFromPeer(
+      "/job:worker/replica:0/task:1/device:" + dev_name,  // peer_dev
+      "/job:worker/replica:0/task:1",                     // peer_task
+      false,                                              // peer_is_local
+      kBufKey, dst_device, to_device_ctx, alloc_attr_, &to_tensor_,
+      device_locality_,
+      [this, &consumer_status, &consumer_note](const Status& s) {
+        consumer_status = s;
+        consumer_note.Notify();
+      });
+  consumer_note.WaitForNotification();
+  TF_EXPECT_OK(consumer_status);
+  producer_note.WaitForNotification();
+  TF_EXPECT_OK(producer_status);
+  // The buffer is sent uncompressed by binaries built without snappy.
+  string compressed;
+  if (CompressTensorContent(RPCOptions::SHUFFLE_SNAPPY, expected_value_,
+                            &compressed)) {
+    EXPECT_EQ(RPCOptions::SHUFFLE_SNAPPY, wi->last_compression());
+  }
+  ValidateResultTensor();
+}
+
 TEST_F(CollRMADistTest, ConsFirstAbort) {
   Notification consumer_note;
   Status consumer_status;
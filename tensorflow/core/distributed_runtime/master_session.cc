@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/stats_publisher_interface.h"
 #include "tensorflow/core/debug/debug_graph_utils.h"
 #include "tensorflow/core/distributed_runtime/scheduler.h"
+#include "tensorflow/core/distributed_runtime/variable_placement.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/distributed_runtime/worker_interface.h"
 #include "tensorflow/core/framework/allocation_description.pb.h"
@@ -56,6 +57,8 @@ limitations under the License.
 
 namespace tensorflow {
 
+class RunManyGraphs;
+
 // MasterSession wraps ClientGraph in a reference counted object.
 // This way, MasterSession can clear up the cache mapping Run requests to
 // compiled graphs while the compiled graph is still being used.
@@ -100,6 +103,16 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
 
   const ClientGraph* client_graph() { return client_graph_.get(); }
 
+  // Returns a recommendation to move the variables of the client graph
+  // between the tasks of 'devices', see VariablePlacementAdvice().  Returns
+  // an empty string if partitioning, which modifies the client graph, has
+  // already started.
+  string VariablePlacementAdvice(const DeviceSet& devices) {
+    mutex_lock l(mu_);
+    if (init_started_) return "";
+    return tensorflow::VariablePlacementAdvice(client_graph_->graph, devices);
+  }
+
   const CallableOptions& callable_options() { return callable_opts_; }
 
   const BuildGraphOptions& build_graph_options() { return bg_opts_; }
@@ -200,6 +213,14 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
                        CallOptions* call_opts, const RunCallableRequest& req,
                        RunCallableResponse* resp, CancellationManager* cm);
 
+  // Issues one step of all partitions of a graph that fetches no tensors,
+  // without waiting for it.  Calls `done` when all partitions have finished,
+  // unless an error is returned.
+  Status RunPartitionsAsync(const MasterEnv* env, int64 step_id,
+                            int64 execution_count, PerStepState* pss,
+                            const RunStepRequestWrapper& req,
+                            CancellationManager* cm, StatusCallback done);
+
   // Calls workers to cleanup states for the step "step_id".  Calls
   // `done` when all cleanup RPCs have completed.
   void CleanupPartitionsAsync(int64 step_id, StatusCallback done);
@@ -294,6 +315,14 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
 
   // Prepares a number of calls to workers. One call per partition.
   // This is a generic method that handles Run, PartialRun, and RunCallable.
+  template <class FetchListType, class ClientRequestType>
+  Status PrepareRunGraphCalls(
+      const std::unordered_map<StringPiece, size_t, StringPieceHasher>& feeds,
+      const FetchListType& fetches, int64 step_id, PerStepState* pss,
+      const ClientRequestType& req, bool is_last_partial_run,
+      RunManyGraphs* calls);
+
+  // Runs the calls prepared by PrepareRunGraphCalls and waits for them.
   template <class FetchListType, class ClientRequestType,
             class ClientResponseType>
   Status RunPartitionsHelper(
@@ -560,14 +589,12 @@ struct RunCallableResponseWrapper {
 };
 }  // namespace
 
-template <class FetchListType, class ClientRequestType,
-          class ClientResponseType>
-Status MasterSession::ReffedClientGraph::RunPartitionsHelper(
+template <class FetchListType, class ClientRequestType>
+Status MasterSession::ReffedClientGraph::PrepareRunGraphCalls(
     const std::unordered_map<StringPiece, size_t, StringPieceHasher>& feeds,
-    const FetchListType& fetches, const MasterEnv* env, int64 step_id,
-    int64 execution_count, PerStepState* pss, CallOptions* call_opts,
-    const ClientRequestType& req, ClientResponseType* resp,
-    CancellationManager* cm, bool is_last_partial_run) {
+    const FetchListType& fetches, int64 step_id, PerStepState* pss,
+    const ClientRequestType& req, bool is_last_partial_run,
+    RunManyGraphs* calls) {
   // Collect execution cost stats on a smoothly decreasing frequency.
   ExecutorOpts exec_opts;
   if (pss->report_tensor_allocations_upon_oom) {
@@ -590,11 +617,9 @@ Status MasterSession::ReffedClientGraph::RunPartitionsHelper(
   }
 
   const int num = partitions_.size();
-  RunManyGraphs calls(num);
-
   for (int i = 0; i < num; ++i) {
     const Part& part = partitions_[i];
-    RunManyGraphs::Call* c = calls.get(i);
+    RunManyGraphs::Call* c = calls->get(i);
     c->req.reset(part.worker->CreateRunGraphRequest());
     c->resp.reset(part.worker->CreateRunGraphResponse());
     if (is_partial_) {
@@ -652,6 +677,21 @@ Status MasterSession::ReffedClientGraph::RunPartitionsHelper(
       }
     }
   }
+  return Status::OK();
+}
+
+template <class FetchListType, class ClientRequestType,
+          class ClientResponseType>
+Status MasterSession::ReffedClientGraph::RunPartitionsHelper(
+    const std::unordered_map<StringPiece, size_t, StringPieceHasher>& feeds,
+    const FetchListType& fetches, const MasterEnv* env, int64 step_id,
+    int64 execution_count, PerStepState* pss, CallOptions* call_opts,
+    const ClientRequestType& req, ClientResponseType* resp,
+    CancellationManager* cm, bool is_last_partial_run) {
+  const int num = partitions_.size();
+  RunManyGraphs calls(num);
+  TF_RETURN_IF_ERROR(PrepareRunGraphCalls(feeds, fetches, step_id, pss, req,
+                                          is_last_partial_run, &calls));
 
   // Issues RunGraph calls.
   for (int i = 0; i < num; ++i) {
@@ -721,6 +761,20 @@ Status MasterSession::ReffedClientGraph::RunPartitionsHelper(
   return status;
 }
 
+namespace {
+// Maps the names of fed tensors to their index in `req`.
+Status GetFeedIndices(
+    const RunStepRequestWrapper& req,
+    std::unordered_map<StringPiece, size_t, StringPieceHasher>* feeds) {
+  for (size_t i = 0; i < req.num_feeds(); ++i) {
+    if (!feeds->insert({req.feed_name(i), i}).second) {
+      return errors::InvalidArgument("Duplicated feeds: ", req.feed_name(i));
+    }
+  }
+  return Status::OK();
+}
+}  // namespace
+
 Status MasterSession::ReffedClientGraph::RunPartitions(
     const MasterEnv* env, int64 step_id, int64 execution_count,
     PerStepState* pss, CallOptions* call_opts, const RunStepRequestWrapper& req,
@@ -728,13 +782,8 @@ Status MasterSession::ReffedClientGraph::RunPartitions(
     const bool is_last_partial_run) {
   VLOG(2) << "RunPartitions step_id " << step_id << " execution_count "
           << execution_count;
-  // Maps the names of fed tensors to their index in `req`.
   std::unordered_map<StringPiece, size_t, StringPieceHasher> feeds(3);
-  for (size_t i = 0; i < req.num_feeds(); ++i) {
-    if (!feeds.insert({req.feed_name(i), i}).second) {
-      return errors::InvalidArgument("Duplicated feeds: ", req.feed_name(i));
-    }
-  }
+  TF_RETURN_IF_ERROR(GetFeedIndices(req, &feeds));
 
   std::vector<string> fetches;
   fetches.reserve(req.num_fetches());
@@ -787,6 +836,63 @@ Status MasterSession::ReffedClientGraph::RunPartitions(
   return Status::OK();
 }
 
+Status MasterSession::ReffedClientGraph::RunPartitionsAsync(
+    const MasterEnv* env, int64 step_id, int64 execution_count,
+    PerStepState* pss, const RunStepRequestWrapper& req,
+    CancellationManager* cm, StatusCallback done) {
+  VLOG(2) << "RunPartitionsAsync step_id " << step_id << " execution_count "
+          << execution_count;
+  CHECK_EQ(req.num_fetches(), 0);
+  std::unordered_map<StringPiece, size_t, StringPieceHasher> feeds(3);
+  TF_RETURN_IF_ERROR(GetFeedIndices(req, &feeds));
+
+  // The calls outlive this method, and are deleted by the last one to
+  // finish.
+  struct AsyncCalls {
+    explicit AsyncCalls(int num) : calls(num), num_pending(num) {}
+    RunManyGraphs calls;
+    std::atomic<int> num_pending;
+  };
+  const int num = partitions_.size();
+  AsyncCalls* async_calls = new AsyncCalls(num);
+  Status s = PrepareRunGraphCalls(feeds, std::vector<string>(), step_id, pss,
+                                  req, false, &async_calls->calls);
+  auto token = cm->get_cancellation_token();
+  if (s.ok() && !cm->RegisterCallback(token, [async_calls]() {
+        async_calls->calls.StartCancel();
+      })) {
+    s = errors::Cancelled("Step was cancelled");
+  }
+  if (!s.ok()) {
+    delete async_calls;
+    return s;
+  }
+  if (num == 0) {
+    cm->DeregisterCallback(token);
+    delete async_calls;
+    done(Status::OK());
+    return Status::OK();
+  }
+
+  // Issues RunGraph calls.
+  for (int i = 0; i < num; ++i) {
+    const Part& part = partitions_[i];
+    RunManyGraphs::Call* call = async_calls->calls.get(i);
+    TRACEPRINTF("Partition %d %s", i, part.name.c_str());
+    part.worker->RunGraphAsync(
+        &call->opts, call->req.get(), call->resp.get(),
+        [async_calls, i, cm, token, done](const Status& s) {
+          async_calls->calls.WhenDone(i, s);
+          if (--async_calls->num_pending > 0) return;
+          cm->DeregisterCallback(token);
+          const Status status = async_calls->calls.status();
+          delete async_calls;
+          done(status);
+        });
+  }
+  return Status::OK();
+}
+
 namespace {
 
 class CleanupBroadcastHelper {
@@ -1259,11 +1365,16 @@ Status MasterSession::CreateWorkerSessions(
       // is in use.
       workers[i].request.set_isolate_session_state(true);
     } else {
-      // NOTE(mrry): Do not set any component of the ServerDef,
+      // NOTE(mrry): Do not set the cluster of the ServerDef,
       // because the worker will use its local configuration.
       workers[i].request.set_isolate_session_state(
           session_opts_.config.isolate_session_state());
     }
+    // The workers apply the RPC options of the session, e.g. to batch the
+    // RecvTensor requests of its steps.
+    ServerDef* server_def = workers[i].request.mutable_server_def();
+    *server_def->mutable_default_session_config()->mutable_rpc_options() =
+        session_opts_.config.rpc_options();
   }
 
   for (size_t i = 0; i < worker_names.size(); ++i) {
@@ -1402,6 +1513,7 @@ WorkerCacheInterface* MasterSession::get_worker_cache() const {
 Status MasterSession::StartStep(const BuildGraphOptions& opts, bool is_partial,
                                 ReffedClientGraph** out_rcg, int64* out_count) {
   const uint64 hash = HashBuildGraphOptions(opts);
+  bool advise_variable_placement = false;
   {
     mutex_lock l(mu_);
     // TODO(suharshs): We cache partial run graphs and run graphs separately
@@ -1417,6 +1529,10 @@ Status MasterSession::StartStep(const BuildGraphOptions& opts, bool is_partial,
               << "\n";
       std::unique_ptr<ClientGraph> client_graph;
       TF_RETURN_IF_ERROR(execution_state_->BuildGraph(opts, &client_graph));
+      // The placement of the variables is only evaluated for the first
+      // graph of the session, outside of the session lock.
+      advise_variable_placement = !variable_placement_advised_;
+      variable_placement_advised_ = true;
       WorkerCacheInterface* worker_cache = get_worker_cache();
       auto entry = new ReffedClientGraph(
           handle_, opts, std::move(client_graph), session_opts_,
@@ -1429,6 +1545,10 @@ Status MasterSession::StartStep(const BuildGraphOptions& opts, bool is_partial,
     (*out_rcg)->Ref();
     *out_count = (*out_rcg)->get_and_increment_execution_count();
   }
+  if (advise_variable_placement) {
+    const string advice = (*out_rcg)->VariablePlacementAdvice(*devices_);
+    if (!advice.empty()) LOG(INFO) << advice;
+  }
   return Status::OK();
 }
 
@@ -1523,6 +1643,7 @@ Status MasterSession::Run(CallOptions* opts, const RunStepRequestWrapper& req,
     if (closed_) {
       return errors::FailedPrecondition("Session is closed.");
     }
+    TF_RETURN_IF_ERROR(TakePipelinedStatus());
     ++num_running_;
     // Note: all code paths must eventually call MarkRunCompletion()
     // in order to appropriate decrement the num_running_ counter.
@@ -1856,6 +1977,19 @@ Status MasterSession::DoRunWithLocalExecution(
   std::unique_ptr<ProfileHandler> ph;
   FillPerStepState(rcg, req.options(), step_id, count, &pss, &ph);
 
+  // Steps that return nothing but errors can be pipelined, unless they
+  // collect anything for the client.
+  const int32 max_pipelined_steps =
+      req.options().experimental().max_pipelined_steps();
+  if (max_pipelined_steps > 0 && req.num_fetches() == 0 && !debugger_state &&
+      !ph && !pss.collect_timeline && !pss.collect_costs &&
+      !pss.collect_partition_graphs) {
+    cleanup.release();  // MarkRunCompletion called in PostRunCleanup().
+    return DoRunPipelined(rcg, step_id, count, max_pipelined_steps, req, pss);
+  }
+  // Other steps observe the effects of the pipelined steps before them.
+  TF_RETURN_IF_ERROR(WaitForPipelinedSteps());
+
   Status s = rcg->RunPartitions(env_, step_id, count, &pss, opts, req, resp,
                                 &cancellation_manager_, false);
   cleanup.release();  // MarkRunCompletion called in PostRunCleanup().
@@ -1863,6 +1997,84 @@ Status MasterSession::DoRunWithLocalExecution(
                         resp->mutable_metadata());
 }
 
+Status MasterSession::DoRunPipelined(ReffedClientGraph* rcg, uint64 step_id,
+                                     int64 count, int32 max_pipelined_steps,
+                                     const RunStepRequestWrapper& req,
+                                     const PerStepState& pss) {
+  {
+    mutex_lock l(mu_);
+    while (num_pipelined_steps_ >= max_pipelined_steps) {
+      num_pipelined_steps_changed_.wait(l);
+    }
+    ++num_pipelined_steps_;
+  }
+
+  // The step outlives this call, so it keeps its own copy of the options and
+  // of the per-step state.
+  struct PipelinedStep {
+    RunOptions run_options;
+    PerStepState pss;
+    RunMetadata run_metadata;
+  };
+  PipelinedStep* step = new PipelinedStep;
+  step->run_options = req.options();
+  step->pss = pss;
+  Ref();
+  rcg->Ref();
+  auto finish_step = [this, rcg, step_id,
+                      step](const Status& run_status) -> Status {
+    Status s = PostRunCleanup(rcg, step_id, step->run_options, &step->pss,
+                              std::unique_ptr<ProfileHandler>(), run_status,
+                              &step->run_metadata);
+    delete step;
+    rcg->Unref();
+    {
+      mutex_lock l(mu_);
+      --num_pipelined_steps_;
+      num_pipelined_steps_changed_.notify_all();
+    }
+    return s;
+  };
+
+  Status s = rcg->RunPartitionsAsync(
+      env_, step_id, count, &step->pss, req, &cancellation_manager_,
+      [this, finish_step](const Status& run_status) {
+        Status s = finish_step(run_status);
+        if (!s.ok()) {
+          LOG(ERROR) << "Pipelined step failed: " << s;
+          mutex_lock l(mu_);
+          if (pipelined_status_.ok()) {
+            pipelined_status_ = s;
+          }
+        }
+        Unref();
+      });
+  if (!s.ok()) {
+    // The step could not be issued, so the error is returned right away.
+    s = finish_step(s);
+    Unref();
+  }
+  return s;
+}
+
+Status MasterSession::WaitForPipelinedSteps() {
+  mutex_lock l(mu_);
+  while (num_pipelined_steps_ != 0) {
+    num_pipelined_steps_changed_.wait(l);
+  }
+  return TakePipelinedStatus();
+}
+
+// Returns the error of a pipelined step that has not been reported yet, if
+// any.
+Status MasterSession::TakePipelinedStatus() {
+  if (pipelined_status_.ok()) return Status::OK();
+  const Status s = pipelined_status_;
+  pipelined_status_ = Status::OK();
+  return Status(s.code(),
+                strings::StrCat("A pipelined step failed: ", s.error_message()));
+}
+
 Status MasterSession::MakeCallable(const MakeCallableRequest& req,
                                    MakeCallableResponse* resp) {
   UpdateLastAccessTime();
@@ -1983,6 +2195,8 @@ Status MasterSession::Close() {
     mutex_lock l(mu_);
     closed_ = true;  // All subsequent calls to Run() or Extend() will fail.
   }
+  // Cancels the running steps, including the pipelined steps whose Run()
+  // calls have already returned, so that a blocked step cannot hang Close().
   cancellation_manager_.StartCancel();
   std::vector<ReffedClientGraph*> to_unref;
   {
@@ -1990,6 +2204,9 @@ Status MasterSession::Close() {
     while (num_running_ != 0) {
       num_running_is_zero_.wait(l);
     }
+    while (num_pipelined_steps_ != 0) {
+      num_pipelined_steps_changed_.wait(l);
+    }
     ClearRunsTable(&to_unref, &run_graphs_);
     ClearRunsTable(&to_unref, &partial_run_graphs_);
     ClearRunsTable(&to_unref, &callables_);
@@ -159,6 +159,10 @@ class MasterSession : public core::RefCounted {
   int64 next_callable_handle_ GUARDED_BY(mu_) = 0;
   RCGMap callables_ GUARDED_BY(mu_);
 
+  // Whether the placement of the variables across tasks has been evaluated,
+  // which is done once per session, for its first graph.
+  bool variable_placement_advised_ GUARDED_BY(mu_) = false;
+
   struct PerStepState {
     bool collect_costs = false;
     bool collect_timeline = false;
@@ -198,6 +202,13 @@ class MasterSession : public core::RefCounted {
   condition_variable num_running_is_zero_;
   int32 num_running_ GUARDED_BY(mu_) = 0;
 
+  // Pipelined steps whose Run() call has returned but which are still
+  // running, and the first error one of them returned, which has not been
+  // reported by Run() yet.
+  condition_variable num_pipelined_steps_changed_;
+  int32 num_pipelined_steps_ GUARDED_BY(mu_) = 0;
+  Status pipelined_status_ GUARDED_BY(mu_);
+
   bool closed_ GUARDED_BY(mu_) = false;
   bool garbage_collected_ GUARDED_BY(mu_) = false;
 
@@ -236,6 +247,12 @@ class MasterSession : public core::RefCounted {
                                  MutableRunStepResponseWrapper* resp);
   Status DoPartialRun(CallOptions* opts, const RunStepRequestWrapper& req,
                       MutableRunStepResponseWrapper* resp);
+  Status DoRunPipelined(ReffedClientGraph* rcg, uint64 step_id, int64 count,
+                        int32 max_pipelined_steps,
+                        const RunStepRequestWrapper& req,
+                        const PerStepState& pss);
+  Status WaitForPipelinedSteps();
+  Status TakePipelinedStatus() EXCLUSIVE_LOCKS_REQUIRED(mu_);
   Status DoRunCallable(CallOptions* opts, ReffedClientGraph* rcg,
                        const RunCallableRequest& req,
                        RunCallableResponse* resp);
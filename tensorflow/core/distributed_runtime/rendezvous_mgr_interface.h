@@ -17,9 +17,11 @@ limitations under the License.
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RENDEZVOUS_MGR_INTERFACE_H_
 
 #include <string>
+#include <vector>
 
 #include "tensorflow/core/distributed_runtime/worker_env.h"
 #include "tensorflow/core/framework/rendezvous.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/types.h"
 
@@ -85,6 +87,29 @@ class RendezvousMgrInterface {
   virtual Status RecvLocal(int64 step_id, const Rendezvous::ParsedKey& parsed,
                            Tensor* val, bool* is_dead) = 0;
 
+  // A tensor returned by RecvLocalBatchAsync.
+  struct BatchedTensor {
+    string key;
+    Rendezvous::Args send_args;
+    Tensor val;
+    bool is_dead = false;
+  };
+  typedef std::function<void(const Status&, const std::vector<BatchedTensor>&)>
+      BatchDoneCallback;
+
+  // Finds the local rendezvous instance for the "step_id" and receives the
+  // tensors for all the keys in "parsed". Runs "done" as soon as at least one
+  // of the tensors is produced or an error occurs, with all the tensors
+  // produced at that time. The tensors that are not returned are buffered
+  // when they are produced, and returned by a later call for the same keys.
+  //
+  // This method is used by the rpc handler of RecvTensors.
+  virtual void RecvLocalBatchAsync(
+      int64 step_id, const std::vector<Rendezvous::ParsedKey>& parsed,
+      BatchDoneCallback done) {
+    done(errors::Unimplemented("RecvLocalBatchAsync"), {});
+  }
+
   // Removes rendezvous for "step_id".
   //
   // TODO(zhifengc): Have a background thread in worker that
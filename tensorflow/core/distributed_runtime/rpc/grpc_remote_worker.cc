@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_remote_worker.h"
 
+#include <array>
+#include <atomic>
+#include <memory>
 #include <utility>
 
 #include "grpcpp/generic/generic_stub.h"
@@ -30,6 +33,9 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/worker_interface.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/tracing.h"
@@ -37,6 +43,159 @@ limitations under the License.
 
 namespace tensorflow {
 
+namespace {
+
+// Metrics of the tensors received with RecvTensor and RecvTensors RPCs,
+// labeled by the devices of the edge they were sent on.
+auto* recv_tensor_bytes = monitoring::Counter<2>::New(
+    "/tensorflow/core/rpc/recv_tensor_bytes",
+    "The number of bytes of the encoded tensors received with RecvTensor "
+    "RPCs.",
+    "src_device", "dst_device");
+auto* recv_tensor_queue_usecs = monitoring::Sampler<2>::New(
+    {"/tensorflow/core/rpc/recv_tensor_queue_usecs",
+     "The time between the issue of a RecvTensor RPC and the start of its "
+     "response by the remote worker, mostly spent waiting for the tensor to "
+     "be produced.",
+     "src_device", "dst_device"},
+    // Power of 2 with bucket count 24 (> 8 seconds)
+    monitoring::Buckets::Exponential(1, 2, 24));
+auto* recv_tensor_wire_usecs = monitoring::Sampler<2>::New(
+    {"/tensorflow/core/rpc/recv_tensor_wire_usecs",
+     "The time between the start of a RecvTensor response by the remote "
+     "worker and its receipt, excluding decoding.",
+     "src_device", "dst_device"},
+    monitoring::Buckets::Exponential(1, 2, 24));
+auto* recv_tensor_parse_usecs = monitoring::Sampler<2>::New(
+    {"/tensorflow/core/rpc/recv_tensor_parse_usecs",
+     "The time spent decoding the tensor of a RecvTensor response. Not "
+     "recorded for RecvTensors responses, which are decoded by gRPC.",
+     "src_device", "dst_device"},
+    monitoring::Buckets::Exponential(1, 2, 24));
+
+// The cells of the metrics above for one edge.
+struct RecvTensorMetricCells {
+  monitoring::CounterCell* bytes;
+  monitoring::SamplerCell* queue_usecs;
+  monitoring::SamplerCell* wire_usecs;
+  monitoring::SamplerCell* parse_usecs;
+};
+
+RecvTensorMetricCells GetRecvTensorMetricCells(const string& src_device,
+                                               const string& dst_device) {
+  RecvTensorMetricCells cells;
+  cells.bytes = recv_tensor_bytes->GetCell(src_device, dst_device);
+  cells.queue_usecs = recv_tensor_queue_usecs->GetCell(src_device, dst_device);
+  cells.wire_usecs = recv_tensor_wire_usecs->GetCell(src_device, dst_device);
+  cells.parse_usecs = recv_tensor_parse_usecs->GetCell(src_device, dst_device);
+  return cells;
+}
+
+// Sets "*src_device" and "*dst_device" to the devices of the edge of the
+// rendezvous key "key".  Returns false if "key" is malformed.
+bool ParseRecvTensorEdge(StringPiece key, StringPiece* src_device,
+                         StringPiece* dst_device) {
+  const size_t src_end = key.find(';');
+  if (src_end == StringPiece::npos) return false;
+  const size_t incarnation_end = key.find(';', src_end + 1);
+  if (incarnation_end == StringPiece::npos) return false;
+  const size_t dst_end = key.find(';', incarnation_end + 1);
+  if (dst_end == StringPiece::npos) return false;
+  *src_device = StringPiece(key.data(), src_end);
+  *dst_device = StringPiece(key.data() + incarnation_end + 1,
+                            dst_end - incarnation_end - 1);
+  return true;
+}
+
+// The metric cells of the edges that tensors are received on, in an
+// insert-only hash table that is read without taking any lock.  The table
+// only grows with the number of pairs of devices.  The cells of the edges
+// that don't fit in it are looked up in the metrics on every recv.
+class RecvTensorMetricCellsCache {
+ public:
+  RecvTensorMetricCellsCache() {
+    for (auto& slot : slots_) slot.store(nullptr, std::memory_order_relaxed);
+  }
+
+  ~RecvTensorMetricCellsCache() {
+    for (auto& slot : slots_) delete slot.load(std::memory_order_relaxed);
+  }
+
+  // Sets "*cells" to the cells of the edge of the rendezvous key "key".
+  // Returns false if "key" is malformed.
+  bool Get(StringPiece key, RecvTensorMetricCells* cells) {
+    StringPiece src_device;
+    StringPiece dst_device;
+    if (!ParseRecvTensorEdge(key, &src_device, &dst_device)) return false;
+    const uint64 hash =
+        Hash64Combine(Hash64(src_device.data(), src_device.size()),
+                      Hash64(dst_device.data(), dst_device.size()));
+    std::unique_ptr<Entry> added;
+    for (size_t i = 0; i < kNumSlots; ++i) {
+      std::atomic<Entry*>& slot = slots_[(hash + i) % kNumSlots];
+      Entry* entry = slot.load(std::memory_order_acquire);
+      if (entry == nullptr) {
+        if (added == nullptr) {
+          added.reset(new Entry);
+          added->src_device = std::string(src_device);
+          added->dst_device = std::string(dst_device);
+          added->cells =
+              GetRecvTensorMetricCells(added->src_device, added->dst_device);
+        }
+        // On failure, "entry" is set to the entry added by another thread.
+        if (slot.compare_exchange_strong(entry, added.get(),
+                                         std::memory_order_acq_rel,
+                                         std::memory_order_acquire)) {
+          entry = added.release();
+        }
+      }
+      if (entry->src_device == src_device &&
+          entry->dst_device == dst_device) {
+        *cells = entry->cells;
+        return true;
+      }
+    }
+    *cells = GetRecvTensorMetricCells(std::string(src_device),
+                                      std::string(dst_device));
+    return true;
+  }
+
+ private:
+  struct Entry {
+    string src_device;
+    string dst_device;
+    RecvTensorMetricCells cells;
+  };
+
+  static constexpr size_t kNumSlots = 256;
+  std::array<std::atomic<Entry*>, kNumSlots> slots_;
+};
+
+// Returns the time at which the remote worker started to send a response
+// reported to have been sent at "send_start_micros", for a request issued
+// at "start_usec" and answered at "end_usec".
+int64 ClampSendStart(int64 start_usec, int64 end_usec,
+                     int64 send_start_micros) {
+  // If a send start time was reported by the other side, use
+  // that instead.  Maybe we should mark the display if we're using
+  // our local time instead of the remote start time?
+  if (send_start_micros == 0) return start_usec;
+  // send_start_micros is the timestamp taken when the
+  // remote machine began to send the RecvTensor response.
+  // Due to clock skew between source and dest machines, it
+  // is possible that send_start_micros can be larger than
+  // end_usec or less than start_usec.
+  //
+  // To respect causality, we enforce the invariants that
+  // the RecvTensor response can not have been sent before
+  // the RecvTensor request, and must have been sent before
+  // it was received.
+  int64 send_start_usec = std::max(start_usec, send_start_micros);
+  return std::min(send_start_usec, end_usec - 1);
+}
+
+}  // namespace
+
 class GrpcRemoteWorker : public WorkerInterface {
  public:
   explicit GrpcRemoteWorker(SharedGrpcChannelPtr channel,
@@ -60,6 +219,7 @@ class GrpcRemoteWorker : public WorkerInterface {
         completegroup_(Method(GrpcWorkerMethod::kCompleteGroup)),
         instancesource_(Method(GrpcWorkerMethod::kCompleteInstance)),
         getstepsequence_(Method(GrpcWorkerMethod::kGetStepSequence)),
+        recvtensors_(Method(GrpcWorkerMethod::kRecvTensors)),
         logger_(logger) {}
 
   ~GrpcRemoteWorker() override {}
@@ -149,39 +309,33 @@ class GrpcRemoteWorker : public WorkerInterface {
                        TensorResponse* response, StatusCallback done) override {
     VLOG(1) << "RecvTensorAsync req: " << request->DebugString();
     int64 start_usec = Env::Default()->NowMicros();
-    // Type-specialized logging for this method.
-    bool logging_active = logger_->LoggingActive() || VLOG_IS_ON(2);
-    StatusCallback wrapper_done;
-    const StatusCallback* cb_to_use;
-    if (!logging_active) {
-      cb_to_use = &done;  // No additional work to do, so just use done directly
-    } else {
-      wrapper_done = [this, request, response, done, start_usec](Status s) {
-        if (logger_->LoggingActive()) {
-          int64 end_usec = Env::Default()->NowMicros();
-          int64 step_id = request->step_id();
-          int64 bytes = response->tensor().TotalBytes();
-          int64 send_start_usec = start_usec;
-          // If a send start time was reported by the other side, use
-          // that instead.  Maybe we should mark the display if we're using
-          // our local time instead of the remote start time?
-          if (response->metadata().send_start_micros()) {
-            // send_start_micros is the timestamp taken when the
-            // remote machine began to send the RecvTensor response.
-            // Due to clock skew between source and dest machines, it
-            // is possible that send_start_micros can be larger than
-            // end_usec or less than start_usec.
-            //
-            // To respect causality, we enforce the invariants that
-            // the RecvTensor response can not have been sent before
-            // the RecvTensor request, and must have been sent before
-            // it was received.
-            send_start_usec = std::max(
-                start_usec,
-                static_cast<int64>(response->metadata().send_start_micros()));
-            send_start_usec = std::min(send_start_usec, end_usec - 1);
+    // Type-specialized logging for this method.  The per-edge metrics are
+    // always recorded, the step stats only while logging is active.
+    StatusCallback wrapper_done = [this, request, response, done,
+                                   start_usec](Status s) {
+      const bool logging_active = logger_->LoggingActive();
+      if (s.ok() || logging_active) {
+        int64 end_usec = Env::Default()->NowMicros();
+        int64 step_id = request->step_id();
+        int64 bytes = response->tensor().TotalBytes();
+        int64 send_start_usec =
+            ClampSendStart(start_usec, end_usec,
+                           response->metadata().send_start_micros());
+        const string& key = request->rendezvous_key();
+        if (s.ok()) {
+          RecvTensorMetricCells cells;
+          if (recv_tensor_metric_cells_.Get(key, &cells)) {
+            const int64 parse_usec = response->parse_micros();
+            cells.bytes->IncrementBy(response->tensor_bytes());
+            cells.queue_usecs->Add(send_start_usec - start_usec);
+            cells.wire_usecs->Add(
+                std::max<int64>(end_usec - send_start_usec - parse_usec, 0));
+            cells.parse_usecs->Add(parse_usec);
+          } else {
+            LOG(WARNING) << "Bad key: " << key;
           }
-          const string& key = request->rendezvous_key();
+        }
+        if (logging_active) {
           std::vector<string> key_parts = str_util::Split(key, ';');
           if (key_parts.size() != 5) {
             LOG(WARNING) << "Bad key: " << key;
@@ -193,14 +347,50 @@ class GrpcRemoteWorker : public WorkerInterface {
                                       bytes);
           }
         }
-        VLOG(2) << "done callback, req: " << request->DebugString()
-                << " response " << response->metadata().DebugString();
-        done(s);
-      };
-      cb_to_use = &wrapper_done;
-    }
+      }
+      VLOG(2) << "done callback, req: " << request->DebugString()
+              << " response " << response->metadata().DebugString();
+      done(s);
+    };
 
-    IssueRequest(request, response, recvtensor_, *cb_to_use, call_opts);
+    IssueRequest(request, response, recvtensor_, std::move(wrapper_done),
+                 call_opts);
+  }
+
+  void RecvTensorsAsync(CallOptions* call_opts,
+                        const RecvTensorsRequest* request,
+                        RecvTensorsResponse* response,
+                        StatusCallback done) override {
+    VLOG(1) << "RecvTensorsAsync req: " << request->DebugString();
+    int64 start_usec = Env::Default()->NowMicros();
+    // Records the per-edge metrics of each tensor in the response.  The
+    // tensors are decoded by gRPC along with the response, so the decoding
+    // time is part of the wire time.
+    StatusCallback wrapper_done = [this, response, done,
+                                   start_usec](Status s) {
+      if (s.ok()) {
+        int64 end_usec = Env::Default()->NowMicros();
+        const int num_tensors = std::min(response->rendezvous_key_size(),
+                                         response->tensor_size());
+        for (int i = 0; i < num_tensors; ++i) {
+          RecvTensorMetricCells cells;
+          if (!recv_tensor_metric_cells_.Get(response->rendezvous_key(i),
+                                             &cells)) {
+            LOG(WARNING) << "Bad key: " << response->rendezvous_key(i);
+            continue;
+          }
+          const RecvTensorResponse& tensor = response->tensor(i);
+          int64 send_start_usec = ClampSendStart(start_usec, end_usec,
+                                                 tensor.send_start_micros());
+          cells.bytes->IncrementBy(tensor.tensor().ByteSizeLong());
+          cells.queue_usecs->Add(send_start_usec - start_usec);
+          cells.wire_usecs->Add(end_usec - send_start_usec);
+        }
+      }
+      done(s);
+    };
+    IssueRequest(request, response, recvtensors_, std::move(wrapper_done),
+                 call_opts);
   }
 
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
@@ -251,10 +441,14 @@ class GrpcRemoteWorker : public WorkerInterface {
   const ::grpc::string completegroup_;
   const ::grpc::string instancesource_;
   const ::grpc::string getstepsequence_;
+  const ::grpc::string recvtensors_;
 
   // Support for logging.
   WorkerCacheLogger* logger_;
 
+  // The metric cells of the edges that tensors were received on.
+  RecvTensorMetricCellsCache recv_tensor_metric_cells_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(GrpcRemoteWorker);
 };
 
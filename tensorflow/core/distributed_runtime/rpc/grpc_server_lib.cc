@@ -65,11 +65,6 @@ class NoReusePortOption : public ::grpc::ServerBuilderOption {
                          plugins) override {}
 };
 
-// static utility function
-RendezvousMgrInterface* NewRpcRendezvousMgr(const WorkerEnv* env) {
-  return new RpcRendezvousMgr(env);
-}
-
 }  // namespace
 
 GrpcServer::GrpcServer(const ServerDef& server_def, Env* env)
@@ -129,9 +124,10 @@ Status GrpcServer::Init(
                                                &master_env_.local_devices));
   worker_env_.local_devices = master_env_.local_devices;
   worker_env_.device_mgr = new DeviceMgr(worker_env_.local_devices);
-  worker_env_.rendezvous_mgr = rendezvous_mgr_func == nullptr
-                                   ? new RpcRendezvousMgr(&worker_env_)
-                                   : rendezvous_mgr_func(&worker_env_);
+  worker_env_.rendezvous_mgr =
+      rendezvous_mgr_func == nullptr
+          ? new RpcRendezvousMgr(&worker_env_, config.rpc_options())
+          : rendezvous_mgr_func(&worker_env_);
   string unused;
   string default_worker_name;
   if (!DeviceNameUtils::SplitDeviceName(master_env_.local_devices[0]->name(),
@@ -438,7 +434,9 @@ Status GrpcServer::Create(const ServerDef& server_def, Env* env,
   std::unique_ptr<GrpcServer> ret(
       new GrpcServer(server_def, env == nullptr ? Env::Default() : env));
   ServiceInitFunction service_func = nullptr;
-  TF_RETURN_IF_ERROR(ret->Init(service_func, NewRpcRendezvousMgr, nullptr));
+  // A null RendezvousMgrCreationFunction selects the RpcRendezvousMgr,
+  // configured with the RPC options of the server.
+  TF_RETURN_IF_ERROR(ret->Init(service_func, nullptr, nullptr));
   *out_server = std::move(ret);
   return Status::OK();
 }
@@ -24,11 +24,14 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/testlib.h"
 #include "tensorflow/core/lib/core/error_codes.pb.h"
+#include "tensorflow/core/lib/monitoring/collected_metrics.h"
+#include "tensorflow/core/lib/monitoring/collection_registry.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/rewriter_config.pb.h"
 #include "tensorflow/core/public/session.h"
 #include "tensorflow/core/util/port.h"
 
@@ -558,6 +561,77 @@ TEST(GrpcSessionTest, SendRecv_Node_Naming) {
   TF_CHECK_OK(session->Close());
 }
 
+// Returns the number of bytes received by "dst_device" from "src_device"
+// with RecvTensor and RecvTensors RPCs, as exported by the monitoring
+// metrics.
+static int64 RecvTensorBytes(const string& src_device,
+                             const string& dst_device) {
+  std::unique_ptr<monitoring::CollectedMetrics> metrics =
+      monitoring::CollectionRegistry::Default()->CollectMetrics({});
+  auto it =
+      metrics->point_set_map.find("/tensorflow/core/rpc/recv_tensor_bytes");
+  if (it == metrics->point_set_map.end()) return 0;
+  for (const auto& point : it->second->points) {
+    string src;
+    string dst;
+    for (const auto& label : point->labels) {
+      if (label.name == "src_device") src = label.value;
+      if (label.name == "dst_device") dst = label.value;
+    }
+    if (src == src_device && dst == dst_device) return point->int64_value;
+  }
+  return 0;
+}
+
+// Receives a tensor from task 1 on task 0 a few times, with the given
+// batching window, and checks that the bytes are recorded for the edge.
+static void TestRecvTensorMetrics(int64 batching_window_micros) {
+  std::unique_ptr<test::TestCluster> cluster;
+  TF_CHECK_OK(test::TestCluster::MakeTestCluster(Devices(1, 0), 2, &cluster));
+  SessionOptions options = Options(cluster->targets()[0], 1);
+  options.config.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->set_constant_folding(RewriterConfig::OFF);
+  options.config.mutable_rpc_options()->set_recv_tensor_batching_window_micros(
+      batching_window_micros);
+  std::unique_ptr<Session> session(NewRemote(options));
+  ASSERT_TRUE(session != nullptr);
+
+  const DeviceAttributes& dst = cluster->devices()[0];
+  const DeviceAttributes& src = cluster->devices()[1];
+
+  Graph graph(OpRegistry::Global());
+  Tensor a_tensor(DT_FLOAT, TensorShape({1, 1}));
+  a_tensor.flat<float>()(0) = 100;
+  Node* a = test::graph::Constant(&graph, a_tensor);
+  Node* b = test::graph::Identity(&graph, a);
+
+  GraphDef def;
+  test::graph::ToGraphDef(&graph, &def);
+  SetDevice(&def, a->name(), src.name());
+  SetDevice(&def, b->name(), dst.name());
+  TF_CHECK_OK(session->Create(def));
+
+  const int64 bytes_before = RecvTensorBytes(src.name(), dst.name());
+  const int kNumSteps = 3;
+  for (int i = 0; i < kNumSteps; ++i) {
+    std::vector<Tensor> outputs;
+    TF_CHECK_OK(session->Run({}, {b->name()}, {}, &outputs));
+    ASSERT_EQ(1, outputs.size());
+    IsSingleFloatValue(outputs[0], 100);
+  }
+  EXPECT_GE(RecvTensorBytes(src.name(), dst.name()) - bytes_before,
+            static_cast<int64>(kNumSteps * a_tensor.TotalBytes()));
+
+  TF_CHECK_OK(session->Close());
+}
+
+TEST(GrpcSessionTest, RecvTensorMetrics) { TestRecvTensorMetrics(0); }
+
+TEST(GrpcSessionTest, RecvTensorMetricsBatched) {
+  TestRecvTensorMetrics(1000);
+}
+
 TEST(GrpcSessionTest, Error) {
   std::unique_ptr<test::TestCluster> cluster;
   TF_CHECK_OK(test::TestCluster::MakeTestCluster(Devices(1, 0), 2, &cluster));
@@ -735,6 +809,128 @@ TEST(SessionTest, SharedVar) {
   }
 }
 
+TEST(SessionTest, PipelinedSteps) {
+  std::unique_ptr<test::TestCluster> cluster;
+  TF_CHECK_OK(test::TestCluster::MakeTestCluster(Devices(1, 0), 2, &cluster));
+  const string master = cluster->targets()[0];
+  const string& dev_a = cluster->devices()[0].name();
+  const string& dev_b = cluster->devices()[1].name();
+
+  // var += one, with var and one on different workers.
+  GraphDef gdef;
+  string init_name;
+  string inc_name;
+  string get_name;
+  {
+    Graph g(OpRegistry::Global());
+    Tensor one(DT_FLOAT, TensorShape({}));
+    one.scalar<float>()() = 1.0;
+    Node* var = test::graph::Var(&g, DT_FLOAT, one.shape());
+    var->set_assigned_device_name(dev_a);
+    Node* one_a = test::graph::Constant(&g, one);
+    one_a->set_assigned_device_name(dev_a);
+    Node* init = test::graph::Assign(&g, var, one_a);
+    init->set_assigned_device_name(dev_a);
+    init_name = init->name();
+    Node* one_b = test::graph::Constant(&g, one);
+    one_b->set_assigned_device_name(dev_b);
+    Node* add = test::graph::Add(&g, var, one_b);
+    add->set_assigned_device_name(dev_a);
+    Node* update = test::graph::Assign(&g, var, add);
+    update->set_assigned_device_name(dev_a);
+    inc_name = update->name();
+    get_name = var->name();
+    test::graph::ToGraphDef(&g, &gdef);
+  }
+
+  std::unique_ptr<Session> session(NewRemote(Options(master, 1)));
+  ASSERT_TRUE(session != nullptr);
+  TF_CHECK_OK(session->Create(gdef));
+  TF_CHECK_OK(session->Run({}, {}, {init_name}, nullptr));
+
+  // One step in flight at a time, so that the updates do not race.
+  RunOptions run_options;
+  run_options.mutable_experimental()->set_max_pipelined_steps(1);
+  for (int rep = 0; rep < 10; ++rep) {
+    TF_CHECK_OK(
+        session->Run(run_options, {}, {}, {inc_name}, nullptr, nullptr));
+  }
+
+  // A step with fetches waits for the pipelined steps.
+  std::vector<Tensor> ret;
+  TF_CHECK_OK(session->Run({}, {get_name}, {}, &ret));
+  ASSERT_EQ(ret.size(), 1);
+  EXPECT_EQ(ret[0].scalar<float>()(), 11.0);
+  TF_CHECK_OK(session->Close());
+}
+
+TEST(SessionTest, PipelinedStepError) {
+  std::unique_ptr<test::TestCluster> cluster;
+  TF_CHECK_OK(test::TestCluster::MakeTestCluster(Devices(1, 0), 1, &cluster));
+  const string master = cluster->targets()[0];
+
+  GraphDef gdef;
+  string a_name;
+  string a_err_name;
+  {
+    Graph g(OpRegistry::Global());
+    Node* a = test::graph::Constant(&g, Tensor());
+    a_name = a->name();
+    Node* a_err = test::graph::Error(&g, a, "fantasia!");
+    a_err_name = a_err->name();
+    test::graph::ToGraphDef(&g, &gdef);
+  }
+
+  std::unique_ptr<Session> session(NewRemote(Options(master, 1)));
+  ASSERT_TRUE(session != nullptr);
+  TF_CHECK_OK(session->Create(gdef));
+
+  // The error of the pipelined step is returned by the next step.
+  RunOptions run_options;
+  run_options.mutable_experimental()->set_max_pipelined_steps(2);
+  TF_CHECK_OK(
+      session->Run(run_options, {}, {}, {a_err_name}, nullptr, nullptr));
+  std::vector<Tensor> ret;
+  Status status = session->Run({}, {a_name}, {}, &ret);
+  EXPECT_FALSE(status.ok());
+  EXPECT_NE(status.ToString().find("fantasia!"), string::npos);
+
+  // It is only returned once.
+  TF_CHECK_OK(session->Run({}, {a_name}, {}, &ret));
+  TF_CHECK_OK(session->Close());
+}
+
+TEST(SessionTest, CloseCancelsPipelinedStep) {
+  std::unique_ptr<test::TestCluster> cluster;
+  TF_CHECK_OK(test::TestCluster::MakeTestCluster(Devices(1, 0), 1, &cluster));
+  const string master = cluster->targets()[0];
+  const string& dev_a = cluster->devices()[0].name();
+
+  // A recv whose tensor is never sent blocks until the step is cancelled.
+  GraphDef gdef;
+  string recv_name;
+  {
+    Graph g(OpRegistry::Global());
+    Node* recv = test::graph::Recv(&g, "never_sent", "float", dev_a, 1, dev_a);
+    recv->set_assigned_device_name(dev_a);
+    recv_name = recv->name();
+    test::graph::ToGraphDef(&g, &gdef);
+  }
+
+  std::unique_ptr<Session> session(NewRemote(Options(master, 1)));
+  ASSERT_TRUE(session != nullptr);
+  TF_CHECK_OK(session->Create(gdef));
+
+  // The step is still blocked on the workers when Run() returns.
+  RunOptions run_options;
+  run_options.mutable_experimental()->set_max_pipelined_steps(1);
+  TF_CHECK_OK(
+      session->Run(run_options, {}, {}, {recv_name}, nullptr, nullptr));
+
+  // Close() cancels the blocked step instead of waiting for it forever.
+  TF_CHECK_OK(session->Close());
+}
+
 void CreateInvalidGraph(const string& graph_def_ascii,
                         const string& error_substring) {
   GraphDef graph;
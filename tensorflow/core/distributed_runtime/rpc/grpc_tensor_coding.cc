@@ -17,6 +17,7 @@ limitations under the License.
 #include "grpcpp/support/byte_buffer.h"
 #include "grpcpp/support/slice.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/distributed_runtime/tensor_compression.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_reference.h"
@@ -135,13 +136,30 @@ static void EncodeSkeleton(const Tensor& val, io::ProtoEncodeHelper* e) {
 
 void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val,
                               ::grpc::ByteBuffer* result) {
+  EncodeTensorToByteBuffer(is_dead, val, RPCOptions::NO_COMPRESSION, result);
+}
+
+void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val,
+                              RPCOptions::TensorCompression compression,
+                              ::grpc::ByteBuffer* result) {
   const int kLargeTensorBytes = 1024;
   RecvTensorResponse response;
   if (is_dead) {
     response.set_is_dead(is_dead);
   }
   response.set_send_start_micros(Env::Default()->NowMicros());
-  if (!DataTypeCanUseMemcpy(val.dtype())) {
+  string compressed;
+  if (!is_dead && ShouldCompressTensor(compression, val) &&
+      CompressTensorContent(compression, val, &compressed)) {
+    // The compressed content is a new buffer, so there is no tensor backing
+    // store to share: encode the full protocol buffer.
+    TensorProto* tensor = response.mutable_tensor();
+    tensor->set_dtype(val.dtype());
+    val.shape().AsProto(tensor->mutable_tensor_shape());
+    tensor->mutable_tensor_content()->swap(compressed);
+    response.set_compression(compression);
+    EncodeRecvTensorResponseToByteBuffer(response, result);
+  } else if (!DataTypeCanUseMemcpy(val.dtype())) {
     // Straightforward but slow path for complicated kinds of tensor data
     // TODO(jeff,sanjay): If this becomes an issue, we could
     // go directly from val -> ByteBuffer, with some effort.
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_TENSOR_CODING_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_TENSOR_CODING_H_
 
+#include "tensorflow/core/protobuf/config.pb.h"
+
 namespace grpc {
 class ByteBuffer;
 }  // namespace grpc
@@ -51,6 +53,13 @@ void EncodeRecvTensorResponseToByteBuffer(const RecvTensorResponse& proto,
 void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val,
                               ::grpc::ByteBuffer* result);
 
+// Same as above, but if ShouldCompressTensor(compression, val) the content
+// of "val" is encoded with "compression", and "RecvTensorResponse::compression"
+// is set accordingly.
+void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val,
+                              RPCOptions::TensorCompression compression,
+                              ::grpc::ByteBuffer* result);
+
 }  // namespace grpc
 }  // namespace tensorflow
 
@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service_impl.h"
+#include "tensorflow/core/distributed_runtime/tensor_compression.h"
 #include "tensorflow/core/distributed_runtime/worker.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/distributed_runtime/worker_session.h"
@@ -165,6 +166,9 @@ class GrpcWorkerService : public AsyncServiceInterface {
       for (int i = 0; i < 500; ++i) {
         ENQUEUE_REQUEST(RecvBuf, true);
       }
+      for (int i = 0; i < 100; ++i) {
+        ENQUEUE_REQUEST(RecvTensors, true);
+      }
       for (int i = 0; i < 100; ++i) {
         ENQUEUE_REQUEST(RunGraph, true);
       }
@@ -303,6 +307,21 @@ class GrpcWorkerService : public AsyncServiceInterface {
       EnqueueRecvTensorRequestRaw();
     }
 
+    void RecvTensorsHandler(
+        WorkerCall<RecvTensorsRequest, RecvTensorsResponse>* call) {
+      Schedule([this, call]() {
+        CallOptions* call_opts = new CallOptions;
+        call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
+        worker_->RecvTensorsAsync(call_opts, &call->request, &call->response,
+                                  [call, call_opts](const Status& s) {
+                                    call->ClearCancelCallback();
+                                    delete call_opts;
+                                    call->SendResponse(ToGrpcStatus(s));
+                                  });
+      });
+      ENQUEUE_REQUEST(RecvTensors, true);
+    }
+
     void CleanupGraphHandler(
         WorkerCall<CleanupGraphRequest, CleanupGraphResponse>* call) {
       Schedule([this, call]() {
@@ -483,10 +502,12 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
                   << " gpu_info: " << src_dev->tensorflow_gpu_device_info();
               // "val" is on an accelerator device. Uses the device_context to
               // fill the copy on host.
-              StatusCallback copy_ready = [response, done, copy,
+              StatusCallback copy_ready = [request, response, done, copy,
                                            is_dead](const Status& s) {
                 // The value is now ready to be returned on the wire.
-                grpc::EncodeTensorToByteBuffer(is_dead, *copy, response);
+                grpc::EncodeTensorToByteBuffer(is_dead, *copy,
+                                               request->compression(),
+                                               response);
                 done(s);
                 delete copy;
               };
@@ -494,7 +515,8 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
               send_dev_context->CopyDeviceTensorToCPU(
                   &val, request->rendezvous_key(), src_dev, copy, copy_ready);
             } else {
-              grpc::EncodeTensorToByteBuffer(is_dead, val, response);
+              grpc::EncodeTensorToByteBuffer(is_dead, val,
+                                             request->compression(), response);
               done(Status::OK());
             }
           }
@@ -505,6 +527,82 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
       });
 }
 
+void GrpcWorker::RecvTensorsAsync(CallOptions* opts,
+                                  const RecvTensorsRequest* request,
+                                  RecvTensorsResponse* response,
+                                  StatusCallback done) {
+  Status s = recv_tensor_recent_request_ids_.TrackUnique(
+      request->request_id(), "RecvTensors (GrpcWorker)", *request);
+  if (!s.ok()) {
+    done(s);
+    return;
+  }
+
+  const int64 step_id = request->step_id();
+  TRACEPRINTF("RecvTensors: %lld %d", step_id, request->rendezvous_key_size());
+  std::vector<Rendezvous::ParsedKey> parsed(request->rendezvous_key_size());
+  for (int i = 0; i < request->rendezvous_key_size() && s.ok(); ++i) {
+    s = Rendezvous::ParseKey(request->rendezvous_key(i), &parsed[i]);
+    Device* src_dev = nullptr;
+    if (s.ok()) {
+      s = PrepareRecvTensor(parsed[i], &src_dev);
+    }
+    if (s.ok() && src_dev->tensorflow_gpu_device_info()) {
+      s = errors::InvalidArgument("RecvTensors only supports tensors produced ",
+                                  "on CPU, got ", request->rendezvous_key(i));
+    }
+  }
+  if (!s.ok()) {
+    done(s);
+    return;
+  }
+
+  // As in GrpcRecvTensorAsync, an RPC cancellation while waiting for the
+  // tensors aborts the rendezvous.
+  opts->SetCancelCallback([this, step_id]() { AbortStep(step_id); });
+  env_->rendezvous_mgr->RecvLocalBatchAsync(
+      step_id, parsed,
+      [this, opts, response, done](
+          const Status& status,
+          const std::vector<RendezvousMgrInterface::BatchedTensor>& tensors) {
+        opts->ClearCancelCallback();
+        if (status.ok()) {
+          const int64 send_start_micros = env_->env->NowMicros();
+          for (const auto& tensor : tensors) {
+            response->add_rendezvous_key(tensor.key);
+            RecvTensorResponse* tensor_response = response->add_tensor();
+            tensor_response->set_is_dead(tensor.is_dead);
+            tensor_response->set_send_start_micros(send_start_micros);
+            if (!tensor.is_dead) {
+              tensor.val.AsProtoTensorContent(
+                  tensor_response->mutable_tensor());
+            }
+          }
+        }
+        done(status);
+      });
+}
+
+namespace {
+// Returns the content of "val" in "response", compressed if requested. Only
+// the lossless SHUFFLE_SNAPPY is honored, so that all the members of a
+// collective keep computing the same values.
+void SetRecvBufResponseContent(const RecvBufRequest& request,
+                               const Tensor& val, RecvBufResponse* response) {
+  RecvBufRespExtra extra;
+  if (request.compression() == RPCOptions::SHUFFLE_SNAPPY &&
+      ShouldCompressTensor(request.compression(), val) &&
+      CompressTensorContent(request.compression(), val,
+                            extra.mutable_tensor_content())) {
+    response->set_compression(request.compression());
+  } else {
+    extra.set_tensor_content(
+        reinterpret_cast<const char*>(DMAHelper::base(&val)), val.TotalBytes());
+  }
+  response->mutable_transport_options()->PackFrom(extra);
+}
+}  // namespace
+
 void GrpcWorker::RecvBufAsync(CallOptions* opts, const RecvBufRequest* request,
                               RecvBufResponse* response, StatusCallback done) {
   // This is a generic, low performance implementation appropriate for grpc.
@@ -542,14 +640,11 @@ void GrpcWorker::RecvBufAsync(CallOptions* opts, const RecvBufRequest* request,
                                               hook->prod_value->shape());
               hook->prod_ctx->CopyDeviceTensorToCPU(
                   hook->prod_value, "empty_name", hook->prod_dev, cpu_tensor,
-                  [this, num_bytes, response, done, hook,
+                  [this, request, response, done, hook,
                    cpu_tensor](const Status& s) {
                     if (s.ok()) {
-                      RecvBufRespExtra extra;
-                      extra.set_tensor_content(reinterpret_cast<const char*>(
-                                                   DMAHelper::base(cpu_tensor)),
-                                               num_bytes);
-                      response->mutable_transport_options()->PackFrom(extra);
+                      SetRecvBufResponseContent(*request, *cpu_tensor,
+                                                response);
                     }
                     response->set_send_start_micros(env_->env->NowMicros());
                     done(s);
@@ -560,11 +655,7 @@ void GrpcWorker::RecvBufAsync(CallOptions* opts, const RecvBufRequest* request,
             }
           } else {
             // Tensor is on CPU.
-            RecvBufRespExtra extra;
-            extra.set_tensor_content(reinterpret_cast<const char*>(
-                                         DMAHelper::base(hook->prod_value)),
-                                     num_bytes);
-            response->mutable_transport_options()->PackFrom(extra);
+            SetRecvBufResponseContent(*request, *hook->prod_value, response);
           }
         }
         response->set_send_start_micros(env_->env->NowMicros());
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <algorithm>
+#include <unordered_map>
 #include <unordered_set>
 
 #include "tensorflow/core/common_runtime/device.h"
@@ -27,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/worker_interface.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/logging.h"
@@ -37,10 +40,25 @@ namespace tensorflow {
 
 namespace {
 
+auto* recv_tensors_rpcs = monitoring::Counter<0>::New(
+    "/tensorflow/core/rpc/recv_tensors_rpcs",
+    "The number of RecvTensors RPCs issued to receive batched tensors.");
+auto* recv_tensors_batched_tensors = monitoring::Counter<0>::New(
+    "/tensorflow/core/rpc/recv_tensors_batched_tensors",
+    "The number of tensors received with RecvTensors RPCs. The number of "
+    "RecvTensor RPCs saved by batching is the difference with "
+    "/tensorflow/core/rpc/recv_tensors_rpcs.");
+
+class RecvTensorBatcher;
+
 class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  public:
-  RpcRemoteRendezvous(const WorkerEnv* env, int64 step_id)
-      : BaseRemoteRendezvous(env, step_id) {}
+  RpcRemoteRendezvous(const WorkerEnv* env, int64 step_id,
+                      const RPCOptions& rpc_options)
+      : BaseRemoteRendezvous(env, step_id),
+        server_batching_window_micros_(
+            rpc_options.recv_tensor_batching_window_micros()),
+        server_tensor_compression_(rpc_options.tensor_compression()) {}
 
  protected:
   void RecvFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
@@ -48,7 +66,36 @@ class RpcRemoteRendezvous : public BaseRemoteRendezvous {
                            DoneCallback done) override;
 
  private:
-  ~RpcRemoteRendezvous() override {}
+  friend class RecvTensorBatcher;
+
+  ~RpcRemoteRendezvous() override;
+
+  // Returns the RPCOptions.recv_tensor_batching_window_micros of the session,
+  // or else of the server.
+  int64 batching_window_micros();
+
+  // Returns the compression to request for a recv with "recv_args": the
+  // RPCOptions.tensor_compression of the session, or else of the server, if
+  // the recv allows it.
+  RPCOptions::TensorCompression tensor_compression(
+      const Rendezvous::Args& recv_args);
+
+  // Returns true if the recv of "parsed" can be coalesced with other recvs
+  // from the same worker.
+  bool CanBatch(const Rendezvous::ParsedKey& parsed,
+                const Rendezvous::Args& recv_args);
+
+  void RecvBatchedFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
+                                  const Rendezvous::Args& args,
+                                  DoneCallback done);
+
+  const int64 server_batching_window_micros_;
+  const RPCOptions::TensorCompression server_tensor_compression_;
+
+  mutex batchers_mu_;
+  // Maps a remote worker name to the batcher of the recvs from that worker.
+  std::unordered_map<string, RecvTensorBatcher*> batchers_
+      GUARDED_BY(batchers_mu_);
 
   TF_DISALLOW_COPY_AND_ASSIGN(RpcRemoteRendezvous);
 };
@@ -60,7 +107,9 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
 
   void Init(WorkerInterface* wi, int64 step_id, StringPiece key,
             AllocatorAttributes alloc_attrs, Device* dst_device,
-            const Rendezvous::Args& recv_args, Rendezvous::DoneCallback done) {
+            const Rendezvous::Args& recv_args,
+            RPCOptions::TensorCompression compression,
+            Rendezvous::DoneCallback done) {
     wi_ = wi;
     alloc_attrs_ = alloc_attrs;
     dst_device_ = dst_device;
@@ -69,6 +118,7 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     req_.set_step_id(step_id);
     req_.set_rendezvous_key(key.data(), key.size());
     req_.set_request_id(GetUniqueRequestId());
+    req_.set_compression(compression);
   }
 
   void Reset(WorkerCacheInterface* wc) {
@@ -204,10 +254,304 @@ static RpcRecvTensorFreeList* get_call_freelist() {
   return call_freelist;
 }
 
+// A RecvTensors RPC, used to retrieve a batch of tensors from a remote
+// process.
+class RpcRecvTensorsCall : public BaseRecvTensorCall {
+ public:
+  RpcRecvTensorsCall(WorkerInterface* wi, int64 step_id,
+                     const std::vector<string>& keys)
+      : wi_(wi) {
+    req_.set_step_id(step_id);
+    for (const string& key : keys) {
+      req_.add_rendezvous_key(key);
+    }
+    req_.set_request_id(GetUniqueRequestId());
+  }
+
+  void Start(std::function<void()> recv_done) override {
+    wi_->RecvTensorsAsync(&opts_, &req_, &resp_,
+                          [this, recv_done](const Status& s) {
+                            if (!s.ok()) {
+                              mutex_lock l(mu_);
+                              status_.Update(s);
+                            }
+                            recv_done();
+                          });
+  }
+
+  void StartAbort(const Status& s) override {
+    {
+      mutex_lock l(mu_);
+      status_.Update(s);
+    }
+    opts_.StartCancel();
+  }
+
+  Status status() const override {
+    mutex_lock l(mu_);
+    return status_;
+  }
+
+  WorkerInterface* wi() const { return wi_; }
+  const RecvTensorsResponse& response() const { return resp_; }
+
+ private:
+  WorkerInterface* wi_;  // Not owned.
+  CallOptions opts_;
+  RecvTensorsRequest req_;
+  RecvTensorsResponse resp_;
+
+  mutable mutex mu_;
+  Status status_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RpcRecvTensorsCall);
+};
+
+// Coalesces the recvs of tensors produced on the CPU of one remote worker
+// into RecvTensors RPCs. The first recv added after a flush opens a batching
+// window, and all the recvs added during the window are requested with a
+// single RPC. Several RPCs can be in flight, each for different keys: a recv
+// is never held back by an RPC that waits for another tensor, whose producer
+// may depend on this recv. The recvs that an RPC did not satisfy, because
+// their tensor was not produced yet, are requested again as soon as the RPC
+// completes.
+class RecvTensorBatcher {
+ public:
+  RecvTensorBatcher(RpcRemoteRendezvous* rendezvous, const string& src_worker)
+      : rendezvous_(rendezvous), src_worker_(src_worker) {}
+
+  void Add(const string& key, Device* dst_device,
+           const Rendezvous::Args& recv_args, Rendezvous::DoneCallback done) {
+    bool schedule_flush = false;
+    Status s;
+    {
+      mutex_lock l(mu_);
+      PendingRecv recv;
+      recv.dst_device = dst_device;
+      recv.recv_args = recv_args;
+      recv.done = done;
+      if (!recvs_.emplace(key, std::move(recv)).second) {
+        s = errors::Internal("Duplicated recv of ", key);
+      } else {
+        unrequested_.push_back(key);
+        if (!flush_scheduled_) {
+          flush_scheduled_ = true;
+          schedule_flush = true;
+        }
+      }
+    }
+    if (!s.ok()) {
+      done(s, Rendezvous::Args(), recv_args, Tensor(), false);
+      return;
+    }
+    if (schedule_flush) {
+      rendezvous_->Ref();
+      rendezvous_->env_->env->SchedClosureAfter(
+          rendezvous_->batching_window_micros(), [this]() {
+            Flush();
+            rendezvous_->Unref();
+          });
+    }
+  }
+
+ private:
+  struct PendingRecv {
+    Device* dst_device;
+    Rendezvous::Args recv_args;
+    Rendezvous::DoneCallback done;
+  };
+
+  // Issues a RecvTensors RPC for the outstanding recvs that are not requested
+  // by an RPC in flight.
+  void Flush() {
+    std::vector<string> keys;
+    {
+      mutex_lock l(mu_);
+      flush_scheduled_ = false;
+      keys.swap(unrequested_);
+    }
+    if (keys.empty()) return;
+
+    WorkerSession* sess = rendezvous_->session();
+    WorkerInterface* wi = sess->worker_cache->CreateWorker(src_worker_);
+    if (wi == nullptr) {
+      RecvDone(errors::Internal("No worker known as ", src_worker_), keys,
+               RecvTensorsResponse());
+      return;
+    }
+    recv_tensors_rpcs->GetCell()->IncrementBy(1);
+    VLOG(2) << "RecvTensors of " << keys.size() << " tensors from "
+            << src_worker_;
+
+    RpcRecvTensorsCall* call =
+        new RpcRecvTensorsCall(wi, rendezvous_->step_id_, keys);
+    // Record "call" in active_ so that it can be aborted cleanly.
+    rendezvous_->RegisterCall(call);
+    rendezvous_->Ref();
+    auto call_done = [this, call, keys]() {
+      // Removes "call" from active_. Prevent StartAbort().
+      rendezvous_->DeregisterCall(call);
+      RecvDone(call->status(), keys, call->response());
+      rendezvous_->session()->worker_cache->ReleaseWorker(src_worker_,
+                                                          call->wi());
+      delete call;
+      rendezvous_->Unref();
+    };
+    if (!call->status().ok()) {
+      // The rendezvous was aborted before the RPC was issued.
+      call_done();
+      return;
+    }
+    call->Start(std::move(call_done));
+  }
+
+  // Completes the recvs of "keys" whose tensor is in "response", or all of
+  // them if "status" is an error, and requests the others again.
+  void RecvDone(const Status& status, const std::vector<string>& keys,
+                const RecvTensorsResponse& response) {
+    std::vector<std::pair<PendingRecv, const RecvTensorResponse*>> received;
+    std::vector<PendingRecv> failed;
+    bool flush = false;
+    {
+      mutex_lock l(mu_);
+      if (!status.ok()) {
+        for (const string& key : keys) {
+          auto it = recvs_.find(key);
+          if (it == recvs_.end()) continue;
+          failed.push_back(std::move(it->second));
+          recvs_.erase(it);
+        }
+      } else {
+        const int num_tensors =
+            std::min(response.rendezvous_key_size(), response.tensor_size());
+        for (int i = 0; i < num_tensors; ++i) {
+          auto it = recvs_.find(response.rendezvous_key(i));
+          if (it == recvs_.end()) continue;
+          received.emplace_back(std::move(it->second), &response.tensor(i));
+          recvs_.erase(it);
+        }
+        // A key belongs to one RPC at a time, so the keys of this RPC that
+        // are still outstanding were not satisfied by it.
+        for (const string& key : keys) {
+          if (recvs_.count(key) > 0) {
+            unrequested_.push_back(key);
+          }
+        }
+        flush = !unrequested_.empty();
+      }
+    }
+
+    for (PendingRecv& recv : failed) {
+      recv.done(status, Rendezvous::Args(), recv.recv_args, Tensor(), false);
+    }
+    recv_tensors_batched_tensors->GetCell()->IncrementBy(received.size());
+    for (auto& recv : received) {
+      const RecvTensorResponse& tensor_response = *recv.second;
+      Tensor val;
+      Status s;
+      if (!tensor_response.is_dead()) {
+        Allocator* allocator =
+            recv.first.dst_device->GetAllocator(recv.first.recv_args.alloc_attrs);
+        if (!val.FromProto(allocator, tensor_response.tensor())) {
+          s = errors::Internal("Invalid tensor in RecvTensors response from ",
+                               src_worker_);
+        }
+      }
+      recv.first.done(s, Rendezvous::Args(), recv.first.recv_args, val,
+                      tensor_response.is_dead());
+    }
+
+    if (flush) Flush();
+  }
+
+  RpcRemoteRendezvous* const rendezvous_;  // Not owned.
+  const string src_worker_;
+
+  mutex mu_;
+  // Outstanding recvs, keyed by rendezvous key.
+  std::unordered_map<string, PendingRecv> recvs_ GUARDED_BY(mu_);
+  // Keys of the outstanding recvs that no RPC in flight requests.
+  std::vector<string> unrequested_ GUARDED_BY(mu_);
+  bool flush_scheduled_ GUARDED_BY(mu_) = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RecvTensorBatcher);
+};
+
+RpcRemoteRendezvous::~RpcRemoteRendezvous() {
+  for (auto& batcher : batchers_) {
+    delete batcher.second;
+  }
+}
+
+int64 RpcRemoteRendezvous::batching_window_micros() {
+  const int64 session_window_micros =
+      session()->rpc_options.recv_tensor_batching_window_micros();
+  return session_window_micros > 0 ? session_window_micros
+                                   : server_batching_window_micros_;
+}
+
+RPCOptions::TensorCompression RpcRemoteRendezvous::tensor_compression(
+    const Rendezvous::Args& recv_args) {
+  if (!recv_args.allow_tensor_compression) {
+    return RPCOptions::NO_COMPRESSION;
+  }
+  const RPCOptions::TensorCompression session_compression =
+      session()->rpc_options.tensor_compression();
+  return session_compression != RPCOptions::NO_COMPRESSION
+             ? session_compression
+             : server_tensor_compression_;
+}
+
+bool RpcRemoteRendezvous::CanBatch(const Rendezvous::ParsedKey& parsed,
+                                   const Rendezvous::Args& recv_args) {
+  // RecvTensors returns tensors as protos, which are decoded in host memory.
+  // It does not compress them, so the compressed recvs are not batched.
+  return parsed.src.type == DEVICE_CPU && parsed.dst.type == DEVICE_CPU &&
+         tensor_compression(recv_args) == RPCOptions::NO_COMPRESSION &&
+         batching_window_micros() > 0;
+}
+
+void RpcRemoteRendezvous::RecvBatchedFromRemoteAsync(
+    const Rendezvous::ParsedKey& parsed, const Rendezvous::Args& recv_args,
+    DoneCallback done) {
+  string src_worker;
+  string src_rel_device;
+  Status s;
+  if (!DeviceNameUtils::SplitDeviceName(parsed.src_device, &src_worker,
+                                        &src_rel_device)) {
+    s = errors::Internal(parsed.src_device,
+                         " is invalid remote source device.");
+  }
+  Device* dst_device;
+  if (s.ok()) {
+    s = session()->device_mgr()->LookupDevice(parsed.dst_device, &dst_device);
+  }
+  if (!s.ok()) {
+    done(s, Args(), recv_args, Tensor{}, false);
+    return;
+  }
+
+  RecvTensorBatcher* batcher;
+  {
+    mutex_lock l(batchers_mu_);
+    RecvTensorBatcher*& entry = batchers_[src_worker];
+    if (entry == nullptr) {
+      entry = new RecvTensorBatcher(this, src_worker);
+    }
+    batcher = entry;
+  }
+  batcher->Add(parsed.FullKey().ToString(), dst_device, recv_args,
+               std::move(done));
+}
+
 void RpcRemoteRendezvous::RecvFromRemoteAsync(
     const Rendezvous::ParsedKey& parsed, const Rendezvous::Args& recv_args,
     DoneCallback done) {
   CHECK(is_initialized());
+  if (CanBatch(parsed, recv_args)) {
+    RecvBatchedFromRemoteAsync(parsed, recv_args, std::move(done));
+    return;
+  }
   Status s;
 
   // Prepare a RecvTensor call that can handle being aborted.
@@ -239,7 +583,7 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
   }
 
   call->Init(rwi, step_id_, parsed.FullKey(), recv_args.alloc_attrs, dst_device,
-             recv_args, std::move(done));
+             recv_args, tensor_compression(recv_args), std::move(done));
 
   // Record "call" in active_ so that it can be aborted cleanly.
   RegisterCall(call);
@@ -265,9 +609,13 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
 RpcRendezvousMgr::RpcRendezvousMgr(const WorkerEnv* env)
     : BaseRendezvousMgr(env) {}
 
+RpcRendezvousMgr::RpcRendezvousMgr(const WorkerEnv* env,
+                                   const RPCOptions& rpc_options)
+    : BaseRendezvousMgr(env), rpc_options_(rpc_options) {}
+
 BaseRemoteRendezvous* RpcRendezvousMgr::Create(int64 step_id,
                                                const WorkerEnv* worker_env) {
-  return new RpcRemoteRendezvous(worker_env, step_id);
+  return new RpcRemoteRendezvous(worker_env, step_id, rpc_options_);
 }
 
 }  // end namespace tensorflow
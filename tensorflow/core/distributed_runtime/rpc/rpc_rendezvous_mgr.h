@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/base_rendezvous_mgr.h"
 #include "tensorflow/core/distributed_runtime/worker_env.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/protobuf/config.pb.h"
 
 namespace tensorflow {
 
@@ -42,14 +43,24 @@ class DeviceMgr;
 //
 // Tensors sent and recved through rendezvous managed by this
 // RendezvousMgr must have keys generated by Rendezvous::CreateKey.
+//
+// If `recv_tensor_batching_window_micros` is set in the RPC options of the
+// session, or else in `rpc_options`, the recvs of tensors produced on the CPU
+// of the same remote worker are coalesced into RecvTensors RPCs, several of
+// which may be in flight. The `tensor_compression` of the session, or else of
+// `rpc_options`, is requested for the tensors received with RecvTensor RPCs
+// whose Recv allows it, see Rendezvous::Args::allow_tensor_compression.
 class RpcRendezvousMgr : public BaseRendezvousMgr {
  public:
   explicit RpcRendezvousMgr(const WorkerEnv* env);
+  RpcRendezvousMgr(const WorkerEnv* env, const RPCOptions& rpc_options);
 
  protected:
   BaseRemoteRendezvous* Create(int64 step_id, const WorkerEnv* worker_env);
 
  private:
+  const RPCOptions rpc_options_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(RpcRendezvousMgr);
 };
 
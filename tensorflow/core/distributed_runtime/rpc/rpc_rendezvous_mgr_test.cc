@@ -15,14 +15,19 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/distributed_runtime/test_utils.h"
 #include "tensorflow/core/framework/control_flow.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session_options.h"
 
 namespace tensorflow {
 
@@ -198,6 +203,214 @@ TEST_F(RpcRendezvousMgrTest, TransferDummyDeviceContext) {
   dc->Unref();
 }
 
+// A worker that serves RecvTensors from the rendezvous of "rmgr", as
+// GrpcWorker does.
+class RecvTensorsWorker : public TestWorkerInterface {
+ public:
+  explicit RecvTensorsWorker(RendezvousMgrInterface* rmgr) : rmgr_(rmgr) {}
+
+  void RecvTensorsAsync(CallOptions* opts, const RecvTensorsRequest* request,
+                        RecvTensorsResponse* response,
+                        StatusCallback done) override {
+    const int rpc_index = num_rpcs_.fetch_add(1);
+    const int64 step_id = request->step_id();
+    std::vector<Rendezvous::ParsedKey> parsed;
+    for (const string& key : request->rendezvous_key()) {
+      parsed.push_back(MakeKey(key));
+    }
+    // As in Worker::AbortStep, the step is aborted outside of the callback,
+    // which runs under the lock of "opts".
+    opts->SetCancelCallback([this, step_id]() {
+      SchedClosure([this, step_id]() { rmgr_->Cleanup(step_id); });
+    });
+    rmgr_->RecvLocalBatchAsync(
+        step_id, parsed,
+        [opts, response, done](
+            const Status& s,
+            const std::vector<RendezvousMgrInterface::BatchedTensor>& tensors) {
+          opts->ClearCancelCallback();
+          for (const auto& tensor : tensors) {
+            response->add_rendezvous_key(tensor.key);
+            RecvTensorResponse* tensor_response = response->add_tensor();
+            tensor_response->set_is_dead(tensor.is_dead);
+            tensor.val.AsProtoTensorContent(tensor_response->mutable_tensor());
+          }
+          done(s);
+        });
+    // Notified once the RPC waits on the remote rendezvous and can be
+    // cancelled.
+    if (rpc_index == 0) first_rpc_issued_.Notify();
+  }
+
+  int num_rpcs() const { return num_rpcs_.load(); }
+
+  // Waits for the first RecvTensors RPC to be issued, and returns false if it
+  // isn't within 10 seconds.
+  bool WaitForFirstRpc() {
+    return WaitForNotificationWithTimeout(&first_rpc_issued_,
+                                          10 * 1000 * 1000);
+  }
+
+ private:
+  RendezvousMgrInterface* const rmgr_;  // Not owned.
+  std::atomic<int> num_rpcs_{0};
+  Notification first_rpc_issued_;
+};
+
+// Receives on task 2 the tensors sent on task 3 through RecvTensors RPCs.
+class RpcRendezvousMgrBatchingTest : public ::testing::Test {
+ protected:
+  RpcRendezvousMgrBatchingTest()
+      : local_rmgr_(&env_),
+        remote_rmgr_(&env_),
+        remote_worker_(&remote_rmgr_),
+        remote_session_("rpc_session", "/job:mnist/replica:1/task:3",
+                        std::unique_ptr<WorkerCacheInterface>(
+                            new TestWorkerCache),
+                        std::unique_ptr<DeviceMgr>(),
+                        std::unique_ptr<GraphMgr>()) {
+    env_.env = Env::Default();
+    TestWorkerCache* cache = new TestWorkerCache;
+    cache->AddWorker("/job:mnist/replica:1/task:3", &remote_worker_);
+    std::vector<Device*> devices = {DeviceFactory::NewDevice(
+        "CPU", SessionOptions(), "/job:mnist/replica:1/task:2")};
+    local_session_.reset(new WorkerSession(
+        "rpc_session", "/job:mnist/replica:1/task:2",
+        std::unique_ptr<WorkerCacheInterface>(cache),
+        std::unique_ptr<DeviceMgr>(new DeviceMgr(devices)),
+        std::unique_ptr<GraphMgr>()));
+    // The batching is enabled by the session, not by the RpcRendezvousMgr.
+    local_session_->rpc_options.set_recv_tensor_batching_window_micros(1000);
+  }
+
+  static Rendezvous::ParsedKey RemoteKey(const string& name) {
+    return MakeKey(Rendezvous::CreateKey(
+        "/job:mnist/replica:1/task:3/device:CPU:0", 7890,
+        "/job:mnist/replica:1/task:2/device:CPU:0", name, FrameAndIter(0, 0)));
+  }
+
+  WorkerEnv env_;
+  RpcRendezvousMgr local_rmgr_;
+  RpcRendezvousMgr remote_rmgr_;
+  RecvTensorsWorker remote_worker_;
+  WorkerSession remote_session_;
+  std::unique_ptr<WorkerSession> local_session_;
+};
+
+TEST_F(RpcRendezvousMgrBatchingTest, CrossDependentRecvs) {
+  const int64 step_id = 123;
+  const Rendezvous::ParsedKey kx = RemoteKey("x");
+  const Rendezvous::ParsedKey ky = RemoteKey("y");
+  RemoteRendezvous* local = local_rmgr_.Find(step_id);
+  core::ScopedUnref local_unref(local);
+  TF_ASSERT_OK(local->Initialize(local_session_.get()));
+  RemoteRendezvous* remote = remote_rmgr_.Find(step_id);
+  core::ScopedUnref remote_unref(remote);
+  TF_ASSERT_OK(remote->Initialize(&remote_session_));
+
+  Notification x_done;
+  Tensor x_val;
+  local->RecvAsync(kx, Rendezvous::Args(),
+                   [&x_done, &x_val](const Status& s, const Rendezvous::Args&,
+                                     const Rendezvous::Args&, const Tensor& v,
+                                     bool) {
+                     TF_EXPECT_OK(s);
+                     x_val = v;
+                     x_done.Notify();
+                   });
+  // Lets the RPC for "x" wait on the remote worker.
+  ASSERT_TRUE(remote_worker_.WaitForFirstRpc());
+  EXPECT_EQ(1, remote_worker_.num_rpcs());
+
+  // "x" is only sent once "y" is received, so the recv of "y" must not wait
+  // for the RPC in flight.
+  TF_ASSERT_OK(remote->Send(ky, Rendezvous::Args(),
+                            test::AsScalar<float>(2.0f), false));
+  Notification y_done;
+  local->RecvAsync(
+      ky, Rendezvous::Args(),
+      [remote, &kx, &y_done](const Status& s, const Rendezvous::Args&,
+                             const Rendezvous::Args&, const Tensor& v, bool) {
+        TF_EXPECT_OK(s);
+        test::ExpectTensorEqual<float>(v, test::AsScalar<float>(2.0f));
+        TF_EXPECT_OK(remote->Send(kx, Rendezvous::Args(),
+                                  test::AsScalar<float>(1.0f), false));
+        y_done.Notify();
+      });
+  EXPECT_TRUE(WaitForNotificationWithTimeout(&y_done, 10 * 1000 * 1000));
+  EXPECT_TRUE(WaitForNotificationWithTimeout(&x_done, 10 * 1000 * 1000));
+  test::ExpectTensorEqual<float>(x_val, test::AsScalar<float>(1.0f));
+  EXPECT_EQ(2, remote_worker_.num_rpcs());
+
+  local_rmgr_.Cleanup(step_id);
+  remote_rmgr_.Cleanup(step_id);
+}
+
+TEST_F(RpcRendezvousMgrBatchingTest, AbortRecvInFlight) {
+  const int64 step_id = 123;
+  RemoteRendezvous* local = local_rmgr_.Find(step_id);
+  core::ScopedUnref local_unref(local);
+  TF_ASSERT_OK(local->Initialize(local_session_.get()));
+  RemoteRendezvous* remote = remote_rmgr_.Find(step_id);
+  core::ScopedUnref remote_unref(remote);
+  TF_ASSERT_OK(remote->Initialize(&remote_session_));
+
+  Notification done;
+  local->RecvAsync(RemoteKey("x"), Rendezvous::Args(),
+                   [&done](const Status& s, const Rendezvous::Args&,
+                           const Rendezvous::Args&, const Tensor&, bool) {
+                     EXPECT_TRUE(errors::IsAborted(s)) << s;
+                     done.Notify();
+                   });
+  ASSERT_TRUE(remote_worker_.WaitForFirstRpc());
+  EXPECT_EQ(1, remote_worker_.num_rpcs());
+  local_rmgr_.Cleanup(step_id);
+  done.WaitForNotification();
+  remote_rmgr_.Cleanup(step_id);
+}
+
+TEST_F(RpcRendezvousMgrBatchingTest, AbortDropsParkedTensors) {
+  const int64 step_id = 123;
+  const Rendezvous::ParsedKey k1 = RemoteKey("k1");
+  const Rendezvous::ParsedKey k2 = RemoteKey("k2");
+  RemoteRendezvous* remote = remote_rmgr_.Find(step_id);
+  core::ScopedUnref remote_unref(remote);
+  TF_ASSERT_OK(remote->Initialize(&remote_session_));
+
+  Notification first_done;
+  remote_rmgr_.RecvLocalBatchAsync(
+      step_id, {k1, k2},
+      [&first_done](
+          const Status& s,
+          const std::vector<RendezvousMgrInterface::BatchedTensor>& tensors) {
+        TF_EXPECT_OK(s);
+        ASSERT_EQ(1, tensors.size());
+        test::ExpectTensorEqual<float>(tensors[0].val,
+                                       test::AsScalar<float>(1.0f));
+        first_done.Notify();
+      });
+  TF_ASSERT_OK(remote->Send(k1, Rendezvous::Args(),
+                            test::AsScalar<float>(1.0f), false));
+  first_done.WaitForNotification();
+  // Parked until a later call requests it.
+  TF_ASSERT_OK(remote->Send(k2, Rendezvous::Args(),
+                            test::AsScalar<float>(2.0f), false));
+
+  remote->StartAbort(errors::Aborted("Step aborted"));
+  Notification second_done;
+  remote_rmgr_.RecvLocalBatchAsync(
+      step_id, {k2},
+      [&second_done](
+          const Status& s,
+          const std::vector<RendezvousMgrInterface::BatchedTensor>& tensors) {
+        EXPECT_TRUE(errors::IsAborted(s)) << s;
+        EXPECT_TRUE(tensors.empty());
+        second_done.Notify();
+      });
+  second_done.WaitForNotification();
+  remote_rmgr_.Cleanup(step_id);
+}
+
 // NOTE: Remote Send/Recv is better tested in worker_test.cc
 
 }  // namespace tensorflow
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/device_resolver_distributed.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/protobuf/config.pb.h"
 
 namespace tensorflow {
 
@@ -33,7 +34,8 @@ RpcCollectiveExecutorMgr::RpcCollectiveExecutorMgr(
     : CollectiveExecutorMgr(config, dev_mgr, std::move(dev_resolver),
                             std::move(param_resolver)),
       worker_cache_(worker_cache),
-      task_name_(task_name) {
+      task_name_(task_name),
+      compress_tensors_(config.rpc_options().compress_collective_tensors()) {
   group_leader_ = (task_name == config.experimental().collective_group_leader())
                       ? ""
                       : config.experimental().collective_group_leader();
@@ -48,7 +50,8 @@ RpcCollectiveExecutorMgr::~RpcCollectiveExecutorMgr() {
 CollectiveExecutor* RpcCollectiveExecutorMgr::Create(int64 step_id) {
   CollectiveRemoteAccessDistributed* rma =
       new CollectiveRemoteAccessDistributed(dev_mgr_, dev_resolver_.get(),
-                                            worker_cache_, step_id);
+                                            worker_cache_, step_id,
+                                            compress_tensors_);
   return new BaseCollectiveExecutor(this, rma, step_id, dev_mgr_);
 }
 
@@ -54,6 +54,8 @@ class RpcCollectiveExecutorMgr : public CollectiveExecutorMgr {
 
   WorkerCacheInterface* const worker_cache_;  // Not owned.
   const string task_name_;
+  // RPCOptions.compress_collective_tensors of the server.
+  const bool compress_tensors_;
   string group_leader_;
   friend class RpcCollectiveExecutorMgrTest;
 
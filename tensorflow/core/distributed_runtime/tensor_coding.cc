@@ -18,8 +18,12 @@ limitations under the License.
 #include "google/protobuf/any.pb.h"
 
 #include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/distributed_runtime/tensor_compression.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
 
@@ -30,7 +34,10 @@ void TensorResponse::Clear() {
   device_ = nullptr;
   alloc_attrs_ = AllocatorAttributes();
   allocator_ = nullptr;
+  host_allocator_ = nullptr;
   already_used_ = false;
+  parse_micros_ = 0;
+  tensor_bytes_ = 0;
   ClearTensor();
 }
 
@@ -48,11 +55,20 @@ void TensorResponse::InitAlloc(DeviceBase* d, const AllocatorAttributes& aa) {
     on_host_ = true;
   }
   allocator_ = device_->GetAllocator(alloc_attrs_);
+  if (on_host_) {
+    host_allocator_ = allocator_;
+  } else if (device_->tensorflow_gpu_device_info() != nullptr) {
+    AllocatorAttributes host_alloc_attrs;
+    host_alloc_attrs.set_on_host(true);
+    host_alloc_attrs.set_gpu_compatible(true);
+    host_allocator_ = device_->GetAllocator(host_alloc_attrs);
+  }
 }
 
 Status TensorResponse::InitFrom(RecvTensorResponse* response) {
   Status s;
   meta_.Swap(response);
+  tensor_bytes_ = meta_.tensor().ByteSizeLong();
   if (on_host_) {
     if (!tensor_.FromProto(allocator_, meta_.tensor())) {
       s = errors::InvalidArgument("Cannot parse tensor from response");
@@ -79,32 +95,91 @@ void TensorResponse::InitPartial(const RecvTensorResponse& response) {
 }
 
 Status TensorResponse::ParseFrom(Source* source) {
-  if (!on_host_) {
-    protobuf::io::CodedInputStream input(source->contents());
-    input.SetTotalBytesLimit(INT_MAX, INT_MAX);  // Unlimited
+  const uint64 start_micros = Env::Default()->NowMicros();
+  Status s = ParseFromSource(source);
+  parse_micros_ = Env::Default()->NowMicros() - start_micros;
+  return s;
+}
 
-    // Pre-parse into local storage, then delegate to device.
-    if (!meta_.ParseFromCodedStream(&input) || !input.ConsumedEntireMessage()) {
-      return errors::InvalidArgument("Cannot parse tensor from response");
-    }
-    Status s =
-        device_->MakeTensorFromProto(meta_.tensor(), alloc_attrs_, &tensor_);
-    // Reduce memory usage for big tensors.
-    {
-      TensorProto empty;
-      meta_.mutable_tensor()->Swap(&empty);
-    }
-    meta_.clear_tensor();
-    return s;
-  }
+Status TensorResponse::ParseFromSource(Source* source) {
   if (already_used_) {
     ClearTensor();
   }
   already_used_ = true;
-  if (ParseFast(source)) return Status::OK();
-  meta_.Clear();
-  if (ParseSlow(source)) return Status::OK();
-  return errors::InvalidArgument("Cannot parse tensor from response");
+  if (on_host_) {
+    if (ParseFast(source)) return Status::OK();
+    meta_.Clear();
+    if (ParseSlow(source)) return Status::OK();
+    return errors::InvalidArgument("Cannot parse tensor from response");
+  }
+  // Decode the content straight into pinned host memory and copy it to the
+  // device from there, rather than through an intermediate TensorProto.
+  if (host_allocator_ != nullptr && ParseFast(source)) {
+    return CopyToDevice();
+  }
+  ClearTensor();
+  return ParseFromProto(source);
+}
+
+// Parses the whole RecvTensorResponse, then has the device make the tensor
+// from its TensorProto.
+Status TensorResponse::ParseFromProto(Source* source) {
+  protobuf::io::CodedInputStream input(source->contents());
+  input.SetTotalBytesLimit(INT_MAX, INT_MAX);  // Unlimited
+
+  // Pre-parse into local storage, then delegate to device.
+  if (!meta_.ParseFromCodedStream(&input) || !input.ConsumedEntireMessage()) {
+    return errors::InvalidArgument("Cannot parse tensor from response");
+  }
+  tensor_bytes_ = meta_.tensor().ByteSizeLong();
+  if (meta_.compression() != RPCOptions::NO_COMPRESSION) {
+    // Devices only make tensors from uncompressed protos.
+    if (meta_.tensor().dtype() != DT_FLOAT) {
+      return errors::InvalidArgument("Cannot uncompress a tensor of type ",
+                                     DataTypeString(meta_.tensor().dtype()));
+    }
+    TF_RETURN_IF_ERROR(
+        TensorShape::IsValidShape(meta_.tensor().tensor_shape()));
+    Tensor host(cpu_allocator(), meta_.tensor().dtype(),
+                TensorShape(meta_.tensor().tensor_shape()));
+    Status s = UncompressTensorContent(
+        meta_.compression(), meta_.tensor().tensor_content(), &host);
+    if (!s.ok()) return s;
+    host.AsProtoTensorContent(meta_.mutable_tensor());
+    meta_.clear_compression();
+  }
+  Status s =
+      device_->MakeTensorFromProto(meta_.tensor(), alloc_attrs_, &tensor_);
+  // Reduce memory usage for big tensors.
+  {
+    TensorProto empty;
+    meta_.mutable_tensor()->Swap(&empty);
+  }
+  meta_.clear_tensor();
+  return s;
+}
+
+// Replaces tensor_, decoded in pinned host memory, with a copy on the GPU.
+Status TensorResponse::CopyToDevice() {
+  const Tensor host = std::move(tensor_);
+  Tensor copy(allocator_, host.dtype(), host.shape());
+  if (!copy.IsInitialized()) {
+    return errors::ResourceExhausted("OOM when allocating tensor of shape ",
+                                     host.shape().DebugString(), " and type ",
+                                     DataTypeString(host.dtype()));
+  }
+  DeviceContext* device_context =
+      device_->tensorflow_gpu_device_info()->default_context;
+  Notification n;
+  Status status;
+  device_context->CopyCPUTensorToDevice(&host, static_cast<Device*>(device_),
+                                        &copy, [&n, &status](const Status& s) {
+                                          status = s;
+                                          n.Notify();
+                                        });
+  n.WaitForNotification();
+  tensor_ = std::move(copy);
+  return status;
 }
 
 // Define some helper routines for decoding protocol buffer wire format data
@@ -155,7 +230,7 @@ bool TensorResponse::ParseTensorSubmessage(
       if (ok && !seen_tensor_content) {
         // No tensor content: could be because it's a zero-length tensor
         TensorShape shape(tensor_meta->tensor_shape());
-        Tensor t(allocator_, tensor_meta->dtype(), shape);
+        Tensor t(host_allocator_, tensor_meta->dtype(), shape);
         tensor_ = std::move(t);
       }
       return ok;
@@ -195,12 +270,12 @@ bool TensorResponse::ParseTensorSubmessage(
         if (!ReadVarintSizeAsInt(input, &num_bytes)) return false;
         seen_tensor_content = true;
         TensorShape shape(tensor_meta->tensor_shape());
-        Tensor t(allocator_, tensor_meta->dtype(), shape);
+        Tensor t(host_allocator_, tensor_meta->dtype(), shape);
         StringPiece buf = t.tensor_data();
         if (static_cast<size_t>(num_bytes) != buf.size()) return false;
         // TODO(jeff,sanjay): Figure out a way to avoid this copy if
         // the underlying ZeroCopyInputStream data is properly aligned
-        // and compatible with what allocator_ wants.
+        // and compatible with what host_allocator_ wants.
         if (!input->ReadRaw(const_cast<char*>(buf.data()), num_bytes))
           return false;
         tensor_ = std::move(t);
@@ -231,6 +306,7 @@ bool TensorResponse::ParseFast(Source* source) {
 
         int length;
         if (!ReadVarintSizeAsInt(&input, &length)) return false;
+        tensor_bytes_ = length;
         std::pair<protobuf::io::CodedInputStream::Limit, int> p =
             input.IncrementRecursionDepthAndPushLimit(length);
         if (p.second < 0 ||
@@ -260,6 +336,10 @@ bool TensorResponse::ParseFast(Source* source) {
           return false;
         break;
       }
+      case RecvTensorResponse::kCompressionFieldNumber: {
+        // The tensor content is compressed, decode it on the slow path.
+        return false;
+      }
       default: {
         // Unknown tag, so don't handle we can't handle on the fast path
         return false;
@@ -274,9 +354,22 @@ bool TensorResponse::ParseSlow(Source* source) {
   if (!meta_.ParseFromZeroCopyStream(source->contents())) {
     return false;
   }
+  tensor_bytes_ = meta_.tensor().ByteSizeLong();
 
   Tensor parsed(meta_.tensor().dtype());
-  if (!parsed.FromProto(allocator_, meta_.tensor())) {
+  if (meta_.compression() != RPCOptions::NO_COMPRESSION) {
+    if (meta_.tensor().dtype() != DT_FLOAT ||
+        !TensorShape::IsValidShape(meta_.tensor().tensor_shape()).ok()) {
+      return false;
+    }
+    parsed = Tensor(host_allocator_, meta_.tensor().dtype(),
+                    TensorShape(meta_.tensor().tensor_shape()));
+    if (!UncompressTensorContent(meta_.compression(),
+                                 meta_.tensor().tensor_content(), &parsed)
+             .ok()) {
+      return false;
+    }
+  } else if (!parsed.FromProto(host_allocator_, meta_.tensor())) {
     return false;
   }
   tensor_ = std::move(parsed);
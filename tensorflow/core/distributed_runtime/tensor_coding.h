@@ -87,17 +87,33 @@ class TensorResponse {
   // modified.
   const RecvTensorResponse& metadata() const { return meta_; }
 
+  // Return the time spent in the last call to ParseFrom, in microseconds.
+  int64 parse_micros() const { return parse_micros_; }
+
+  // Return the size of the TensorProto of the tensor as it was encoded in
+  // the response, e.g. compressed, in bytes.
+  int64 tensor_bytes() const { return tensor_bytes_; }
+
  private:
+  Status ParseFromSource(Source* source);
   bool ParseTensorSubmessage(protobuf::io::CodedInputStream* input,
                              TensorProto* tensor_meta);
   bool ParseFast(Source* source);
   bool ParseSlow(Source* source);
+  Status ParseFromProto(Source* source);
+  Status CopyToDevice();
 
   bool on_host_ = false;
   DeviceBase* device_ = nullptr;
   AllocatorAttributes alloc_attrs_;
   Allocator* allocator_ = nullptr;
+  // Allocator for the tensors decoded by ParseFast and ParseSlow.  Same as
+  // allocator_ on host; on a GPU, pinned host memory from which the content
+  // is copied to the device.  Null if the device does not support it.
+  Allocator* host_allocator_ = nullptr;
   bool already_used_ = false;
+  int64 parse_micros_ = 0;
+  int64 tensor_bytes_ = 0;
   Tensor tensor_;
   RecvTensorResponse meta_;
 };
@@ -15,11 +15,17 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 
+#include <string.h>
+
+#include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/protobuf.h"
@@ -98,6 +104,7 @@ class TensorResponseTest : public ::testing::Test {
       const RecvTensorResponse& meta = response.metadata();
       EXPECT_EQ(meta.is_dead(), is_dead);
       EXPECT_EQ(meta.send_start_micros(), 123456);
+      EXPECT_EQ(proto.tensor().ByteSizeLong(), response.tensor_bytes());
 
       const Tensor& result = response.tensor();
       EXPECT_EQ(result.dtype(), src.dtype());
@@ -156,6 +163,167 @@ TEST_F(TensorResponseTest, Simple) {
 
 TEST_F(TensorResponseTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+// Copies tensors to a FakeGpuDevice, or fails with 'status' if it is set.
+class FakeGpuDeviceContext : public DeviceContext {
+ public:
+  void CopyCPUTensorToDevice(const Tensor* cpu_tensor, Device* device,
+                             Tensor* device_tensor,
+                             StatusCallback done) const override {
+    ++num_copies;
+    if (!status.ok()) {
+      done(status);
+      return;
+    }
+    const StringPiece src = cpu_tensor->tensor_data();
+    memcpy(const_cast<char*>(device_tensor->tensor_data().data()), src.data(),
+           src.size());
+    done(Status::OK());
+  }
+
+  Status status;
+  mutable int num_copies = 0;
+};
+
+// A device that is not on the host, which copies tensors from the host
+// through its default DeviceContext like a GPU.  Its memory is CPU memory.
+class FakeGpuDevice : public Device {
+ public:
+  explicit FakeGpuDevice(Env* env)
+      : Device(env, MakeAttributes()), context_(new FakeGpuDeviceContext) {
+    gpu_device_info_.default_context = context_;
+    set_tensorflow_gpu_device_info(&gpu_device_info_);
+  }
+  ~FakeGpuDevice() override { context_->Unref(); }
+
+  Allocator* GetAllocator(AllocatorAttributes attr) override {
+    if (attr.on_host()) {
+      EXPECT_TRUE(attr.gpu_compatible());
+      ++num_host_allocators;
+    }
+    return cpu_allocator();
+  }
+
+  Status Sync() override { return Status::OK(); }
+
+  Status MakeTensorFromProto(const TensorProto& tensor_proto,
+                             const AllocatorAttributes alloc_attrs,
+                             Tensor* tensor) override {
+    ++num_protos;
+    if (!tensor->FromProto(cpu_allocator(), tensor_proto)) {
+      return errors::InvalidArgument("Cannot parse tensor from proto");
+    }
+    return Status::OK();
+  }
+
+  FakeGpuDeviceContext* context() { return context_; }
+
+  int num_host_allocators = 0;
+  int num_protos = 0;
+
+ private:
+  static DeviceAttributes MakeAttributes() {
+    DeviceAttributes attr;
+    attr.set_name("/job:a/replica:0/task:0/device:GPU:0");
+    attr.set_device_type("GPU");
+    return attr;
+  }
+
+  FakeGpuDeviceContext* context_;
+  GpuDeviceInfo gpu_device_info_;
+};
+
+string EncodeResponse(const Tensor& src, bool use_tensor_content) {
+  RecvTensorResponse proto;
+  if (use_tensor_content) {
+    src.AsProtoTensorContent(proto.mutable_tensor());
+  } else {
+    src.AsProtoField(proto.mutable_tensor());
+  }
+  string encoded;
+  proto.AppendToString(&encoded);
+  return encoded;
+}
+
+TEST(TensorResponseDeviceTest, DecodesOnHostThenCopies) {
+  Tensor src(DT_FLOAT, TensorShape({2, 3}));
+  test::FillValues<float>(&src, {1, 2, 3, 4, 5, 6});
+  const string encoded = EncodeResponse(src, true);
+
+  FakeGpuDevice device(Env::Default());
+  TensorResponse response;
+  response.InitAlloc(&device, AllocatorAttributes());
+  EXPECT_EQ(1, device.num_host_allocators);
+  for (int i = 1; i <= 2; i++) {  // Twice so we exercise reuse of "response"
+    StringSource source(&encoded, 4);
+    TF_EXPECT_OK(response.ParseFrom(&source));
+    test::ExpectTensorEqual<float>(src, response.tensor());
+    EXPECT_EQ(i, device.context()->num_copies);
+  }
+  EXPECT_EQ(0, device.num_protos);
+}
+
+TEST(TensorResponseDeviceTest, ReturnsCopyError) {
+  Tensor src(DT_INT32, TensorShape({4}));
+  test::FillValues<int32>(&src, {1, 2, 3, 4});
+  const string encoded = EncodeResponse(src, true);
+
+  FakeGpuDevice device(Env::Default());
+  device.context()->status = errors::Internal("copy failed");
+  TensorResponse response;
+  response.InitAlloc(&device, AllocatorAttributes());
+  StringSource source(&encoded, 1024);
+  const Status s = response.ParseFrom(&source);
+  EXPECT_EQ(error::INTERNAL, s.code());
+  EXPECT_TRUE(str_util::StrContains(s.error_message(), "copy failed"));
+  EXPECT_EQ(1, device.context()->num_copies);
+}
+
+TEST(TensorResponseDeviceTest, FallsBackToProtoForStrings) {
+  Tensor src(DT_STRING, TensorShape({2}));
+  test::FillValues<string>(&src, {"a", "bc"});
+  const string encoded = EncodeResponse(src, true);
+
+  FakeGpuDevice device(Env::Default());
+  TensorResponse response;
+  response.InitAlloc(&device, AllocatorAttributes());
+  StringSource source(&encoded, 1024);
+  TF_EXPECT_OK(response.ParseFrom(&source));
+  test::ExpectTensorEqual<string>(src, response.tensor());
+  EXPECT_EQ(1, device.num_protos);
+  EXPECT_EQ(0, device.context()->num_copies);
+}
+
+TEST(TensorResponseDeviceTest, MalformedResponse) {
+  const string encoded = "not a RecvTensorResponse";
+  FakeGpuDevice device(Env::Default());
+  TensorResponse response;
+  response.InitAlloc(&device, AllocatorAttributes());
+  StringSource source(&encoded, 1024);
+  EXPECT_FALSE(response.ParseFrom(&source).ok());
+  EXPECT_EQ(0, device.context()->num_copies);
+}
+
+TEST(TensorResponseDeviceTest, CompressedResponseWithInvalidShape) {
+  RecvTensorResponse proto;
+  proto.set_compression(RPCOptions::FLOAT16);
+  proto.mutable_tensor()->set_dtype(DT_FLOAT);
+  proto.mutable_tensor()->mutable_tensor_shape()->add_dim()->set_size(-2);
+  proto.mutable_tensor()->set_tensor_content(string(4, 0));
+  string encoded;
+  proto.AppendToString(&encoded);
+
+  DummyDevice cpu_device(Env::Default());
+  FakeGpuDevice gpu_device(Env::Default());
+  for (DeviceBase* device : {static_cast<DeviceBase*>(&cpu_device),
+                             static_cast<DeviceBase*>(&gpu_device)}) {
+    TensorResponse response;
+    response.InitAlloc(device, AllocatorAttributes());
+    StringSource source(&encoded, 1024);
+    EXPECT_FALSE(response.ParseFrom(&source).ok());
+  }
+  EXPECT_EQ(0, gpu_device.context()->num_copies);
+}
+
 string MakeFloatTensorTestCase(int num_elems) {
   std::vector<int8> v(num_elems);
   for (int i = 0; i < num_elems; i++) {
@@ -0,0 +1,179 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/tensor_compression.h"
+
+#include <string.h>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+#include "tensorflow/core/framework/bfloat16.h"
+#include "tensorflow/core/framework/numeric_types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/snappy.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Tensors smaller than this are sent uncompressed: the RPC overhead dominates
+// their transfer time.
+const size_t kMinCompressedTensorBytes = 4096;
+
+// Groups the bytes of "n" values of "width" bytes by significance: all the
+// first bytes, then all the second bytes, etc.
+void ShuffleBytes(const char* src, int64 n, int width, char* dst) {
+  for (int b = 0; b < width; ++b) {
+    char* plane = dst + b * n;
+    for (int64 i = 0; i < n; ++i) {
+      plane[i] = src[i * width + b];
+    }
+  }
+}
+
+// Inverse of ShuffleBytes.
+void UnshuffleBytes(const char* src, int64 n, int width, char* dst) {
+  for (int b = 0; b < width; ++b) {
+    const char* plane = src + b * n;
+    for (int64 i = 0; i < n; ++i) {
+      dst[i * width + b] = plane[i];
+    }
+  }
+}
+
+bool CompressShuffleSnappy(const Tensor& val, string* out) {
+  StringPiece data = val.tensor_data();
+  std::unique_ptr<char[]> shuffled(new char[data.size()]);
+  ShuffleBytes(data.data(), val.NumElements(), sizeof(float),
+               shuffled.get());
+  return port::Snappy_Compress(shuffled.get(), data.size(), out);
+}
+
+Status UncompressShuffleSnappy(StringPiece content, Tensor* val) {
+  StringPiece data = val->tensor_data();
+  size_t uncompressed_size;
+  if (!port::Snappy_GetUncompressedLength(content.data(), content.size(),
+                                          &uncompressed_size)) {
+    return errors::Internal("Invalid snappy compressed tensor content");
+  }
+  if (uncompressed_size != data.size()) {
+    return errors::Internal("Compressed tensor content holds ",
+                            uncompressed_size, " bytes, expected ",
+                            data.size());
+  }
+  std::unique_ptr<char[]> shuffled(new char[uncompressed_size]);
+  if (!port::Snappy_Uncompress(content.data(), content.size(),
+                               shuffled.get())) {
+    return errors::Internal("Invalid snappy compressed tensor content");
+  }
+  UnshuffleBytes(shuffled.get(), val->NumElements(), sizeof(float),
+                 const_cast<char*>(data.data()));
+  return Status::OK();
+}
+
+// Rounds "value" to the 16 bits float type T.
+template <typename T>
+T RoundToHalf(float value);
+
+template <>
+Eigen::half RoundToHalf<Eigen::half>(float value) {
+  // Saturates the finite values out of the range of half, which would
+  // otherwise be received as infinities.
+  const float kMaxHalf = 65504.0f;
+  if (std::isfinite(value)) {
+    value = std::max(-kMaxHalf, std::min(kMaxHalf, value));
+  }
+  return Eigen::half(value);
+}
+
+template <>
+bfloat16 RoundToHalf<bfloat16>(float value) {
+  // Round to nearest: truncation would bias the exchanged gradients.
+  return bfloat16::round_to_bfloat16(value);
+}
+
+template <typename T>
+void CompressToHalf(const Tensor& val, string* out) {
+  auto src = val.flat<float>();
+  out->resize(src.size() * sizeof(T));
+  T* dst = reinterpret_cast<T*>(&(*out)[0]);
+  for (int64 i = 0; i < src.size(); ++i) {
+    dst[i] = RoundToHalf<T>(src(i));
+  }
+}
+
+template <typename T>
+Status UncompressFromHalf(StringPiece content, Tensor* val) {
+  auto dst = val->flat<float>();
+  if (content.size() != dst.size() * sizeof(T)) {
+    return errors::Internal("Compressed tensor content holds ",
+                            content.size(), " bytes, expected ",
+                            dst.size() * sizeof(T));
+  }
+  // "content" is not necessarily aligned for T.
+  T value;
+  for (int64 i = 0; i < dst.size(); ++i) {
+    memcpy(&value, content.data() + i * sizeof(T), sizeof(T));
+    dst(i) = static_cast<float>(value);
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+bool ShouldCompressTensor(RPCOptions::TensorCompression compression,
+                          const Tensor& val) {
+  return compression != RPCOptions::NO_COMPRESSION &&
+         val.dtype() == DT_FLOAT &&
+         val.TotalBytes() >= kMinCompressedTensorBytes;
+}
+
+bool CompressTensorContent(RPCOptions::TensorCompression compression,
+                           const Tensor& val, string* out) {
+  DCHECK_EQ(val.dtype(), DT_FLOAT);
+  switch (compression) {
+    case RPCOptions::SHUFFLE_SNAPPY:
+      return CompressShuffleSnappy(val, out);
+    case RPCOptions::FLOAT16:
+      CompressToHalf<Eigen::half>(val, out);
+      return true;
+    case RPCOptions::BFLOAT16:
+      CompressToHalf<bfloat16>(val, out);
+      return true;
+    default:
+      return false;
+  }
+}
+
+Status UncompressTensorContent(RPCOptions::TensorCompression compression,
+                               StringPiece content, Tensor* val) {
+  if (val->dtype() != DT_FLOAT) {
+    return errors::Internal("Cannot uncompress a tensor of type ",
+                            DataTypeString(val->dtype()));
+  }
+  switch (compression) {
+    case RPCOptions::SHUFFLE_SNAPPY:
+      return UncompressShuffleSnappy(content, val);
+    case RPCOptions::FLOAT16:
+      return UncompressFromHalf<Eigen::half>(content, val);
+    case RPCOptions::BFLOAT16:
+      return UncompressFromHalf<bfloat16>(content, val);
+    default:
+      return errors::Internal("Unknown tensor compression ", compression);
+  }
+}
+
+}  // namespace tensorflow
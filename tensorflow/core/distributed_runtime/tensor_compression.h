@@ -0,0 +1,50 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_COMPRESSION_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_COMPRESSION_H_
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+
+// Returns true if the content of "val" should be encoded with "compression"
+// when it is sent to another worker: only DT_FLOAT tensors large enough for
+// the compression to pay for itself are compressed. The callers only request
+// a compression for the edges that allow it, see
+// Rendezvous::Args::allow_tensor_compression, and for the buffers of
+// collective ops if RPCOptions.compress_collective_tensors is set.
+bool ShouldCompressTensor(RPCOptions::TensorCompression compression,
+                          const Tensor& val);
+
+// Encodes the content of the DT_FLOAT tensor "val" with "compression" into
+// "*out". Returns false if "compression" is not supported by this binary, in
+// which case the content must be sent uncompressed.
+bool CompressTensorContent(RPCOptions::TensorCompression compression,
+                           const Tensor& val, string* out);
+
+// Decodes "content", produced by CompressTensorContent with "compression",
+// into the DT_FLOAT tensor "*val", which must already have the shape of the
+// original tensor.
+Status UncompressTensorContent(RPCOptions::TensorCompression compression,
+                               StringPiece content, Tensor* val);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_COMPRESSION_H_
@@ -0,0 +1,98 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/tensor_compression.h"
+
+#include <limits>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+Tensor MakeGradient(int64 n) {
+  Tensor val(DT_FLOAT, TensorShape({n}));
+  auto flat = val.flat<float>();
+  for (int64 i = 0; i < n; ++i) {
+    flat(i) = 1e-3f * ((i * 7919) % 1000 - 500);
+  }
+  return val;
+}
+
+TEST(TensorCompressionTest, ShouldCompressLargeFloatTensors) {
+  EXPECT_TRUE(ShouldCompressTensor(RPCOptions::FLOAT16, MakeGradient(4096)));
+  EXPECT_FALSE(
+      ShouldCompressTensor(RPCOptions::NO_COMPRESSION, MakeGradient(4096)));
+  EXPECT_FALSE(ShouldCompressTensor(RPCOptions::FLOAT16, MakeGradient(16)));
+  EXPECT_FALSE(ShouldCompressTensor(RPCOptions::FLOAT16,
+                                    Tensor(DT_INT32, TensorShape({4096}))));
+}
+
+TEST(TensorCompressionTest, ShuffleSnappyIsLossless) {
+  Tensor val = MakeGradient(4096);
+  string compressed;
+  if (!CompressTensorContent(RPCOptions::SHUFFLE_SNAPPY, val, &compressed)) {
+    LOG(INFO) << "Snappy is not supported, skipping test";
+    return;
+  }
+  EXPECT_LT(compressed.size(), val.TotalBytes());
+
+  Tensor result(DT_FLOAT, val.shape());
+  TF_ASSERT_OK(
+      UncompressTensorContent(RPCOptions::SHUFFLE_SNAPPY, compressed, &result));
+  test::ExpectTensorEqual<float>(val, result);
+}
+
+TEST(TensorCompressionTest, HalfPrecisionRoundTrip) {
+  Tensor val = MakeGradient(4096);
+  for (auto compression : {RPCOptions::FLOAT16, RPCOptions::BFLOAT16}) {
+    string compressed;
+    ASSERT_TRUE(CompressTensorContent(compression, val, &compressed));
+    EXPECT_EQ(val.TotalBytes() / 2, compressed.size());
+
+    Tensor result(DT_FLOAT, val.shape());
+    TF_ASSERT_OK(UncompressTensorContent(compression, compressed, &result));
+    test::ExpectTensorNear<float>(val, result, 5e-3);
+  }
+}
+
+TEST(TensorCompressionTest, Float16SaturatesOutOfRangeValues) {
+  const float inf = std::numeric_limits<float>::infinity();
+  Tensor val = test::AsTensor<float>({1e5f, -1e6f, 1.5f, inf, -inf});
+  string compressed;
+  ASSERT_TRUE(CompressTensorContent(RPCOptions::FLOAT16, val, &compressed));
+
+  Tensor result(DT_FLOAT, val.shape());
+  TF_ASSERT_OK(
+      UncompressTensorContent(RPCOptions::FLOAT16, compressed, &result));
+  test::ExpectTensorEqual<float>(
+      test::AsTensor<float>({65504.0f, -65504.0f, 1.5f, inf, -inf}), result);
+}
+
+TEST(TensorCompressionTest, RejectContentOfWrongSize) {
+  Tensor val = MakeGradient(4096);
+  string compressed;
+  ASSERT_TRUE(CompressTensorContent(RPCOptions::FLOAT16, val, &compressed));
+
+  Tensor result(DT_FLOAT, TensorShape({1024}));
+  EXPECT_FALSE(
+      UncompressTensorContent(RPCOptions::FLOAT16, compressed, &result).ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
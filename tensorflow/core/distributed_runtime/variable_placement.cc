@@ -0,0 +1,256 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/variable_placement.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <utility>
+
+#include "tensorflow/core/common_runtime/shape_refiner.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Recommendations only worth it if they cut the load of the most loaded task
+// by at least this fraction.
+const double kMinLoadReduction = 0.2;
+
+// Maximum number of moves spelled out in a recommendation.
+const int kMaxMovesInAdvice = 20;
+
+bool IsVariableOp(const Node* node) {
+  return node->type_string() == "VariableV2" ||
+         node->type_string() == "Variable" ||
+         node->type_string() == "VarHandleOp";
+}
+
+string TaskName(const Node* node) {
+  string task;
+  string device;
+  if (!DeviceNameUtils::SplitDeviceName(node->assigned_device_name(), &task,
+                                        &device)) {
+    return "";
+  }
+  return task;
+}
+
+int64 VariableBytes(const Node* node) {
+  DataType dtype;
+  PartialTensorShape shape;
+  if (!GetNodeAttr(node->attrs(), "dtype", &dtype).ok() ||
+      !GetNodeAttr(node->attrs(), "shape", &shape).ok() ||
+      !shape.IsFullyDefined()) {
+    return 0;
+  }
+  return shape.num_elements() * DataTypeSize(BaseType(dtype));
+}
+
+// Infers the shapes of the outputs of the nodes of 'graph' where possible.
+void InferShapes(const Graph& graph, ShapeRefiner* refiner) {
+  refiner->set_require_shape_inference_fns(false);
+  std::vector<Node*> order;
+  GetReversePostOrder(graph, &order);
+  for (const Node* node : order) {
+    // A node whose shapes can't be inferred is left out, and so are its
+    // consumers.  The reads through them are charged the whole variable.
+    refiner->AddNode(node).IgnoreError();
+  }
+}
+
+// Returns the size of output 'port' of 'node' inferred by 'refiner',
+// counting each unknown dimension as 1, or -1 if its rank is unknown.
+int64 OutputBytes(const ShapeRefiner& refiner, const Node* node, int port) {
+  shape_inference::InferenceContext* c = refiner.GetContext(node);
+  if (c == nullptr) return -1;
+  shape_inference::ShapeHandle shape = c->output(port);
+  if (!c->RankKnown(shape)) return -1;
+  int64 num_elements = 1;
+  for (int i = 0; i < c->Rank(shape); ++i) {
+    const int64 dim = c->Value(c->Dim(shape, i));
+    if (dim >= 0) num_elements *= dim;
+  }
+  return num_elements * DataTypeSize(BaseType(node->output_type(port)));
+}
+
+std::map<string, int64> TaskLoads(
+    const std::vector<VariableLoad>& variables,
+    const std::unordered_map<string, string>& placement) {
+  std::map<string, int64> loads;
+  for (const VariableLoad& variable : variables) {
+    loads[placement.at(variable.name)] += variable.load;
+  }
+  return loads;
+}
+
+int64 MaxLoad(const std::map<string, int64>& loads) {
+  int64 max_load = 0;
+  for (const auto& task_load : loads) {
+    max_load = std::max(max_load, task_load.second);
+  }
+  return max_load;
+}
+
+}  // namespace
+
+std::vector<VariableLoad> GetVariableLoads(const Graph& graph) {
+  ShapeRefiner refiner(graph.versions(), graph.op_registry());
+  InferShapes(graph, &refiner);
+
+  std::vector<VariableLoad> variables;
+  for (const Node* node : graph.op_nodes()) {
+    if (!IsVariableOp(node)) continue;
+    VariableLoad variable;
+    variable.name = node->name();
+    variable.task = TaskName(node);
+    variable.bytes = VariableBytes(node);
+    variable.load = 0;
+    // The outputs sent to each task, as (task, (node id, output)).  An
+    // output is sent to a task once, however many of its ops consume it.
+    std::set<std::pair<string, std::pair<int, int>>> sent;
+    for (const Edge* edge : node->out_edges()) {
+      if (edge->IsControlEdge()) continue;
+      const Node* reader = edge->dst();
+      const string reader_task = TaskName(reader);
+      if (reader_task != variable.task) {
+        if (sent.emplace(reader_task,
+                         std::make_pair(node->id(), edge->src_output()))
+                .second) {
+          variable.load += variable.bytes;
+        }
+        continue;
+      }
+      // Variables are mostly read through ops placed next to them, such as
+      // Identity, ReadVariableOp or a gather, whose outputs are then sent.
+      for (const Edge* read_edge : reader->out_edges()) {
+        if (read_edge->IsControlEdge()) continue;
+        const string task = TaskName(read_edge->dst());
+        if (task == variable.task ||
+            !sent.emplace(task, std::make_pair(reader->id(),
+                                               read_edge->src_output()))
+                 .second) {
+          continue;
+        }
+        const int64 bytes =
+            OutputBytes(refiner, reader, read_edge->src_output());
+        variable.load += bytes >= 0 ? bytes : variable.bytes;
+      }
+    }
+    variables.push_back(std::move(variable));
+  }
+  return variables;
+}
+
+std::unordered_map<string, string> BalanceVariableLoads(
+    const std::vector<VariableLoad>& variables,
+    const std::vector<string>& tasks) {
+  std::unordered_map<string, string> placement;
+  // Variables to move and the tasks of each job, by job name.
+  std::map<string, std::vector<const VariableLoad*>> job_variables;
+  std::map<string, std::set<std::pair<int64, string>>> job_tasks;
+  for (const string& task : tasks) {
+    DeviceNameUtils::ParsedName parsed;
+    if (DeviceNameUtils::ParseFullName(task, &parsed) && parsed.has_job) {
+      job_tasks[parsed.job].emplace(0, task);
+    }
+  }
+  for (const VariableLoad& variable : variables) {
+    placement[variable.name] = variable.task;
+    DeviceNameUtils::ParsedName task;
+    if (variable.load == 0 ||
+        !DeviceNameUtils::ParseFullName(variable.task, &task) ||
+        !task.has_job) {
+      continue;
+    }
+    job_variables[task.job].push_back(&variable);
+    // In case the task of the variable is missing from 'tasks'.
+    job_tasks[task.job].emplace(0, variable.task);
+  }
+
+  for (auto& job : job_variables) {
+    std::vector<const VariableLoad*>& sorted = job.second;
+    std::set<std::pair<int64, string>>& tasks = job_tasks[job.first];
+    std::sort(sorted.begin(), sorted.end(),
+              [](const VariableLoad* a, const VariableLoad* b) {
+                if (a->load != b->load) return a->load > b->load;
+                return a->name < b->name;
+              });
+    for (const VariableLoad* variable : sorted) {
+      // Ties between tasks go to the first one by name, which keeps the
+      // recommendation stable across runs.
+      auto least_loaded = tasks.begin();
+      const int64 load = least_loaded->first + variable->load;
+      const string task = least_loaded->second;
+      tasks.erase(least_loaded);
+      tasks.emplace(load, task);
+      placement[variable->name] = task;
+    }
+  }
+  return placement;
+}
+
+string VariablePlacementAdvice(const Graph& graph, const DeviceSet& devices) {
+  const std::vector<VariableLoad> variables = GetVariableLoads(graph);
+  std::unordered_map<string, string> current;
+  for (const VariableLoad& variable : variables) {
+    current[variable.name] = variable.task;
+  }
+  std::set<string> tasks;
+  for (const Device* device : devices.devices()) {
+    string task;
+    string unused;
+    if (DeviceNameUtils::SplitDeviceName(device->name(), &task, &unused)) {
+      tasks.insert(task);
+    }
+  }
+  const std::unordered_map<string, string> balanced = BalanceVariableLoads(
+      variables, std::vector<string>(tasks.begin(), tasks.end()));
+  const int64 current_max = MaxLoad(TaskLoads(variables, current));
+  const int64 balanced_max = MaxLoad(TaskLoads(variables, balanced));
+  if (balanced_max > current_max * (1 - kMinLoadReduction)) return "";
+
+  string advice = strings::StrCat(
+      "Variables are unevenly spread across tasks: the most loaded task "
+      "serves an estimated ",
+      strings::HumanReadableNumBytes(current_max), " per step, which could "
+      "be reduced to ",
+      strings::HumanReadableNumBytes(balanced_max),
+      " by placing the variables as follows:");
+  int num_moves = 0;
+  for (const VariableLoad& variable : variables) {
+    const string& task = balanced.at(variable.name);
+    if (task == variable.task) continue;
+    if (++num_moves > kMaxMovesInAdvice) continue;
+    strings::StrAppend(&advice, "\n  ", variable.name, ": ", variable.task,
+                       " -> ", task);
+  }
+  if (num_moves > kMaxMovesInAdvice) {
+    strings::StrAppend(&advice, "\n  ... and ",
+                       num_moves - kMaxMovesInAdvice, " more");
+  }
+  return advice;
+}
+
+}  // namespace tensorflow
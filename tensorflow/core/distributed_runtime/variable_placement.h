@@ -0,0 +1,68 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_VARIABLE_PLACEMENT_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_VARIABLE_PLACEMENT_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/device_set.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// The load a variable puts on the task holding it, estimated from a placed
+// graph: every step, the variable (or the part of it that is read) is sent
+// over the network to each other task that reads it.
+struct VariableLoad {
+  string name;
+  // Task holding the variable, e.g. "/job:ps/replica:0/task:1".
+  string task;
+  // Size of the variable, or 0 if its shape is not fully defined.
+  int64 bytes;
+  // Bytes sent to the tasks other than 'task' per step.  A task that reads
+  // the variable directly, or through an op placed on 'task' with an output
+  // of unknown rank, is charged the whole variable.  A task that reads the
+  // output of an op placed on 'task' is charged the size of that output,
+  // so a gather is charged the gathered rows, and a row for each unknown
+  // dimension.
+  int64 load;
+};
+
+// Returns the variables of 'graph', whose nodes must have been assigned to
+// devices, in the order of their node ids.
+std::vector<VariableLoad> GetVariableLoads(const Graph& graph);
+
+// Spreads the variables of each job over the tasks of the job in 'tasks',
+// so that the load of the most loaded task is close to minimal, by placing
+// each variable in decreasing order of load on the least loaded task.  Tasks
+// that hold no variable yet are candidates as well.  Variables that no other
+// task reads stay where they are.  Returns the task of each variable, keyed
+// by name.
+std::unordered_map<string, string> BalanceVariableLoads(
+    const std::vector<VariableLoad>& variables,
+    const std::vector<string>& tasks);
+
+// Returns a human-readable recommendation to move variables between the
+// tasks of 'devices', or an empty string if they are already about as evenly
+// loaded as BalanceVariableLoads can make them.  The nodes of 'graph' must
+// have been assigned to 'devices'.
+string VariablePlacementAdvice(const Graph& graph, const DeviceSet& devices);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_VARIABLE_PLACEMENT_H_
@@ -0,0 +1,212 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/variable_placement.h"
+
+#include "tensorflow/cc/framework/scope.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+const char kPs0[] = "/job:ps/replica:0/task:0";
+const char kPs1[] = "/job:ps/replica:0/task:1";
+const char kWorker0[] = "/job:worker/replica:0/task:0";
+const char kWorker1[] = "/job:worker/replica:0/task:1";
+
+// Assigns the nodes of 'graph' to the devices they were built on.
+void AssignDevices(Graph* graph) {
+  for (Node* node : graph->op_nodes()) {
+    node->set_assigned_device_name(node->requested_device());
+  }
+}
+
+// Builds a graph with three variables read by two workers, and assigns its
+// nodes to the devices they were built on.
+//
+//   a: 1000 floats on ps 0, read through an Identity by both workers.
+//   b: 1000 floats on ps 0, read by worker 0.
+//   c: 10 floats on 'c_task', read by both workers.
+void BuildGraph(const string& c_task, Graph* graph) {
+  Scope root = Scope::NewRootScope();
+  Scope ps0 = root.WithDevice(strings::StrCat(kPs0, "/device:CPU:0"));
+  Scope c_ps = root.WithDevice(strings::StrCat(c_task, "/device:CPU:0"));
+  Scope worker0 = root.WithDevice(strings::StrCat(kWorker0, "/device:CPU:0"));
+  Scope worker1 = root.WithDevice(strings::StrCat(kWorker1, "/device:CPU:0"));
+
+  auto a = ops::Variable(ps0.WithOpName("a"), {1000}, DT_FLOAT);
+  auto a_read = ops::Identity(ps0.WithOpName("a_read"), a);
+  ops::Square(worker0, a_read);
+  ops::Square(worker1, a_read);
+  auto b = ops::Variable(ps0.WithOpName("b"), {1000}, DT_FLOAT);
+  ops::Square(worker0, b);
+  auto c = ops::Variable(c_ps.WithOpName("c"), {10}, DT_FLOAT);
+  ops::Square(worker0, c);
+  ops::Square(worker1, c);
+
+  TF_ASSERT_OK(root.ToGraph(graph));
+  AssignDevices(graph);
+}
+
+VariableLoad MakeVariableLoad(const string& name, const string& task,
+                              int64 load) {
+  VariableLoad variable;
+  variable.name = name;
+  variable.task = task;
+  variable.bytes = load;
+  variable.load = load;
+  return variable;
+}
+
+class VariablePlacementTest : public ::testing::Test {
+ protected:
+  // Adds a CPU device on 'task' to devices_.
+  void AddTask(const string& task) {
+    Device* device = DeviceFactory::NewDevice("CPU", SessionOptions(), task);
+    ASSERT_TRUE(device != nullptr);
+    owned_devices_.emplace_back(device);
+    devices_.AddDevice(device);
+  }
+
+  std::vector<std::unique_ptr<Device>> owned_devices_;
+  DeviceSet devices_;
+};
+
+TEST_F(VariablePlacementTest, GetVariableLoads) {
+  Graph graph(OpRegistry::Global());
+  BuildGraph(kPs1, &graph);
+
+  std::vector<VariableLoad> variables = GetVariableLoads(graph);
+  ASSERT_EQ(3, variables.size());
+  EXPECT_EQ("a", variables[0].name);
+  EXPECT_EQ(kPs0, variables[0].task);
+  EXPECT_EQ(4000, variables[0].bytes);
+  EXPECT_EQ(8000, variables[0].load);
+  EXPECT_EQ("b", variables[1].name);
+  EXPECT_EQ(4000, variables[1].load);
+  EXPECT_EQ("c", variables[2].name);
+  EXPECT_EQ(kPs1, variables[2].task);
+  EXPECT_EQ(80, variables[2].load);
+}
+
+TEST_F(VariablePlacementTest, GatheredReadsAreChargedByOutputSize) {
+  Scope root = Scope::NewRootScope();
+  Scope ps0 = root.WithDevice(strings::StrCat(kPs0, "/device:CPU:0"));
+  Scope worker0 = root.WithDevice(strings::StrCat(kWorker0, "/device:CPU:0"));
+  Scope worker1 = root.WithDevice(strings::StrCat(kWorker1, "/device:CPU:0"));
+
+  // 100 rows of 10 floats, of which worker 0 gathers 3 rows and worker 1 an
+  // unknown number of rows.
+  auto e = ops::Variable(ps0.WithOpName("e"), {100, 10}, DT_FLOAT);
+  auto known_rows = ops::Gather(ps0, e, ops::Const(ps0, {1, 2, 3}));
+  ops::Square(worker0, known_rows);
+  auto indices = ops::Placeholder(ps0, DT_INT32,
+                                  ops::Placeholder::Shape({-1}));
+  auto unknown_rows = ops::Gather(ps0, e, indices);
+  ops::Square(worker1, unknown_rows);
+
+  Graph graph(OpRegistry::Global());
+  TF_ASSERT_OK(root.ToGraph(&graph));
+  AssignDevices(&graph);
+
+  std::vector<VariableLoad> variables = GetVariableLoads(graph);
+  ASSERT_EQ(1, variables.size());
+  EXPECT_EQ(4000, variables[0].bytes);
+  // 3 rows for worker 0, and an unknown number counted as 1 for worker 1.
+  EXPECT_EQ(160, variables[0].load);
+}
+
+TEST_F(VariablePlacementTest, BalanceVariableLoads) {
+  std::vector<VariableLoad> variables;
+  variables.push_back(MakeVariableLoad("a", kPs0, 200));
+  variables.push_back(MakeVariableLoad("b", kPs0, 150));
+  variables.push_back(MakeVariableLoad("c", kPs0, 50));
+  variables.push_back(MakeVariableLoad("d", kPs1, 20));
+  // Not read by any other task, so it stays on its task.
+  variables.push_back(MakeVariableLoad("local", kWorker0, 0));
+
+  std::unordered_map<string, string> placement =
+      BalanceVariableLoads(variables, {kPs0, kPs1, kWorker0, kWorker1});
+  EXPECT_EQ(kPs0, placement["a"]);
+  EXPECT_EQ(kPs1, placement["b"]);
+  EXPECT_EQ(kPs1, placement["c"]);
+  EXPECT_EQ(kPs0, placement["d"]);
+  EXPECT_EQ(kWorker0, placement["local"]);
+}
+
+TEST_F(VariablePlacementTest, BalanceVariableLoadsOverIdleTasks) {
+  const char kPs2[] = "/job:ps/replica:0/task:2";
+  std::vector<VariableLoad> variables;
+  variables.push_back(MakeVariableLoad("a", kPs0, 100));
+  variables.push_back(MakeVariableLoad("b", kPs0, 100));
+  variables.push_back(MakeVariableLoad("c", kPs0, 100));
+
+  // Tasks of the job that hold no variable yet receive some.
+  std::unordered_map<string, string> placement =
+      BalanceVariableLoads(variables, {kPs0, kPs1, kPs2, kWorker0});
+  EXPECT_EQ(kPs0, placement["a"]);
+  EXPECT_EQ(kPs1, placement["b"]);
+  EXPECT_EQ(kPs2, placement["c"]);
+}
+
+TEST_F(VariablePlacementTest, AdviseToMoveVariables) {
+  AddTask(kPs0);
+  AddTask(kPs1);
+  AddTask(kWorker0);
+  AddTask(kWorker1);
+  Graph graph(OpRegistry::Global());
+  BuildGraph(kPs1, &graph);
+
+  const string advice = VariablePlacementAdvice(graph, devices_);
+  EXPECT_TRUE(str_util::StrContains(
+      advice, "\n  b: /job:ps/replica:0/task:0 -> /job:ps/replica:0/task:1"))
+      << advice;
+  EXPECT_FALSE(str_util::StrContains(advice, "\n  a: ")) << advice;
+  EXPECT_FALSE(str_util::StrContains(advice, "\n  c: ")) << advice;
+}
+
+TEST_F(VariablePlacementTest, AdviseToMoveVariablesToIdleTask) {
+  AddTask(kPs0);
+  AddTask(kPs1);
+  AddTask(kWorker0);
+  AddTask(kWorker1);
+  Graph graph(OpRegistry::Global());
+  // All the variables are on ps 0, and ps 1 holds none.
+  BuildGraph(kPs0, &graph);
+
+  const string advice = VariablePlacementAdvice(graph, devices_);
+  EXPECT_TRUE(str_util::StrContains(
+      advice, "\n  b: /job:ps/replica:0/task:0 -> /job:ps/replica:0/task:1"))
+      << advice;
+  EXPECT_FALSE(str_util::StrContains(advice, "\n  a: ")) << advice;
+}
+
+TEST_F(VariablePlacementTest, NoAdviceForSingleTask) {
+  AddTask(kPs0);
+  AddTask(kWorker0);
+  AddTask(kWorker1);
+  Graph graph(OpRegistry::Global());
+  BuildGraph(kPs0, &graph);
+
+  EXPECT_EQ("", VariablePlacementAdvice(graph, devices_));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/cluster_function_library_runtime.h"
 #include "tensorflow/core/distributed_runtime/graph_mgr.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
+#include "tensorflow/core/protobuf/config.pb.h"
 
 namespace tensorflow {
 
@@ -57,6 +58,11 @@ struct WorkerSession {
 
   std::unique_ptr<ClusterFunctionLibraryRuntime> cluster_flr;
 
+  // The RPC options of the master session, if it sent them with
+  // CreateWorkerSession. Non-default options take precedence over the RPC
+  // options of the server.
+  RPCOptions rpc_options;
+
   WorkerSession(const string& session_name, const string& worker_name,
                 std::unique_ptr<WorkerCacheInterface> worker_cache,
                 std::unique_ptr<DeviceMgr> device_mgr,
@@ -50,6 +50,7 @@ CollInstanceParams& CollInstanceParams::operator=(
     impl_details.subdiv_source_rank.assign(
         other.impl_details.subdiv_source_rank.begin(),
         other.impl_details.subdiv_source_rank.end());
+    impl_details.reduction_algorithm = other.impl_details.reduction_algorithm;
   }
   return *this;
 }
@@ -84,6 +85,10 @@ string CollInstanceParams::ToString() const {
     }
     strings::StrAppend(&v, "}");
   }
+  if (impl_details.reduction_algorithm != AUTO_REDUCTION) {
+    strings::StrAppend(&v, " reduction_algorithm=",
+                       impl_details.reduction_algorithm);
+  }
   strings::StrAppend(&v, "}");  // all subdivs
   return v;
 }
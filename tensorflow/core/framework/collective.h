@@ -56,6 +56,27 @@ struct CollGroupParams {
       : group_key(0), group_size(0), device_type(DEVICE_CPU), num_tasks(0) {}
 };
 
+// Algorithms implementing collective all-reduce.  Every member of a group
+// must use the same one.
+enum CollectiveReductionAlgorithm {
+  // Let the param resolver pick one of the others from the tensor size and
+  // the group topology.
+  AUTO_REDUCTION = 0,
+  // Pipelined ring, see RingReducer.  Takes O(group_size) rounds and is
+  // bandwidth optimal, which suits large tensors.
+  RING_REDUCTION,
+  // Recursive halving reduce-scatter then recursive doubling all-gather, see
+  // RecursiveHalvingReducer.  Takes O(log(group_size)) rounds, which pays
+  // off for latency bound reductions: AUTO picks it for tensors under 1MB
+  // over more than two devices.
+  RECURSIVE_HALVING_REDUCTION,
+  // Intra-task reduce, inter-task ring then intra-task broadcast, see
+  // HierarchicalReducer.  Only one device per task sends over the network:
+  // AUTO picks it for tensors of 1MB or more over several tasks with several
+  // devices each.
+  HIERARCHICAL_REDUCTION,
+};
+
 // The best implementation of a collective op depends on many factors
 // including the number of devices involved, the topology of
 // interconnects between them and the sizes of inputs.  This structure
@@ -68,6 +89,8 @@ struct CollImplDetails {
   std::vector<int> subdiv_offsets;
   // broadcast only: rank of source in each subdiv
   std::vector<int> subdiv_source_rank;
+  // reduction only: algorithm used for the all-reduce
+  CollectiveReductionAlgorithm reduction_algorithm = AUTO_REDUCTION;
 };
 
 // Data common to all members of a collective instance.
@@ -48,6 +48,9 @@ class Rendezvous : public core::RefCounted {
   struct Args {
     DeviceContext* device_context = nullptr;
     AllocatorAttributes alloc_attrs;
+    // If true, the tensor may be compressed when it is received from another
+    // process, as configured by RPCOptions.tensor_compression.
+    bool allow_tensor_compression = false;
   };
 
   // Constructs a rendezvous key for the tensor of "name" sent from
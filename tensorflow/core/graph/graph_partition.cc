@@ -263,6 +263,16 @@ NodeDef* AddRecv(const PartitionOptions& opts, const GraphInfo& g_info,
   SetSendRecvAttrs(opts, edge, &recv_builder);
   recv_builder.Device(dst->assigned_device_name())
       .Attr("tensor_type", cast_dtype);
+  // The outputs of "src" may be compressed when they are sent to another
+  // process if it has the attr "_allow_tensor_compression".
+  bool allow_tensor_compression = false;
+  if (!edge->IsControlEdge() &&
+      GetNodeAttr(src->attrs(), "_allow_tensor_compression",
+                  &allow_tensor_compression)
+          .ok() &&
+      allow_tensor_compression) {
+    recv_builder.Attr("_allow_tensor_compression", true);
+  }
   NodeDef* recv = gdef->add_node();
   *status = recv_builder.Finalize(recv);
   if (!status->ok()) return nullptr;
@@ -270,6 +270,39 @@ TEST_F(GraphPartitionTest, CrossDeviceData) {
   ExpectMatchB();
 }
 
+TEST_F(GraphPartitionTest, CrossDeviceDataAllowTensorCompression) {
+  auto a1 = FloatInput(in_.WithOpName("A1"));
+  auto b1 = FloatInput(in_.WithOpName("B1"));
+  Combine(in_.WithOpName("B2"), a1, b1);
+  GraphDef graph_def = ToGraphDef();
+  for (NodeDef& ndef : *graph_def.mutable_node()) {
+    if (ndef.name() == "A1") {
+      AddNodeAttr("_allow_tensor_compression", true, &ndef);
+    }
+  }
+
+  Partition(graph_def, &partitions_);
+  EXPECT_EQ(2, partitions_.size());
+
+  // Only the Recv, which requests the tensor, has the attr.
+  int num_recvs = 0;
+  for (const auto& partition : partitions_) {
+    for (const NodeDef& ndef : partition.second.node()) {
+      bool allow_tensor_compression = false;
+      const bool has_attr = GetNodeAttr(ndef, "_allow_tensor_compression",
+                                        &allow_tensor_compression)
+                                .ok();
+      if (ndef.op() == "_Recv") {
+        ++num_recvs;
+        EXPECT_TRUE(has_attr && allow_tensor_compression);
+      } else if (ndef.op() == "_Send") {
+        EXPECT_FALSE(has_attr);
+      }
+    }
+  }
+  EXPECT_EQ(1, num_recvs);
+}
+
 TEST_F(GraphPartitionTest, CrossDeviceControl) {
   auto a1 = FloatInput(in_.WithOpName("A1"));
   auto b1 = FloatInput(in_.WithOpName("B1"));
@@ -15,6 +15,7 @@ limitations under the License.
 
 #ifdef INTEL_MKL
 
+#include <map>
 #include <memory>
 #include <queue>
 #include <set>
@@ -106,7 +107,14 @@ class MklToTfConversionPass : public GraphOptimizationPass {
     return mkl_op_registry::IsMklElementWiseOp(op_name, T);
   }
 
+  // Conversion nodes inserted so far, keyed by the (node, output slot) of the
+  // Mkl tensor they convert. All the non-Mkl consumers of the same Mkl tensor
+  // share a single conversion node.
+  typedef std::map<std::pair<const Node*, int>, Node*> ConversionNodeMap;
+
   // Insert layout conversion node on the edge pointed by 'e' from graph 'g'.
+  // If the source tensor of the edge was already converted for another
+  // consumer, the existing conversion node is reused.
   //
   // Edge will be deleted once a call to this function is successful.
   // Any attempt to use the edge after this call
@@ -114,7 +122,8 @@ class MklToTfConversionPass : public GraphOptimizationPass {
   //
   // @return Success:OK() if insertion is successful, otherwise returns
   //         appropriate error status code.
-  Status InsertConversionNodeOnEdge(std::unique_ptr<Graph>* g, Edge*);
+  Status InsertConversionNodeOnEdge(std::unique_ptr<Graph>* g, Edge*,
+                                    ConversionNodeMap* conversion_nodes);
 
   // For element-wise ops, we need to sanitize the inputs. For this, we add a
   // new node at the input of the replacement element-wise node that checks
@@ -137,8 +146,9 @@ const OptimizationPassRegistry::Grouping kMklTfConvPassGroup =
 REGISTER_OPTIMIZATION(kMklTfConvPassGroup, 2, MklToTfConversionPass);
 
 Status MklToTfConversionPass::InsertConversionNodeOnEdge(
-    std::unique_ptr<Graph>* g, Edge* e) {
+    std::unique_ptr<Graph>* g, Edge* e, ConversionNodeMap* conversion_nodes) {
   CHECK_NOTNULL(e);
+  CHECK_NOTNULL(conversion_nodes);
 
   Node* src = e->src();
   Node* dst = e->dst();
@@ -162,6 +172,17 @@ Status MklToTfConversionPass::InsertConversionNodeOnEdge(
     return Status(error::Code::INVALID_ARGUMENT, err_msg.c_str());
   }
 
+  // Reuse the conversion node of another consumer of the same Mkl tensor.
+  const std::pair<const Node*, int> src_tensor(src, e->src_output());
+  Node* existing_node = gtl::FindPtrOrNull(*conversion_nodes, src_tensor);
+  if (existing_node != nullptr) {
+    CHECK_NOTNULL((*g)->AddEdge(existing_node, 0, dst, e->dst_input()));
+    VLOG(1) << "MklToTfConversionPass: Reusing Conversion node "
+            << existing_node->name() << " for " << dst->name();
+    (*g)->RemoveEdge(e);
+    return Status::OK();
+  }
+
   // Build the conversion node and specify src as input.
   TF_CHECK_OK(
       NodeBuilder((*g)->NewName("Mkl2Tf"), "_MklToTf")
@@ -186,6 +207,7 @@ Status MklToTfConversionPass::InsertConversionNodeOnEdge(
 
   // Set the Mkl op label for this op.
   conversion_node->AddAttr("_kernel", mkl_op_registry::kMklOpLabel);
+  conversion_nodes->emplace(src_tensor, conversion_node);
 
   // Now that we have added edge from src->conversion_node, let's add edge from
   // output of conversion_node to the dest node. Since conversion_node
@@ -341,12 +363,13 @@ bool MklToTfConversionPass::RunPass(std::unique_ptr<Graph>* g) {
   }
 
   // Process all candidate edges and insert conversion nodes on them.
+  ConversionNodeMap conversion_nodes;
   for (Edge* e : candidate_edges) {
     // Even if we insert conversion node on a single edge, we
     // need to return true.
     string src_name = e->src()->name();
     string dst_name = e->dst()->name();
-    if (InsertConversionNodeOnEdge(g, e) == Status::OK()) {
+    if (InsertConversionNodeOnEdge(g, e, &conversion_nodes) == Status::OK()) {
       VLOG(1) << "MklToTfConversionPass: Inserted conversion "
               << "node on edge between " << src_name << " and " << dst_name;
       result = true;
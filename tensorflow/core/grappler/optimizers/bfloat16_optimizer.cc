@@ -0,0 +1,217 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/bfloat16_optimizer.h"
+
+#include <unordered_map>
+#include <unordered_set>
+
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// Ops that are always converted to bfloat16: they are compute and bandwidth
+// bound, and their bfloat16 CPU kernels accumulate in float.
+const std::unordered_set<string>& AllowedOps() {
+  static const std::unordered_set<string>* allowed_ops =
+      new std::unordered_set<string>({"Conv2D", "MatMul"});
+  return *allowed_ops;
+}
+
+// Ops that are converted to bfloat16 if at least one of their inputs is
+// produced in bfloat16. Only ops that move data are propagated: the bfloat16
+// CPU kernels of arithmetic elementwise ops (Add, BiasAdd, Relu, ...) are
+// emulated one scalar at a time, so they run in float after a Cast.
+const std::unordered_set<string>& PropagatedOps() {
+  static const std::unordered_set<string>* propagated_ops =
+      new std::unordered_set<string>({"Identity"});
+  return *propagated_ops;
+}
+
+bool IsOnCPU(const NodeDef& node) {
+  DeviceNameUtils::ParsedName parsed_name;
+  return DeviceNameUtils::ParseFullName(node.device(), &parsed_name) &&
+         parsed_name.has_type && parsed_name.type == DEVICE_CPU;
+}
+
+bool HasFloatType(const NodeDef& node) {
+  const auto it = node.attr().find("T");
+  return it != node.attr().end() && it->second.type() == DT_FLOAT;
+}
+
+class BFloat16Rewriter {
+ public:
+  BFloat16Rewriter(const std::unordered_set<string>& nodes_to_preserve,
+                   GraphDef* graph)
+      : nodes_to_preserve_(nodes_to_preserve), graph_(graph) {}
+
+  Status Rewrite() {
+    FindBFloat16Nodes();
+    if (bfloat16_nodes_.empty()) return Status::OK();
+
+    VLOG(1) << "Convert " << bfloat16_nodes_.size()
+            << " nodes to bfloat16 precision";
+
+    // Iterate only over the nodes of the original graph, Cast nodes are
+    // appended to the end.
+    const int num_nodes = graph_->node_size();
+    for (int i = 0; i < num_nodes; ++i) {
+      NodeDef* node = graph_->mutable_node(i);
+      const bool is_bfloat16 = bfloat16_nodes_.count(node->name()) > 0;
+
+      for (int j = 0; j < node->input_size(); ++j) {
+        const string& input = node->input(j);
+        if (IsControlInput(input)) break;
+
+        const bool is_bfloat16_input =
+            bfloat16_nodes_.count(NodeName(input)) > 0;
+        if (is_bfloat16 && !is_bfloat16_input) {
+          node->set_input(j, CastInput(input, DT_FLOAT, DT_BFLOAT16, *node));
+        } else if (!is_bfloat16 && is_bfloat16_input) {
+          node->set_input(j, CastInput(input, DT_BFLOAT16, DT_FLOAT, *node));
+        }
+      }
+
+      if (is_bfloat16) {
+        (*node->mutable_attr())["T"].set_type(DT_BFLOAT16);
+      }
+    }
+
+    return Status::OK();
+  }
+
+ private:
+  bool IsCandidate(const NodeDef& node) {
+    if (nodes_to_preserve_.count(node.name()) > 0) return false;
+    if (!IsOnCPU(node) || !HasFloatType(node)) return false;
+    if (AllowedOps().count(node.op()) == 0 &&
+        PropagatedOps().count(node.op()) == 0) {
+      return false;
+    }
+    return HasBFloat16Kernel(node);
+  }
+
+  // Check that the node can be executed on CPU in bfloat16 precision.
+  bool HasBFloat16Kernel(const NodeDef& node) {
+    auto it = has_bfloat16_kernel_.find(node.op());
+    if (it != has_bfloat16_kernel_.end()) return it->second;
+
+    NodeDef bfloat16_node = node;
+    (*bfloat16_node.mutable_attr())["T"].set_type(DT_BFLOAT16);
+    const bool has_kernel = FindKernelDef(DeviceType(DEVICE_CPU), bfloat16_node,
+                                          nullptr, nullptr)
+                                .ok();
+    has_bfloat16_kernel_.emplace(node.op(), has_kernel);
+    return has_kernel;
+  }
+
+  void FindBFloat16Nodes() {
+    std::vector<const NodeDef*> propagated;
+    for (const NodeDef& node : graph_->node()) {
+      if (!IsCandidate(node)) continue;
+      if (AllowedOps().count(node.op()) > 0) {
+        bfloat16_nodes_.insert(node.name());
+      } else {
+        propagated.push_back(&node);
+      }
+    }
+
+    // Propagate bfloat16 precision forward through data movement ops. Nodes are
+    // not necessarily topologically sorted, so iterate until a fixed point.
+    bool updated = true;
+    while (updated) {
+      updated = false;
+      for (const NodeDef* node : propagated) {
+        if (bfloat16_nodes_.count(node->name()) > 0) continue;
+        for (const string& input : node->input()) {
+          if (IsControlInput(input)) break;
+          if (bfloat16_nodes_.count(NodeName(input)) > 0) {
+            bfloat16_nodes_.insert(node->name());
+            updated = true;
+            break;
+          }
+        }
+      }
+    }
+  }
+
+  // Returns the name of a Cast node that converts the input tensor from
+  // src_type to dst_type. Cast nodes are shared between all consumers of the
+  // same tensor.
+  string CastInput(const string& input, DataType src_type, DataType dst_type,
+                   const NodeDef& consumer) {
+    int port;
+    const string node_name = ParseNodeName(input, &port);
+    const string tensor_name = strings::StrCat(node_name, ":", port);
+
+    auto& casts = dst_type == DT_BFLOAT16 ? casts_to_bfloat16_ : casts_to_float_;
+    auto it = casts.find(tensor_name);
+    if (it != casts.end()) return it->second;
+
+    NodeDef* cast = graph_->add_node();
+    cast->set_name(AddPrefixToNodeName(
+        strings::StrCat(node_name, "-", port, "-CastTo",
+                        DataTypeString(dst_type)),
+        kBFloat16Optimizer));
+    cast->set_op("Cast");
+    cast->set_device(consumer.device());
+    cast->add_input(input);
+    (*cast->mutable_attr())["SrcT"].set_type(src_type);
+    (*cast->mutable_attr())["DstT"].set_type(dst_type);
+
+    casts.emplace(tensor_name, cast->name());
+    return cast->name();
+  }
+
+  const std::unordered_set<string>& nodes_to_preserve_;
+  GraphDef* graph_;  // Not owned.
+
+  std::unordered_set<string> bfloat16_nodes_;
+  std::unordered_map<string, bool> has_bfloat16_kernel_;
+  std::unordered_map<string, string> casts_to_bfloat16_;
+  std::unordered_map<string, string> casts_to_float_;
+};
+
+}  // namespace
+
+Status BFloat16Optimizer::Optimize(Cluster* /*cluster*/,
+                                   const GrapplerItem& item,
+                                   GraphDef* optimized_graph) {
+  *optimized_graph = item.graph;
+  if (opt_level_ == RewriterConfig::OFF) return Status::OK();
+
+  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+  BFloat16Rewriter rewriter(nodes_to_preserve, optimized_graph);
+  return rewriter.Rewrite();
+}
+
+void BFloat16Optimizer::Feedback(Cluster* /*cluster*/,
+                                 const GrapplerItem& /*item*/,
+                                 const GraphDef& /*optimized_graph*/,
+                                 double /*result*/) {
+  // Nothing to do for BFloat16Optimizer.
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,56 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_BFLOAT16_OPTIMIZER_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_BFLOAT16_OPTIMIZER_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+#include "tensorflow/core/protobuf/rewriter_config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+constexpr char kBFloat16Optimizer[] = "BFloat16Optimizer";
+
+// Automatic mixed precision for CPU: rewrite float ops placed on CPU to
+// compute in bfloat16, and insert Cast nodes at the boundaries of the bfloat16
+// regions. Only MatMul and Conv2D, whose bfloat16 CPU kernels accumulate in
+// float, and the Identity ops that follow them are converted. Elementwise
+// arithmetic, reductions, normalizations and transcendental functions are
+// kept in float.
+class BFloat16Optimizer : public GraphOptimizer {
+ public:
+  BFloat16Optimizer() : opt_level_(RewriterConfig::ON) {}
+  explicit BFloat16Optimizer(RewriterConfig::Toggle opt_level)
+      : opt_level_(opt_level) {}
+
+  ~BFloat16Optimizer() override {}
+
+  string name() const override { return "bfloat16_optimizer"; };
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimized_graph, double result) override;
+
+ private:
+  RewriterConfig::Toggle opt_level_;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_BFLOAT16_OPTIMIZER_H_
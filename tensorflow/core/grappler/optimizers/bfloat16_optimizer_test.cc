@@ -0,0 +1,153 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/bfloat16_optimizer.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kDevice[] = "/job:localhost/replica:0/task:0/device:CPU:0";
+
+class BFloat16OptimizerTest : public GrapplerTest {};
+
+TEST_F(BFloat16OptimizerTest, MatMulBiasAddRelu) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(kDevice);
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT);
+  Output w = ops::Const(s.WithOpName("w"), 0.5f, {16, 8});
+  Output b = ops::Const(s.WithOpName("b"), 0.25f, {8});
+  Output matmul = ops::MatMul(s.WithOpName("matmul"), x, w);
+  Output bias_add = ops::BiasAdd(s.WithOpName("bias_add"), matmul, b);
+  Output relu = ops::Relu(s.WithOpName("relu"), bias_add);
+  Output axis = ops::Const(s.WithOpName("axis"), 1, {});
+  Output sum = ops::Sum(s.WithOpName("sum"), relu, axis);
+  Output fetch = ops::Identity(s.WithOpName("fetch"), sum);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  GraphDef output;
+  BFloat16Optimizer optimizer;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  int num_casts = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.op() == "Cast") num_casts++;
+
+    if (node.name() == "matmul") {
+      found++;
+      EXPECT_EQ(DT_BFLOAT16, node.attr().at("T").type());
+    } else if (node.name() == "bias_add") {
+      // Elementwise arithmetic is kept in float.
+      found++;
+      EXPECT_EQ(DT_FLOAT, node.attr().at("T").type());
+      EXPECT_EQ("BFloat16Optimizer/matmul-0-CastTofloat", node.input(0));
+      EXPECT_EQ("b", node.input(1));
+    } else if (node.name() == "relu" || node.name() == "sum" ||
+               node.name() == "fetch") {
+      found++;
+      EXPECT_EQ(DT_FLOAT, node.attr().at("T").type()) << node.name();
+    }
+  }
+  EXPECT_EQ(5, found);
+  // x and w are converted to bfloat16, matmul is converted back to float.
+  EXPECT_EQ(3, num_casts);
+
+  auto x_t = GenerateRandomTensor<DT_FLOAT>(TensorShape({4, 16}));
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, {{"x", x_t}});
+  auto tensors = EvaluateNodes(output, item.fetch, {{"x", x_t}});
+  ASSERT_EQ(1, tensors.size());
+  // The MatMul outputs are rounded to the 8 significant bits of bfloat16.
+  test::ExpectClose(tensors_expected[0], tensors[0], /*atol=*/1e-1,
+                    /*rtol=*/1e-2);
+}
+
+TEST_F(BFloat16OptimizerTest, PropagateThroughIdentity) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(kDevice);
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT);
+  Output w1 = ops::Const(s.WithOpName("w1"), 0.5f, {16, 16});
+  Output w2 = ops::Const(s.WithOpName("w2"), 0.25f, {16, 8});
+  Output matmul1 = ops::MatMul(s.WithOpName("matmul1"), x, w1);
+  Output identity = ops::Identity(s.WithOpName("identity"), matmul1);
+  Output matmul2 = ops::MatMul(s.WithOpName("matmul2"), identity, w2);
+  Output fetch = ops::Identity(s.WithOpName("fetch"), matmul2);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  GraphDef output;
+  BFloat16Optimizer optimizer;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  int num_casts = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.op() == "Cast") num_casts++;
+
+    if (node.name() == "matmul1" || node.name() == "identity" ||
+        node.name() == "matmul2") {
+      found++;
+      EXPECT_EQ(DT_BFLOAT16, node.attr().at("T").type()) << node.name();
+    } else if (node.name() == "fetch") {
+      found++;
+      EXPECT_EQ(DT_FLOAT, node.attr().at("T").type());
+      EXPECT_EQ("BFloat16Optimizer/matmul2-0-CastTofloat", node.input(0));
+    }
+  }
+  EXPECT_EQ(4, found);
+  // x, w1 and w2 are converted to bfloat16, matmul2 is converted back to
+  // float.
+  EXPECT_EQ(4, num_casts);
+
+  auto x_t = GenerateRandomTensor<DT_FLOAT>(TensorShape({4, 16}));
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, {{"x", x_t}});
+  auto tensors = EvaluateNodes(output, item.fetch, {{"x", x_t}});
+  ASSERT_EQ(1, tensors.size());
+  // The MatMul outputs are rounded to the 8 significant bits of bfloat16.
+  test::ExpectClose(tensors_expected[0], tensors[0], /*atol=*/1e-1,
+                    /*rtol=*/1e-2);
+}
+
+TEST_F(BFloat16OptimizerTest, SkipNodesNotPlacedOnCPU) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT);
+  Output w = ops::Const(s.WithOpName("w"), 0.5f, {16, 8});
+  Output matmul = ops::MatMul(s.WithOpName("matmul"), x, w);
+  Output fetch = ops::Identity(s.WithOpName("fetch"), matmul);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  GraphDef output;
+  BFloat16Optimizer optimizer;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  CompareGraphs(item.graph, output);
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
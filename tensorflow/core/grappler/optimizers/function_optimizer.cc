@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/function_optimizer.h"
 
+#include <map>
+#include <set>
 #include <unordered_map>
 
 #include "tensorflow/core/common_runtime/device_mgr.h"
@@ -138,6 +140,73 @@ struct FunctionSpecializationSignature {
   };
 };
 
+// Function call node signature: called function, node attributes, device and
+// inputs. Two stateless function calls with identical signatures compute the
+// same outputs, and can be deduplicated.
+struct FunctionCallSignature {
+  string func_name;
+  string device;
+  std::vector<string> regular_inputs;
+  std::set<string> control_inputs;
+  std::map<string, AttrValue> attr;
+
+  bool operator==(const FunctionCallSignature& other) const {
+    bool equals = func_name == other.func_name && device == other.device &&
+                  regular_inputs == other.regular_inputs &&
+                  control_inputs == other.control_inputs;
+
+    if (!equals) return false;
+
+    // Equality is not defined for AttrValue.
+    if (attr.size() != other.attr.size()) return false;
+
+    for (const auto& lhs : attr) {
+      auto it = other.attr.find(lhs.first);
+      if (it == other.attr.end()) return false;
+      if (!FastAreAttrValuesEqual(lhs.second, (*it).second)) return false;
+    }
+
+    return true;
+  }
+
+  struct Hash {
+    uint64 operator()(FunctionCallSignature const& s) const {
+      uint64 h = Hash64(s.func_name);
+      h = Hash64Combine(Hash64(s.device), h);
+
+      for (const string& input : s.regular_inputs) {
+        h = Hash64Combine(Hash64(input), h);
+      }
+      for (const string& input : s.control_inputs) {
+        h = Hash64Combine(Hash64(input), h);
+      }
+      for (const auto& pair : s.attr) {
+        h = Hash64Combine(Hash64(pair.first), h);
+        h = Hash64Combine(FastAttrValueHash(pair.second), h);
+      }
+
+      return h;
+    }
+  };
+};
+
+FunctionCallSignature MakeFunctionCallSignature(const NodeDef& func_node) {
+  FunctionCallSignature sig;
+  sig.func_name = func_node.op();
+  sig.device = func_node.device();
+  for (const string& input : func_node.input()) {
+    if (IsControlInput(input)) {
+      sig.control_inputs.insert(input);
+    } else {
+      sig.regular_inputs.push_back(input);
+    }
+  }
+  for (const auto& attr : func_node.attr()) {
+    sig.attr.emplace(attr.first, attr.second);
+  }
+  return sig;
+}
+
 struct FunctionSpecialization {
   string specialized_func_name;
   std::unordered_set<string> const_inputs;
@@ -156,6 +225,7 @@ class FunctionOptimizerContext {
                                     const GrapplerItem& item)
       : graph_version_(item.graph.versions().producer()),
         function_library_(OpRegistry::Global(), item.graph.library()) {
+    InitializeFeedNodes(item);
     InitializeTrulyConstNodes(item);
     InitializeInlinedFunctions(opt_level, item);
   }
@@ -177,6 +247,10 @@ class FunctionOptimizerContext {
     return inlined_functions_.count(name) > 0;
   }
 
+  bool IsFeedNode(const string& name) const {
+    return feed_nodes_.count(name) > 0;
+  }
+
   bool IsTrulyConst(const string& name) const {
     return TrulyConstNode(name) != nullptr;
   }
@@ -200,15 +274,61 @@ class FunctionOptimizerContext {
     specialized_functions_.emplace(sig, specialized_func);
   }
 
+  // Find the name of a previously seen function call node with identical
+  // signature. Return nullptr if not found.
+  const string* FindFunctionCall(const FunctionCallSignature& sig) const {
+    return gtl::FindOrNull(function_calls_, sig);
+  }
+
+  void AddFunctionCall(const FunctionCallSignature& sig,
+                       const string& func_node_name) {
+    function_calls_.emplace(sig, func_node_name);
+  }
+
+  // Check if the function and all functions called from its body are free of
+  // side effects, so that two calls with identical inputs are interchangeable.
+  bool IsStatelessFunction(const string& name) {
+    auto it = stateless_functions_.find(name);
+    if (it != stateless_functions_.end()) return it->second;
+
+    // Conservatively treat recursive function calls as stateful.
+    stateless_functions_[name] = false;
+
+    const FunctionDef* func = function_library_.Find(name);
+    bool is_stateless = func != nullptr && !func->signature().is_stateful();
+
+    for (int i = 0; is_stateless && i < func->node_def_size(); ++i) {
+      const NodeDef& node = func->node_def(i);
+
+      // Functions passed as attributes (e.g. to functional control flow ops)
+      // are not analyzed.
+      for (const auto& attr : node.attr()) {
+        if (attr.second.has_func() ||
+            (attr.second.has_list() && attr.second.list().func_size() > 0)) {
+          is_stateless = false;
+        }
+      }
+
+      if (!is_stateless) break;
+      is_stateless = function_library_.Find(node.op()) != nullptr
+                         ? IsStatelessFunction(node.op())
+                         : IsFreeOfSideEffect(node);
+    }
+
+    stateless_functions_[name] = is_stateless;
+    return is_stateless;
+  }
+
  private:
-  void InitializeTrulyConstNodes(const GrapplerItem& item) {
-    std::unordered_set<string> feed_nodes;
+  void InitializeFeedNodes(const GrapplerItem& item) {
     for (const auto& feed : item.feed) {
-      feed_nodes.insert(NodeName(feed.first));
+      feed_nodes_.insert(NodeName(feed.first));
     }
+  }
 
+  void InitializeTrulyConstNodes(const GrapplerItem& item) {
     for (const NodeDef& node : item.graph.node()) {
-      if (IsConstant(node) && feed_nodes.count(node.name()) == 0) {
+      if (IsConstant(node) && feed_nodes_.count(node.name()) == 0) {
         truly_const_nodes_[node.name()] = &node;
       }
     }
@@ -261,6 +381,8 @@ class FunctionOptimizerContext {
 
   // Functions that can be inlined into optimized graph.
   std::unordered_map<string, const FunctionDef*> inlined_functions_;
+  // Nodes that are in feed.
+  std::unordered_set<string> feed_nodes_;
   // Nodes that are Const and not in feed.
   std::unordered_map<string, const NodeDef*> truly_const_nodes_;
   // Specialized functions.
@@ -268,6 +390,12 @@ class FunctionOptimizerContext {
                      const FunctionSpecialization,
                      FunctionSpecializationSignature::Hash>
       specialized_functions_;
+  // Function call nodes that were already added to the optimized graph.
+  std::unordered_map<FunctionCallSignature, const string,
+                     FunctionCallSignature::Hash>
+      function_calls_;
+  // Memoized results of the function side effects analysis.
+  std::unordered_map<string, bool> stateless_functions_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(FunctionOptimizerContext);
 };
@@ -532,6 +660,54 @@ Status SpecializeFunction(const NodeDef& func_node, const FunctionDef& func,
   return Status::OK();
 }
 
+// Check if the function call node can be replaced with the outputs of another
+// call node with identical signature.
+bool IsDedupableFunctionCall(const NodeDef& func_node,
+                             FunctionOptimizerContext* ctx) {
+  // Feeding the function call node overrides its outputs.
+  if (ctx->IsFeedNode(func_node.name())) return false;
+  return ctx->IsStatelessFunction(func_node.op());
+}
+
+// Replace a function call node with an IdentityN node that forwards the
+// outputs of the identical function call node that is already in the graph.
+// Consumers of the deduplicated node outputs remain valid, and the function
+// body is instantiated (or inlined) only once.
+Status DedupFunctionCall(const NodeDef& func_node, const string& first_call,
+                         const FunctionOptimizerContext& ctx,
+                         GraphDef* optimized_graph) {
+  VLOG(2) << "Dedup function call: " << SummarizeNodeDef(func_node)
+          << " representative=" << first_call;
+
+  const OpDef* op_def = nullptr;
+  TF_RETURN_IF_ERROR(
+      ctx.function_library().LookUpOpDef(func_node.op(), &op_def));
+
+  DataTypeVector output_types;
+  TF_RETURN_IF_ERROR(OutputTypesForNode(func_node, *op_def, &output_types));
+
+  // Can't create IdentityN nodes with no outputs.
+  if (output_types.empty()) {
+    return errors::InvalidArgument("Function ", func_node.op(),
+                                   " instantiated by ", func_node.name(),
+                                   " has no outputs");
+  }
+
+  NodeDef* outputs = optimized_graph->add_node();
+  outputs->set_name(func_node.name());
+  outputs->set_op("IdentityN");
+  outputs->set_device(func_node.device());
+  AttrValue::ListValue* type_list =
+      (*outputs->mutable_attr())["T"].mutable_list();
+
+  for (int i = 0; i < output_types.size(); ++i) {
+    type_list->add_type(output_types[i]);
+    outputs->add_input(strings::StrCat(first_call, ":", i));
+  }
+
+  return Status::OK();
+}
+
 // Create an IdentityN node to hook the function inputs to: this ensures that
 // they're all evaluated before the evaluation of the function body starts.
 NodeDef InlinedFunctionInputsNode(const NodeDef& func_node,
@@ -774,6 +950,7 @@ Status FunctionOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
   bool inline_gradients = options_.enable_symbolic_gradient_inlining;
   bool inline_func = options_.enable_function_inlining;
   bool specialize_func = options_.enable_function_specialization;
+  bool dedup_func_calls = options_.enable_function_call_dedup;
 
   for (const NodeDef& node : item.graph.node()) {
     const string func_name = node.op();
@@ -817,7 +994,19 @@ Status FunctionOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
     // 2. Check if a node op is a function call.
     const FunctionDef* func = ctx.function_library().Find(func_name);
     if (func != nullptr) {
-      // 2a. Inline it if it's allowed to do so.
+      // 2a. Forward outputs of an identical function call if it's stateless.
+      if (dedup_func_calls && IsDedupableFunctionCall(node, &ctx)) {
+        const FunctionCallSignature sig = MakeFunctionCallSignature(node);
+        const string* first_call = ctx.FindFunctionCall(sig);
+        if (first_call != nullptr) {
+          TF_SKIP_ERROR_IF_GRAPH_UNMODIFIED(
+              DedupFunctionCall(node, *first_call, ctx, optimized_graph));
+          continue;
+        }
+        ctx.AddFunctionCall(sig, node.name());
+      }
+
+      // 2b. Inline it if it's allowed to do so.
       if (inline_func && ctx.IsInlinedFunction(func_name)) {
         // Inline function body into the optimized graph}
         TF_SKIP_ERROR_IF_GRAPH_UNMODIFIED(
@@ -828,7 +1017,7 @@ Status FunctionOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
       // Do not specialize if function has custom gradient.
       const string grad_func = ctx.function_library().FindGradient(func_name);
 
-      // 2b. Specialize it to it's instantiation context if can't be inlined.
+      // 2c. Specialize it to it's instantiation context if can't be inlined.
       if (specialize_func && grad_func.empty() &&
           (IsParametrized(*func) || HasTrulyConstInputs(node, ctx))) {
         // TODO(ezhulenev): Specialize function call if input has a known shape.
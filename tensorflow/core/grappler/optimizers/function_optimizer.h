@@ -46,6 +46,7 @@ class FunctionOptimizer : public GraphOptimizer {
     bool enable_function_specialization = true;
     bool enable_symbolic_gradient_inlining = true;
     bool enable_trim_function_library = true;
+    bool enable_function_call_dedup = true;
   };
 
   RewriterConfig::Toggle opt_level_;
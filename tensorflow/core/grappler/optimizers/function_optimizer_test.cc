@@ -911,6 +911,109 @@ TEST_F(FunctionOptimizerTest, SpecializeFunction_OncePerUniqueContext) {
   test::ExpectTensorEqual<float>(tensors_expected[5], tensors[5]);
 }
 
+TEST_F(FunctionOptimizerTest, DedupFunctionCall_InlinedFunction) {
+  using test::function::NDef;
+
+  FunctionOptimizer optimizer(RewriterConfig::DEFAULT);
+
+  // Build a graph to compute z = XTimesTwo(x) + XTimesTwo(x).
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("x", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice),
+       NDef("y1", "XTimesTwo", {"x"}, {{"T", DT_FLOAT}}, kDevice),
+       NDef("y2", "XTimesTwo", {"x"}, {{"T", DT_FLOAT}}, kDevice),
+       NDef("z", "Add", {"y1", "y2"}, {{"T", DT_FLOAT}}, kDevice)},
+      // FunctionLib
+      {
+          test::function::XTimesTwo(),
+      });
+
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // Function body must be inlined only once.
+  int count = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE("y2/inlined_inputs", node.name());
+    EXPECT_NE("y2/y", node.name());
+
+    if (node.name() == "y1/y") {
+      count++;
+      EXPECT_EQ("Mul", node.op());
+    } else if (node.name() == "y2") {
+      count++;
+      EXPECT_EQ("IdentityN", node.op());
+      EXPECT_EQ(kDevice, node.device());
+      ASSERT_EQ(1, node.input_size());
+      EXPECT_EQ("y1:0", node.input(0));
+    }
+  }
+  EXPECT_EQ(2, count);
+
+  Tensor pi = test::AsScalar<float>(3.14f);
+  item.fetch = {"z"};
+  item.feed.emplace_back("x", pi);
+  auto tensors_expected = EvaluateFetchNodes(item);
+  GrapplerItem optimized(item, std::move(output));
+  auto tensors = EvaluateFetchNodes(optimized);
+  test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
+}
+
+TEST_F(FunctionOptimizerTest, DedupFunctionCall_SpecializedFunction) {
+  using test::function::NDef;
+
+  FunctionOptimizer optimizer(RewriterConfig::DEFAULT);
+
+  // Mark XTimesTwo as noinline.
+  FunctionDef x_times_two = test::function::XTimesTwo();
+  (*x_times_two.mutable_attr())["_noinline"].set_b(true);
+  std::vector<FunctionDef> function_library = {x_times_two};
+
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("x", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice),
+       NDef("w", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice),
+       NDef("init", "NoOp", {}, {}, kDevice),
+       NDef("y1", "XTimesTwo", {"x", "^init"}, {{"T", DT_FLOAT}}, kDevice),
+       NDef("y2", "XTimesTwo", {"x", "^init"}, {{"T", DT_FLOAT}}, kDevice),
+       // Different control dependencies: can't dedup.
+       NDef("y3", "XTimesTwo", {"x"}, {{"T", DT_FLOAT}}, kDevice),
+       // Different inputs: can't dedup.
+       NDef("y4", "XTimesTwo", {"w", "^init"}, {{"T", DT_FLOAT}}, kDevice)},
+      function_library);
+
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int count = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "y1" && ++count) {
+      EXPECT_EQ("XTimesTwo_specialized_for_y1", node.op());
+    } else if (node.name() == "y2" && ++count) {
+      EXPECT_EQ("IdentityN", node.op());
+      ASSERT_EQ(1, node.input_size());
+      EXPECT_EQ("y1:0", node.input(0));
+    } else if (node.name() == "y3" && ++count) {
+      EXPECT_EQ("XTimesTwo_specialized_for_y1", node.op());
+    } else if (node.name() == "y4" && ++count) {
+      EXPECT_EQ("XTimesTwo_specialized_for_y1", node.op());
+    }
+  }
+  EXPECT_EQ(4, count);
+
+  Tensor pi = test::AsScalar<float>(3.14f);
+  Tensor two = test::AsScalar<float>(2.0f);
+  item.fetch = {"y1", "y2", "y3", "y4"};
+  item.feed = {{"x", pi}, {"w", two}};
+
+  auto tensors_expected = EvaluateFetchNodes(item);
+  GrapplerItem optimized(item, std::move(output));
+  auto tensors = EvaluateFetchNodes(optimized);
+  for (int i = 0; i < 4; ++i) {
+    test::ExpectTensorEqual<float>(tensors_expected[i], tensors[i]);
+  }
+}
+
 TEST_F(FunctionOptimizerTest, PruningUselessLibraryFunctions) {
   using test::function::NDef;
   FunctionOptimizer optimizer(RewriterConfig::DEFAULT);
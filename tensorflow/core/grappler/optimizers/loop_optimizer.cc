@@ -53,13 +53,16 @@ class LoopInvariantNodeMotionOptimizer {
   Status Optimize();
 
  private:
+  NodeDef* FindPassThroughIdentity(const NodeDef& enter) const;
+  bool IsInvariantSource(const NodeDef& node) const;
   Status FindInvariantNodes(NodeDef* node);
   Status RevertInvariantNodes();
   Status MoveInvariantNodes(const int frame_id);
   Status HandleInvariantNode(NodeDef* node, const int num_outputs,
                              const int frame_id);
   Status HandleConst(NodeDef* node, const int num_outputs, const int frame_id);
-  Status HandleInvariantEnter(NodeDef* node, const int num_outputs);
+  Status HandleInvariantEnter(NodeDef* node, const NodeDef& enter,
+                              const int num_outputs);
 
   GraphDef* optimized_graph_;  // Not owned.
   std::unique_ptr<NodeMap> node_map_;
@@ -70,15 +73,61 @@ class LoopInvariantNodeMotionOptimizer {
   std::map<int, int> frame_parent_;
   std::map<int, const NodeDef*> loop_cond_;
   std::map<int, std::vector<NodeDef*>> invariant_enters_;
+  // Identity nodes reading loop variables that are forwarded unmodified to the
+  // next iteration, and the Enter nodes of these loop variables.
+  std::map<int, std::vector<NodeDef*>> invariant_identities_;
+  std::map<const NodeDef*, const NodeDef*> identity_enters_;
   int new_enter_id_;
 };
 
+// Loop variables that are passed to the NextIteration node unmodified have the
+// same value in every iteration, e.g. the Identity node in:
+//   Enter -> Merge -> Switch:1 -> Identity -> NextIteration -> Merge
+// Returns the Identity node of such a loop variable, or nullptr.
+NodeDef* LoopInvariantNodeMotionOptimizer::FindPassThroughIdentity(
+    const NodeDef& enter) const {
+  for (NodeDef* merge : node_map_->GetOutputs(enter.name())) {
+    if (!IsMerge(*merge) || merge->input_size() != 2) continue;
+
+    const NodeDef* next_iteration = nullptr;
+    for (const string& input : merge->input()) {
+      const NodeDef* producer = node_map_->GetNode(input);
+      if (producer != nullptr && IsNextIteration(*producer)) {
+        next_iteration = producer;
+      }
+    }
+    if (next_iteration == nullptr || next_iteration->input_size() == 0) {
+      continue;
+    }
+
+    NodeDef* identity = node_map_->GetNode(next_iteration->input(0));
+    if (identity == nullptr || identity->op() != "Identity" ||
+        identity->input_size() == 0) {
+      continue;
+    }
+
+    int port;
+    const string switch_name = ParseNodeName(identity->input(0), &port);
+    const NodeDef* switch_node = node_map_->GetNode(switch_name);
+    if (switch_node != nullptr && IsSwitch(*switch_node) && port == 1 &&
+        NodeName(switch_node->input(0)) == merge->name()) {
+      return identity;
+    }
+  }
+  return nullptr;
+}
+
+bool LoopInvariantNodeMotionOptimizer::IsInvariantSource(
+    const NodeDef& node) const {
+  return IsEnter(node) || identity_enters_.count(&node) > 0;
+}
+
 Status LoopInvariantNodeMotionOptimizer::HandleInvariantEnter(
-    NodeDef* node, const int num_outputs) {
+    NodeDef* node, const NodeDef& enter, const int num_outputs) {
   auto consumers = node_map_->GetOutputs(node->name());
   std::vector<string> enter_control_inputs;
   string enter_input;
-  for (auto& input : node->input()) {
+  for (auto& input : enter.input()) {
     if (IsControlInput(input)) {
       enter_control_inputs.push_back(input);
     } else {
@@ -89,7 +138,11 @@ Status LoopInvariantNodeMotionOptimizer::HandleInvariantEnter(
     if (invariant_nodes_.count(consumer)) {
       for (int i = 0; i < consumer->input_size(); ++i) {
         if (NodeName(consumer->input(i)) == node->name()) {
-          consumer->set_input(i, enter_input);
+          if (IsControlInput(consumer->input(i))) {
+            consumer->set_input(i, AsControlDependency(NodeName(enter_input)));
+          } else {
+            consumer->set_input(i, enter_input);
+          }
           node_map_->AddOutput(NodeName(enter_input), consumer->name());
           node_map_->RemoveOutput(node->name(), consumer->name());
         }
@@ -199,9 +252,12 @@ Status LoopInvariantNodeMotionOptimizer::HandleInvariantNode(
                                        &output_types));
 
   auto consumers = node_map_->GetOutputs(node->name());
-  string fname = invariant_enters_[frame_id][0]->attr().at("frame_name").s();
-  int piterations =
-      invariant_enters_[frame_id][0]->attr().at("parallel_iterations").i();
+  const NodeDef* frame_enter =
+      invariant_enters_[frame_id].empty()
+          ? identity_enters_.at(invariant_identities_[frame_id][0])
+          : invariant_enters_[frame_id][0];
+  string fname = frame_enter->attr().at("frame_name").s();
+  int piterations = frame_enter->attr().at("parallel_iterations").i();
   for (auto* consumer : consumers) {
     if (!invariant_nodes_.count(consumer)) {
       for (int i = 0; i < consumer->input_size(); ++i) {
@@ -252,7 +308,12 @@ Status LoopInvariantNodeMotionOptimizer::MoveInvariantNodes(
     auto* invariant_node = iter->first;
     const int num_outputs = iter->second;
     if (IsEnter(*invariant_node)) {
-      TF_RETURN_IF_ERROR(HandleInvariantEnter(invariant_node, num_outputs));
+      TF_RETURN_IF_ERROR(
+          HandleInvariantEnter(invariant_node, *invariant_node, num_outputs));
+    } else if (IsInvariantSource(*invariant_node)) {
+      const NodeDef* enter = identity_enters_.at(invariant_node);
+      TF_RETURN_IF_ERROR(
+          HandleInvariantEnter(invariant_node, *enter, num_outputs));
     } else if (IsConstant(*invariant_node)) {
       TF_RETURN_IF_ERROR(HandleConst(invariant_node, num_outputs, frame_id));
     } else {
@@ -268,7 +329,7 @@ Status LoopInvariantNodeMotionOptimizer::RevertInvariantNodes() {
   for (auto iter = invariant_nodes_.begin(); iter != invariant_nodes_.end();) {
     bool erased = false;
     const auto* node = iter->first;
-    if (!IsConstant(*node) && !IsEnter(*node) && iter->second > 0) {
+    if (!IsConstant(*node) && !IsInvariantSource(*node) && iter->second > 0) {
       auto& consumers = node_map_->GetOutputs(node->name());
       for (auto* consumer : consumers) {
         if (!invariant_nodes_.count(consumer)) {
@@ -295,7 +356,7 @@ Status LoopInvariantNodeMotionOptimizer::RevertInvariantNodes() {
       auto iter = invariant_nodes_.find(producer);
       if (iter != invariant_nodes_.end()) {
         if (IsControlInput(input) && !IsConstant(*producer) &&
-            !IsEnter(*producer)) {
+            !IsInvariantSource(*producer)) {
           reverted_nodes.push_back(producer);
           invariant_nodes_.erase(iter);
         } else {
@@ -334,6 +395,10 @@ Status LoopInvariantNodeMotionOptimizer::FindInvariantNodes(
       if (invariant_nodes_.count(consumer) || ModifiesFrameInfo(*consumer)) {
         continue;
       }
+      // Nodes with side effects must be executed in every iteration.
+      if (!IsFreeOfSideEffect(*consumer)) {
+        continue;
+      }
       bool is_invariant = true;
       for (const auto& input : consumer->input()) {
         if (!IsControlInput(input)) {
@@ -403,6 +468,12 @@ Status LoopInvariantNodeMotionOptimizer::Optimize() {
       if (IsEnter(*node) && node->attr().at("is_constant").b()) {
         invariant_enters_[frame_ids.back()].push_back(
             const_cast<NodeDef*>(node));
+      } else if (IsEnter(*node)) {
+        NodeDef* identity = FindPassThroughIdentity(*node);
+        if (identity != nullptr) {
+          invariant_identities_[frame_ids.back()].push_back(identity);
+          identity_enters_[identity] = node;
+        }
       }
     }
   }
@@ -426,13 +497,17 @@ Status LoopInvariantNodeMotionOptimizer::Optimize() {
       }
     }
 
-    if (invariant_enters_[frame_id].empty()) {
+    if (invariant_enters_[frame_id].empty() &&
+        invariant_identities_[frame_id].empty()) {
       continue;
     }
     invariant_nodes_.clear();
     for (auto* enter : invariant_enters_[frame_id]) {
       TF_RETURN_IF_ERROR(FindInvariantNodes(enter));
     }
+    for (auto* identity : invariant_identities_[frame_id]) {
+      TF_RETURN_IF_ERROR(FindInvariantNodes(identity));
+    }
 
     // revert invariant nodes that have control outputs to variant nodes
     TF_RETURN_IF_ERROR(RevertInvariantNodes());
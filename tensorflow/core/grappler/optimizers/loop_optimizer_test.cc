@@ -216,6 +216,108 @@ TEST_F(LoopOptimizerTest, ControlOutput) {
   EXPECT_EQ(frames.at(node_map->GetNode("InvariantAdd")).back(), 0);
 }
 
+TEST_F(LoopOptimizerTest, PassThroughLoopVariable) {
+  GraphDef graph;
+  AddSimpleNode("In", "Identity", {}, &graph);
+  // Loop counter, modified in every iteration.
+  AddEnterNode("CounterEnter", "while/while_context", false, 1, {"In"},
+               &graph);
+  AddSimpleNode("CounterMerge", "Merge", {"CounterEnter", "CounterNext"},
+                &graph);
+  AddSimpleNode("Less/y", "Const", {"^CounterIdentity"}, &graph);
+  AddSimpleNode("Less", "Less", {"CounterMerge", "Less/y"}, &graph);
+  AddSimpleNode("LoopCond", "LoopCond", {"Less"}, &graph);
+  AddSimpleNode("CounterSwitch", "Switch", {"CounterMerge", "LoopCond"},
+                &graph);
+  AddSimpleNode("CounterIdentity", "Identity", {"CounterSwitch:1"}, &graph);
+  AddSimpleNode("CounterNext", "NextIteration", {"VariantAdd"}, &graph);
+  AddSimpleNode("CounterExit", "Exit", {"CounterSwitch"}, &graph);
+  // Loop variable passed to the next iteration unmodified.
+  AddEnterNode("PassEnter", "while/while_context", false, 1, {"In"}, &graph);
+  AddSimpleNode("PassMerge", "Merge", {"PassEnter", "PassNext"}, &graph);
+  AddSimpleNode("PassSwitch", "Switch", {"PassMerge", "LoopCond"}, &graph);
+  AddSimpleNode("PassIdentity", "Identity", {"PassSwitch:1"}, &graph);
+  AddSimpleNode("PassNext", "NextIteration", {"PassIdentity"}, &graph);
+  AddSimpleNode("PassExit", "Exit", {"PassSwitch"}, &graph);
+  // Loop body.
+  AddSimpleNode("InvariantMul", "Mul", {"PassIdentity", "PassIdentity"},
+                &graph);
+  AddSimpleNode("VariantAdd", "Add", {"InvariantMul", "CounterIdentity"},
+                &graph);
+  AddSimpleNode("Out", "Identity", {"CounterExit"}, &graph);
+
+  GrapplerItem item;
+  item.graph = graph;
+
+  LoopOptimizer optimizer;
+  EnableOnlyLoopInvariantNodeMotion(&optimizer);
+  GraphDef output;
+  Status status = optimizer.Optimize(nullptr, item, &output);
+  TF_EXPECT_OK(status);
+
+  std::unique_ptr<NodeMap> node_map;
+  std::unordered_map<const NodeDef*, std::vector<int>> frames;
+  int num_frames;
+
+  node_map.reset(new NodeMap(&graph));
+  EXPECT_TRUE(IdentifyFrames(graph, &frames, &num_frames).ok());
+  EXPECT_EQ(num_frames, 1);
+  EXPECT_EQ(frames.at(node_map->GetNode("InvariantMul")).size(), 1);
+  EXPECT_EQ(frames.at(node_map->GetNode("InvariantMul")).back(), 0);
+
+  node_map.reset(new NodeMap(&output));
+  EXPECT_TRUE(IdentifyFrames(output, &frames, &num_frames).ok());
+  EXPECT_EQ(num_frames, 1);
+  EXPECT_EQ(frames.at(node_map->GetNode("InvariantMul")).size(), 0);
+  EXPECT_EQ(frames.at(node_map->GetNode("PassIdentity")).size(), 1);
+  EXPECT_EQ(frames.at(node_map->GetNode("VariantAdd")).size(), 1);
+  EXPECT_EQ(frames.at(node_map->GetNode("VariantAdd")).back(), 0);
+
+  const NodeDef* invariant_mul = node_map->GetNode("InvariantMul");
+  ASSERT_EQ(2, invariant_mul->input_size());
+  EXPECT_EQ("In", invariant_mul->input(0));
+  EXPECT_EQ("In", invariant_mul->input(1));
+}
+
+TEST_F(LoopOptimizerTest, StatefulNode) {
+  GraphDef graph;
+  AddSimpleNode("In", "Identity", {}, &graph);
+  AddEnterNode("InvariantEnter", "while/while_context", true, 1, {"In"},
+               &graph);
+  AddSimpleNode("Random", "RandomUniform", {"InvariantEnter"}, &graph);
+  AddSimpleNode("VariantAdd", "Add", {"Random", "Identity"}, &graph);
+  AddEnterNode("VariantEnter", "while/while_context", false, 1, {"In"}, &graph);
+  AddSimpleNode("Merge", "Merge", {"VariantEnter", "NextIteration"}, &graph);
+  AddSimpleNode("Less/y", "Const", {"^Identity"}, &graph);
+  AddSimpleNode("Less", "Less", {"VariantAdd", "Less/y"}, &graph);
+  AddSimpleNode("LoopCond", "LoopCond", {"Less"}, &graph);
+  AddSimpleNode("Switch", "Switch", {"Merge", "LoopCond"}, &graph);
+  AddSimpleNode("Identity", "Identity", {"Switch:1"}, &graph);
+  AddSimpleNode("NextIteration", "NextIteration", {"VariantAdd"}, &graph);
+  AddSimpleNode("Exit", "Exit", {"Switch"}, &graph);
+  AddSimpleNode("Out", "Identity", {"Exit"}, &graph);
+
+  GrapplerItem item;
+  item.graph = graph;
+
+  LoopOptimizer optimizer;
+  EnableOnlyLoopInvariantNodeMotion(&optimizer);
+  GraphDef output;
+  Status status = optimizer.Optimize(nullptr, item, &output);
+  TF_EXPECT_OK(status);
+
+  std::unique_ptr<NodeMap> node_map;
+  std::unordered_map<const NodeDef*, std::vector<int>> frames;
+  int num_frames;
+
+  // Random number generator must be evaluated in every iteration.
+  node_map.reset(new NodeMap(&output));
+  EXPECT_TRUE(IdentifyFrames(output, &frames, &num_frames).ok());
+  EXPECT_EQ(num_frames, 1);
+  EXPECT_EQ(frames.at(node_map->GetNode("Random")).size(), 1);
+  EXPECT_EQ(frames.at(node_map->GetNode("Random")).back(), 0);
+}
+
 TEST_F(LoopOptimizerTest, NestedLoop1) {
   GraphDef graph;
   AddSimpleNode("In", "Identity", {}, &graph);
@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/grappler/optimizers/arithmetic_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/auto_parallel.h"
+#include "tensorflow/core/grappler/optimizers/bfloat16_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/constant_folding.h"
 #include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
 #include "tensorflow/core/grappler/optimizers/debug_stripper.h"
@@ -28,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/loop_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/model_pruner.h"
+#include "tensorflow/core/grappler/optimizers/quantization_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/remapper.h"
 #include "tensorflow/core/grappler/optimizers/scoped_allocator_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/shape_optimizer.h"
@@ -67,7 +69,8 @@ int NumIterations(const RewriterConfig& cfg) {
 // Check if optimizer is allowed to run only once.
 bool IsRunOnceOptimizer(const string& name) {
   return name == "layout" || name == "memory_optimizer" ||
-         name == "loop_optimizer";
+         name == "loop_optimizer" || name == "bfloat16_optimizer" ||
+         name == "quantization_optimizer";
 }
 
 }  // namespace
@@ -89,6 +92,8 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
   MK_OPT("loop", new LoopOptimizer(cfg_.loop_optimization()));
   MK_OPT("dependency", new DependencyOptimizer(cfg_.dependency_optimization()));
   MK_OPT("debug_stripper", new DebugStripper());
+  MK_OPT("bfloat16", new BFloat16Optimizer(RewriterConfig::ON));
+  MK_OPT("quantization", new QuantizationOptimizer(RewriterConfig::ON));
   MK_OPT("scoped_allocator",
          new ScopedAllocatorOptimizer(cfg_.scoped_allocator_opts()));
 
@@ -106,6 +111,10 @@ Status MetaOptimizer::InitializeOptimizers(
     optimizers->emplace_back(
         new FunctionOptimizer(cfg_.function_optimization()));
   }
+  if (cfg_.quantization_optimization() == RewriterConfig::ON) {
+    optimizers->emplace_back(
+        new QuantizationOptimizer(cfg_.quantization_optimization()));
+  }
   if (cfg_.debug_stripper() == RewriterConfig::ON) {
     optimizers->emplace_back(new DebugStripper());
   }
@@ -130,6 +139,10 @@ Status MetaOptimizer::InitializeOptimizers(
     optimizers->emplace_back(
         new DependencyOptimizer(cfg_.dependency_optimization()));
   }
+  if (cfg_.bfloat16_optimization() == RewriterConfig::ON) {
+    optimizers->emplace_back(
+        new BFloat16Optimizer(cfg_.bfloat16_optimization()));
+  }
   if (cfg_.layout_optimizer() != RewriterConfig::OFF) {
     optimizers->emplace_back(new LayoutOptimizer());
   }
@@ -406,6 +419,8 @@ bool MetaOptimizerEnabled(const RewriterConfig& cfg) {
          cfg.auto_parallel().enable() ||
          cfg.memory_optimization() != RewriterConfig::NO_MEM_OPT ||
          cfg.debug_stripper() == RewriterConfig::ON ||
+         cfg.bfloat16_optimization() == RewriterConfig::ON ||
+         cfg.quantization_optimization() == RewriterConfig::ON ||
          cfg.scoped_allocator_optimization() == RewriterConfig::ON ||
          !cfg.optimizers().empty() || !cfg.custom_optimizers().empty();
 }
@@ -0,0 +1,217 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/quantization_optimizer.h"
+
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kDefaultQuantizationMode[] = "MIN_COMBINED";
+
+bool IsSameTensor(const string& input1, const string& input2) {
+  int port1;
+  int port2;
+  const string node1 = ParseNodeName(input1, &port1);
+  const string node2 = ParseNodeName(input2, &port2);
+  return node1 == node2 && port1 == port2;
+}
+
+string GetQuantizationMode(const NodeDef& node) {
+  const auto it = node.attr().find("mode");
+  return it == node.attr().end() ? kDefaultQuantizationMode : it->second.s();
+}
+
+void DeleteNodes(const std::set<int>& nodes_to_delete, GraphDef* graph) {
+  int last = graph->node_size() - 1;
+  for (auto it = nodes_to_delete.rbegin(); it != nodes_to_delete.rend(); ++it) {
+    const int index = *it;
+    graph->mutable_node()->SwapElements(index, last);
+    last--;
+  }
+  graph->mutable_node()->DeleteSubrange(last + 1, nodes_to_delete.size());
+}
+
+class QuantizationRewriter {
+ public:
+  QuantizationRewriter(const std::unordered_set<string>& nodes_to_preserve,
+                       GraphDef* graph)
+      : nodes_to_preserve_(nodes_to_preserve),
+        graph_(graph),
+        node_map_(graph) {}
+
+  Status Rewrite() {
+    std::vector<NodeDef*> rewired;
+    for (int i = 0; i < graph_->node_size(); ++i) {
+      NodeDef* node = graph_->mutable_node(i);
+      if (node->op() != "QuantizeV2") continue;
+      const NodeDef* dequantize = FindRedundantDequantize(*node);
+      if (dequantize == nullptr) continue;
+      ForwardQuantizedTensor(*node, *dequantize);
+      rewired.push_back(node);
+    }
+    if (rewired.empty()) return Status::OK();
+
+    VLOG(1) << "Removed " << rewired.size()
+            << " redundant Dequantize/QuantizeV2 pairs";
+    DeleteDeadNodes(rewired);
+    return Status::OK();
+  }
+
+ private:
+  // Returns the Dequantize node feeding the given QuantizeV2 node if the pair
+  // is a float round trip of a tensor that is already quantized to the same
+  // type, or nullptr otherwise.
+  const NodeDef* FindRedundantDequantize(const NodeDef& quantize) const {
+    if (nodes_to_preserve_.count(quantize.name()) > 0) return nullptr;
+    if (NumNonControlInputs(quantize) != 3) return nullptr;
+    if (NodePosition(quantize.input(0)) != 0) return nullptr;
+
+    const NodeDef* dequantize = node_map_.GetNode(quantize.input(0));
+    if (dequantize == nullptr || dequantize->op() != "Dequantize" ||
+        NumNonControlInputs(*dequantize) != 3) {
+      return nullptr;
+    }
+    if (GetDataTypeFromAttr(quantize, "T") !=
+            GetDataTypeFromAttr(*dequantize, "T") ||
+        GetQuantizationMode(quantize) != GetQuantizationMode(*dequantize)) {
+      return nullptr;
+    }
+
+    // The quantized tensor can be reused as is if it is requantized to its own
+    // range, or to the range observed on the dequantized values (this is the
+    // pattern emitted by the quantize_nodes graph transform), since the latter
+    // is always contained in the former.
+    const bool same_range =
+        IsSameTensor(quantize.input(1), dequantize->input(1)) &&
+        IsSameTensor(quantize.input(2), dequantize->input(2));
+    const bool observed_range =
+        IsReductionOf(quantize.input(1), IsMin, *dequantize) &&
+        IsReductionOf(quantize.input(2), IsMax, *dequantize);
+    return same_range || observed_range ? dequantize : nullptr;
+  }
+
+  // Returns true if the input is a reduction of the given type over the output
+  // of the node, possibly reshaped first.
+  bool IsReductionOf(const string& input,
+                     bool (*is_reduction)(const NodeDef&),
+                     const NodeDef& node) const {
+    if (NodePosition(input) != 0) return false;
+    const NodeDef* reduction = node_map_.GetNode(input);
+    if (reduction == nullptr || !is_reduction(*reduction) ||
+        NumNonControlInputs(*reduction) < 1) {
+      return false;
+    }
+    const NodeDef* reduced = node_map_.GetNode(reduction->input(0));
+    while (reduced != nullptr && reduced != &node && IsReshape(*reduced) &&
+           NodePosition(reduced->input(0)) == 0) {
+      reduced = node_map_.GetNode(reduced->input(0));
+    }
+    return reduced == &node;
+  }
+
+  // Rewires the consumers of the QuantizeV2 outputs to the inputs of the
+  // Dequantize node: the quantized tensor, its min and its max.
+  void ForwardQuantizedTensor(const NodeDef& quantize,
+                              const NodeDef& dequantize) {
+    const std::set<NodeDef*> consumers = node_map_.GetOutputs(quantize.name());
+    for (NodeDef* consumer : consumers) {
+      bool has_control_dependency = false;
+      for (int i = 0; i < consumer->input_size(); ++i) {
+        const string& input = consumer->input(i);
+        if (NodeName(input) != quantize.name()) continue;
+        if (IsControlInput(input)) {
+          has_control_dependency = true;
+          continue;
+        }
+        const string& new_input = dequantize.input(NodePosition(input));
+        node_map_.UpdateInput(consumer->name(), input, new_input);
+        consumer->set_input(i, new_input);
+      }
+      if (has_control_dependency) {
+        node_map_.AddOutput(quantize.name(), consumer->name());
+      }
+    }
+  }
+
+  // Deletes the nodes that no longer have any consumer, starting from the
+  // given nodes and walking up their fanin.
+  void DeleteDeadNodes(const std::vector<NodeDef*>& nodes) {
+    std::unordered_map<const NodeDef*, int> node_index;
+    for (int i = 0; i < graph_->node_size(); ++i) {
+      node_index[&graph_->node(i)] = i;
+    }
+
+    std::set<int> nodes_to_delete;
+    std::vector<NodeDef*> queue(nodes.begin(), nodes.end());
+    while (!queue.empty()) {
+      NodeDef* node = queue.back();
+      queue.pop_back();
+      const int index = node_index[node];
+      if (nodes_to_delete.count(index) > 0 ||
+          nodes_to_preserve_.count(node->name()) > 0 ||
+          !node_map_.GetOutputs(node->name()).empty() ||
+          !IsFreeOfSideEffect(*node)) {
+        continue;
+      }
+      nodes_to_delete.insert(index);
+      for (const string& input : node->input()) {
+        NodeDef* fanin = node_map_.GetNode(input);
+        if (fanin == nullptr) continue;
+        node_map_.RemoveOutput(fanin->name(), node->name());
+        queue.push_back(fanin);
+      }
+    }
+    DeleteNodes(nodes_to_delete, graph_);
+  }
+
+  const std::unordered_set<string>& nodes_to_preserve_;
+  GraphDef* graph_;  // Not owned.
+  NodeMap node_map_;
+};
+
+}  // namespace
+
+Status QuantizationOptimizer::Optimize(Cluster* /*cluster*/,
+                                       const GrapplerItem& item,
+                                       GraphDef* optimized_graph) {
+  *optimized_graph = item.graph;
+  if (opt_level_ == RewriterConfig::OFF) return Status::OK();
+
+  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+  QuantizationRewriter rewriter(nodes_to_preserve, optimized_graph);
+  return rewriter.Rewrite();
+}
+
+void QuantizationOptimizer::Feedback(Cluster* /*cluster*/,
+                                     const GrapplerItem& /*item*/,
+                                     const GraphDef& /*optimized_graph*/,
+                                     double /*result*/) {
+  // Nothing to do for QuantizationOptimizer.
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,125 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/quantization_optimizer.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class QuantizationOptimizerTest : public GrapplerTest {};
+
+TEST_F(QuantizationOptimizerTest, RemoveObservedRangeRoundTrip) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT);
+  Output x_min = ops::Const(s.WithOpName("x_min"), -1.0f, {});
+  Output x_max = ops::Const(s.WithOpName("x_max"), 1.0f, {});
+  auto quantize1 =
+      ops::QuantizeV2(s.WithOpName("quantize1"), x, x_min, x_max, DT_QUINT8);
+  auto relu1 = ops::QuantizedRelu(s.WithOpName("relu1"), quantize1.output,
+                                  quantize1.output_min, quantize1.output_max);
+  Output dequantize1 =
+      ops::Dequantize(s.WithOpName("dequantize1"), relu1.activations,
+                      relu1.min_activations, relu1.max_activations);
+
+  // Requantize to the observed range, like the quantize_nodes transform.
+  Output reshape_dims = ops::Const(s.WithOpName("reshape_dims"), {-1}, {1});
+  Output reshape =
+      ops::Reshape(s.WithOpName("reshape"), dequantize1, reshape_dims);
+  Output reduction_dims = ops::Const(s.WithOpName("reduction_dims"), {0}, {1});
+  Output min = ops::Min(s.WithOpName("min"), reshape, reduction_dims);
+  Output max = ops::Max(s.WithOpName("max"), reshape, reduction_dims);
+  auto quantize2 =
+      ops::QuantizeV2(s.WithOpName("quantize2"), dequantize1, min, max,
+                      DT_QUINT8);
+  auto relu2 = ops::QuantizedRelu(s.WithOpName("relu2"), quantize2.output,
+                                  quantize2.output_min, quantize2.output_max);
+  Output dequantize2 =
+      ops::Dequantize(s.WithOpName("dequantize2"), relu2.activations,
+                      relu2.min_activations, relu2.max_activations);
+  Output fetch = ops::Identity(s.WithOpName("fetch"), dequantize2);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  GraphDef output;
+  QuantizationOptimizer optimizer;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // The float round trip between relu1 and relu2 is removed.
+  EXPECT_EQ(item.graph.node_size() - 7, output.node_size());
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE("dequantize1", node.name());
+    EXPECT_NE("quantize2", node.name());
+    EXPECT_NE("min", node.name());
+    EXPECT_NE("max", node.name());
+    if (node.name() == "relu2") {
+      found++;
+      ASSERT_EQ(3, node.input_size());
+      EXPECT_EQ("relu1", node.input(0));
+      EXPECT_EQ("relu1:1", node.input(1));
+      EXPECT_EQ("relu1:2", node.input(2));
+    }
+  }
+  EXPECT_EQ(1, found);
+
+  auto x_t = GenerateRandomTensor<DT_FLOAT>(TensorShape({4, 8}));
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, {{"x", x_t}});
+  auto tensors = EvaluateNodes(output, item.fetch, {{"x", x_t}});
+  ASSERT_EQ(1, tensors.size());
+  test::ExpectTensorNear<float>(tensors_expected[0], tensors[0], 2e-2);
+}
+
+TEST_F(QuantizationOptimizerTest, KeepRoundTripToDifferentType) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT);
+  Output x_min = ops::Const(s.WithOpName("x_min"), -1.0f, {});
+  Output x_max = ops::Const(s.WithOpName("x_max"), 1.0f, {});
+  auto quantize1 =
+      ops::QuantizeV2(s.WithOpName("quantize1"), x, x_min, x_max, DT_QUINT8);
+  Output dequantize1 =
+      ops::Dequantize(s.WithOpName("dequantize1"), quantize1.output,
+                      quantize1.output_min, quantize1.output_max);
+  auto quantize2 = ops::QuantizeV2(s.WithOpName("quantize2"), dequantize1,
+                                   quantize1.output_min, quantize1.output_max,
+                                   DT_QINT8);
+  Output dequantize2 =
+      ops::Dequantize(s.WithOpName("dequantize2"), quantize2.output,
+                      quantize2.output_min, quantize2.output_max);
+  Output fetch = ops::Identity(s.WithOpName("fetch"), dequantize2);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  GraphDef output;
+  QuantizationOptimizer optimizer;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  CompareGraphs(item.graph, output);
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
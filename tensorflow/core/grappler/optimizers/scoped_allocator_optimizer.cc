@@ -650,7 +650,8 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
 };
 
 ScopedAllocatorOptimizer::ScopedAllocatorOptimizer(
-    const ScopedAllocatorOptions& opts) {
+    const ScopedAllocatorOptions& opts)
+    : bucket_bytes_(opts.bucket_bytes()) {
   VLOG(1) << "ScopedAllocatorOptimizer::ScopedAllocatorOptimizer";
   Rewriter* r = new UnaryElementwiseRewriter();
   to_delete_.push_back(r);
@@ -698,6 +699,36 @@ ScopedAllocatorOptimizer::Rewriter* ScopedAllocatorOptimizer::GetRewriter(
   return nullptr;
 }
 
+void ScopedAllocatorOptimizer::PartitionIntoBuckets(
+    const GraphProperties& graph_properties, const std::vector<NodeDef*>& nodes,
+    std::vector<std::vector<NodeDef*>>* buckets) const {
+  if (bucket_bytes_ <= 0) {
+    buckets->push_back(nodes);
+    return;
+  }
+  int64 bucket_bytes = 0;
+  for (NodeDef* n : nodes) {
+    // Ops without a known output size are left for the Rewriter to reject.
+    int64 num_bytes = 0;
+    if (graph_properties.HasOutputProperties(n->name())) {
+      const std::vector<OpInfo::TensorProperties>& prop_list =
+          graph_properties.GetOutputProperties(n->name());
+      if (prop_list.size() == 1 && TensorShape::IsValid(prop_list[0].shape())) {
+        num_bytes = TensorShape(prop_list[0].shape()).num_elements() *
+                    DataTypeSize(prop_list[0].dtype());
+      }
+    }
+    if (buckets->empty() || bucket_bytes + num_bytes > bucket_bytes_) {
+      buckets->emplace_back();
+      bucket_bytes = 0;
+    }
+    buckets->back().push_back(n);
+    bucket_bytes += num_bytes;
+  }
+  VLOG(1) << "Split " << nodes.size() << " ops in " << buckets->size()
+          << " buckets of at most " << bucket_bytes_ << " bytes";
+}
+
 int ScopedAllocatorOptimizer::NewScopedAllocatorId(int num_fields) {
   CHECK_GT(num_fields, 0);
   int id = next_sa_id_;
@@ -840,26 +871,32 @@ Status ScopedAllocatorOptimizer::ProcessGraphDef(
         // Nodes with a common depth and root path are now grouped
         // in the same Tree struct.  Split those groups into subgroups that
         // share identical loop nesting.
-        status = ApplyToAll(
-            root.get(), [this, rewriter, graph, &frame_map, &op_name](Tree* t) {
-              VLOG(2) << "applied to tree node " << t->edge_ << " at depth "
-                      << t->depth_ << " of size " << t->nodes_.size();
-              if (t->nodes_.size() > 1) {
-                std::vector<std::vector<NodeDef*>> loop_groups;
-                PartitionByLoopStructure(frame_map, t->nodes_, &loop_groups);
-                for (auto& lg : loop_groups) {
-                  if (lg.size() > 1) {
-                    bool applied = false;
-                    Status s = OrderNodeSet(&lg);
-                    TF_RETURN_IF_ERROR(s);
-                    VLOG(1) << "Applying Rewriter for " << op_name;
-                    s = rewriter->Rewrite(this, graph, op_name, lg, &applied);
-                    LOG_WARNING_AND_RETURN_IF_ERROR(s);
-                  }
+        status = ApplyToAll(root.get(), [this, rewriter, graph, &frame_map,
+                                         &graph_properties,
+                                         &op_name](Tree* t) {
+          VLOG(2) << "applied to tree node " << t->edge_ << " at depth "
+                  << t->depth_ << " of size " << t->nodes_.size();
+          if (t->nodes_.size() > 1) {
+            std::vector<std::vector<NodeDef*>> loop_groups;
+            PartitionByLoopStructure(frame_map, t->nodes_, &loop_groups);
+            for (auto& lg : loop_groups) {
+              if (lg.size() > 1) {
+                Status s = OrderNodeSet(&lg);
+                TF_RETURN_IF_ERROR(s);
+                std::vector<std::vector<NodeDef*>> buckets;
+                PartitionIntoBuckets(graph_properties, lg, &buckets);
+                for (auto& bucket : buckets) {
+                  if (bucket.size() <= 1) continue;
+                  bool applied = false;
+                  VLOG(1) << "Applying Rewriter for " << op_name;
+                  s = rewriter->Rewrite(this, graph, op_name, bucket, &applied);
+                  LOG_WARNING_AND_RETURN_IF_ERROR(s);
                 }
               }
-              return Status::OK();
-            });
+            }
+          }
+          return Status::OK();
+        });
         if (!status.ok()) {
           break;
         }
@@ -57,6 +57,14 @@ class ScopedAllocatorOptimizer : public GraphOptimizer {
   void FindOpOccurrences(GraphDef* graph, const OpNameSet& op_names,
                          GraphOpOccurrences* occs);
 
+  // Splits the ordered set of parallel ops into consecutive buckets whose
+  // outputs total at most bucket_bytes_, or returns it as a single bucket if
+  // bucket_bytes_ is not positive.  An op whose output alone exceeds the limit
+  // gets a bucket of its own.
+  void PartitionIntoBuckets(const GraphProperties& graph_properties,
+                            const std::vector<NodeDef*>& nodes,
+                            std::vector<std::vector<NodeDef*>>* buckets) const;
+
   // Returns a new, unused scope_id to be assigned to a ScopedAllocator that
   // will allocate num_fields (> 0) separate tensors.
   int NewScopedAllocatorId(int num_fields);
@@ -99,6 +107,7 @@ class ScopedAllocatorOptimizer : public GraphOptimizer {
   std::unordered_map<string, Rewriter*> rewriters_;
   std::vector<Rewriter*> to_delete_;
   int next_sa_id_ = 1;
+  int64 bucket_bytes_ = 0;
   std::unique_ptr<NodeMap> node_map_;
 };
 
@@ -216,6 +216,50 @@ TEST_F(ScopedAllocatorOptimizerTest, UnaryExecute) {
   }
 }
 
+TEST_F(ScopedAllocatorOptimizerTest, UnaryRewriteBuckets) {
+  // Four parallel Abs ops of 16 bytes each, split in buckets of 32 bytes.
+  GrapplerItem item;
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  s = s.WithDevice("/job:localhost/replica:0/task:0/device:CPU:0");
+  Output a =
+      ops::Const<float>(s.WithOpName("a"), {1.0, 0.0, 0.0, -1.0}, {2, 2});
+  for (int i = 1; i <= 4; ++i) {
+    Output si = ops::Add(s.WithOpName(strings::StrCat("s", i)), a, a);
+    Output ai = ops::Abs(s.WithOpName(strings::StrCat("a", i)), si);
+    ops::Reshape(s.WithOpName(strings::StrCat("r", i)), ai, {1, 4});
+  }
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  ScopedAllocatorOptions opts;
+  opts.add_enable_op("Abs");
+  opts.set_bucket_bytes(32);
+  ScopedAllocatorOptimizer sao(opts);
+
+  GraphDef optimized_graph;
+  TF_ASSERT_OK(sao.Optimize(nullptr /*cluster*/, item, &optimized_graph));
+
+  NodeMap node_map(&optimized_graph);
+  int num_abs = 0;
+  for (const NodeDef& n : optimized_graph.node()) {
+    if (n.op() == "Abs") ++num_abs;
+  }
+  EXPECT_EQ(2, num_abs);
+  // The Abs ops are ordered by name: a1 and a2 share the first bucket, a3 and
+  // a4 the second one.
+  ASSERT_TRUE(node_map.GetNode("scoped_allocator_1_Abs"));
+  ASSERT_TRUE(node_map.GetNode("scoped_allocator_4_Abs"));
+  std::unordered_set<string> name_set;
+  for (auto it : node_map.GetOutputs("scoped_allocator_split_1")) {
+    name_set.insert(it->name());
+  }
+  EXPECT_EQ(std::unordered_set<string>({"r1", "r2"}), name_set);
+  name_set.clear();
+  for (auto it : node_map.GetOutputs("scoped_allocator_split_4")) {
+    name_set.insert(it->name());
+  }
+  EXPECT_EQ(std::unordered_set<string>({"r3", "r4"}), name_set);
+}
+
 // Tests static ScopedAllocatorOptimizer::ExtendNodeAttr.
 // Maybe this should be moved elsewhere?
 TEST_F(ScopedAllocatorOptimizerTest, Extend) {
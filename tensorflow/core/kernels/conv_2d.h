@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_KERNELS_CONV_2D_H_
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/numeric_types.h"
 #include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/kernels/eigen_backward_spatial_convolutions.h"
 #include "tensorflow/core/kernels/eigen_spatial_convolutions.h"
@@ -90,6 +91,24 @@ struct SpatialConvolution<Device, Eigen::half> {
   }
 };
 
+// bfloat16 convolutions accumulate in float. The contraction widens the input
+// patches and the filter to float as it packs them, so no float copy of the
+// operands is made, and only the output is rounded back to bfloat16.
+template <typename Device>
+struct SpatialConvolution<Device, bfloat16> {
+  void operator()(const Device& d, typename TTypes<bfloat16, 4>::Tensor output,
+                  typename TTypes<bfloat16, 4>::ConstTensor input,
+                  typename TTypes<bfloat16, 4>::ConstTensor filter,
+                  int row_stride, int col_stride, int row_dilation,
+                  int col_dilation, const Eigen::PaddingType& padding) {
+    output.device(d) =
+        Eigen::SpatialConvolution(input.cast<float>(), filter.cast<float>(),
+                                  col_stride, row_stride, padding, col_dilation,
+                                  row_dilation)
+            .cast<bfloat16>();
+  }
+};
+
 template <typename Device, typename T>
 struct SpatialConvolutionBackwardInput {
   void operator()(const Device& d, typename TTypes<T, 4>::Tensor input_backward,
@@ -137,6 +156,20 @@ struct MatMulConvFunctor {
   }
 };
 
+// Accumulates bfloat16 products in float, like SpatialConvolution.
+template <typename Device>
+struct MatMulConvFunctor<Device, bfloat16> {
+  void operator()(
+      const Device& d, typename TTypes<bfloat16, 2>::Tensor out,
+      typename TTypes<bfloat16, 2>::ConstTensor in0,
+      typename TTypes<bfloat16, 2>::ConstTensor in1,
+      const Eigen::array<Eigen::IndexPair<Eigen::DenseIndex>, 1>& dim_pair) {
+    out.device(d) = in0.cast<float>()
+                        .contract(in1.cast<float>(), dim_pair)
+                        .cast<bfloat16>();
+  }
+};
+
 // Shuffles a filter tensor from:
 //   [<spatial_dims>, in, out]
 // to:
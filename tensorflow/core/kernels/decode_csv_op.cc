@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 // See docs in ../ops/parsing_ops.cc.
+#include <deque>
 #include <vector>
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -78,10 +79,16 @@ class DecodeCSVOp : public OpKernel {
       OP_REQUIRES_OK(ctx, output.allocate(i, records->shape(), &out));
     }
 
+    // Fields point into the record, except for quoted fields with escaped
+    // quotes which are unescaped into 'unescaped_fields'.  Both are reused
+    // across records, so that parsing a record does not allocate.
+    std::vector<StringPiece> fields;
+    std::deque<string> unescaped_fields;
     for (int64 i = 0; i < records_size; ++i) {
       const StringPiece record(records_t(i));
-      std::vector<string> fields;
-      ExtractFields(ctx, record, &fields);
+      fields.clear();
+      unescaped_fields.clear();
+      ExtractFields(ctx, record, &fields, &unescaped_fields);
       OP_REQUIRES(ctx, fields.size() == out_type_.size(),
                   errors::InvalidArgument("Expect ", out_type_.size(),
                                           " fields but have ", fields.size(),
@@ -142,7 +149,7 @@ class DecodeCSVOp : public OpKernel {
               output[f]->flat<float>()(i) = record_defaults[f].flat<float>()(0);
             } else {
               float value;
-              OP_REQUIRES(ctx, strings::safe_strtof(fields[f].c_str(), &value),
+              OP_REQUIRES(ctx, strings::safe_strtof(fields[f], &value),
                           errors::InvalidArgument(
                               "Field ", f, " in record ", i,
                               " is not a valid float: ", fields[f]));
@@ -162,7 +169,7 @@ class DecodeCSVOp : public OpKernel {
                   record_defaults[f].flat<double>()(0);
             } else {
               double value;
-              OP_REQUIRES(ctx, strings::safe_strtod(fields[f].c_str(), &value),
+              OP_REQUIRES(ctx, strings::safe_strtod(fields[f], &value),
                           errors::InvalidArgument(
                               "Field ", f, " in record ", i,
                               " is not a valid double: ", fields[f]));
@@ -181,7 +188,8 @@ class DecodeCSVOp : public OpKernel {
               output[f]->flat<string>()(i) =
                   record_defaults[f].flat<string>()(0);
             } else {
-              output[f]->flat<string>()(i) = fields[f];
+              output[f]->flat<string>()(i).assign(fields[f].data(),
+                                                   fields[f].size());
             }
             break;
           }
@@ -203,7 +211,8 @@ class DecodeCSVOp : public OpKernel {
   string na_value_;
 
   void ExtractFields(OpKernelContext* ctx, StringPiece input,
-                     std::vector<string>* result) {
+                     std::vector<StringPiece>* result,
+                     std::deque<string>* unescaped_fields) {
     int64 current_idx = 0;
     int64 num_fields_parsed = 0;
     int64 selector_idx = 0;  // Keep track of index into select_cols
@@ -226,7 +235,8 @@ class DecodeCSVOp : public OpKernel {
         }
 
         // This is the body of the field;
-        string field;
+        StringPiece field;
+        const int64 field_start = current_idx;
         if (!quoted) {
           while (static_cast<size_t>(current_idx) < input.size() &&
                  input[current_idx] != delim_) {
@@ -236,29 +246,45 @@ class DecodeCSVOp : public OpKernel {
                             input[current_idx] != '\r',
                         errors::InvalidArgument(
                             "Unquoted fields cannot have quotes/CRLFs inside"));
-            if (include) field += input[current_idx];
             current_idx++;
           }
+          field = StringPiece(input.data() + field_start,
+                              current_idx - field_start);
 
           // Go to next field or the end
           current_idx++;
         } else if (use_quote_delim_) {
-          // Quoted field needs to be ended with '"' and delim or end
+          // Quoted field needs to be ended with '"' and delim or end.  The
+          // field is only copied once an escaped quote is found in it.
+          string* unescaped = nullptr;
           while (
               (static_cast<size_t>(current_idx) < input.size() - 1) &&
               (input[current_idx] != '"' || input[current_idx + 1] != delim_)) {
             if (input[current_idx] != '"') {
-              if (include) field += input[current_idx];
+              if (unescaped != nullptr) {
+                unescaped->push_back(input[current_idx]);
+              }
               current_idx++;
             } else {
               OP_REQUIRES(
                   ctx, input[current_idx + 1] == '"',
                   errors::InvalidArgument("Quote inside a string has to be "
                                           "escaped by another quote"));
-              if (include) field += '"';
+              if (include && unescaped == nullptr) {
+                unescaped_fields->emplace_back(input.data() + field_start,
+                                               current_idx - field_start);
+                unescaped = &unescaped_fields->back();
+              }
+              if (unescaped != nullptr) unescaped->push_back('"');
               current_idx += 2;
             }
           }
+          if (unescaped != nullptr) {
+            field = *unescaped;
+          } else {
+            field = StringPiece(input.data() + field_start,
+                                current_idx - field_start);
+          }
 
           OP_REQUIRES(
               ctx,
@@ -285,7 +311,7 @@ class DecodeCSVOp : public OpKernel {
                                    static_cast<size_t>(num_fields_parsed));
       // Check if the last field is missing
       if (include && input[input.size() - 1] == delim_)
-        result->push_back(string());
+        result->push_back(StringPiece());
     }
   }
 };
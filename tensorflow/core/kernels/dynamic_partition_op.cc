@@ -15,7 +15,9 @@ limitations under the License.
 
 // See docs in ../ops/data_flow_ops.cc.
 
+#include <algorithm>
 #include <vector>
+
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -23,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/bounds_check.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -39,9 +42,14 @@ class DynamicPartitionOp_Shared : public OpKernel {
     //   in the graph?
   }
 
+  // The partitions are split into blocks of 'block_size' consecutive ids,
+  // which are counted and then copied on the CPU worker threads.  On return,
+  // block_offsets[b * num_partitions_ + p] is the row of output p at which
+  // the rows of block b that belong to partition p start.
   void ValidateAndAllocateOutputs(OpKernelContext* c, const Tensor** data,
                                   const Tensor** partitions,
-                                  OpOutputList* Tout) {
+                                  OpOutputList* Tout, int64* block_size,
+                                  std::vector<int64>* block_offsets) {
     OP_REQUIRES_OK(c, c->input("data", data));
     OP_REQUIRES_OK(c, c->input("partitions", partitions));
     OP_REQUIRES(
@@ -52,17 +60,60 @@ class DynamicPartitionOp_Shared : public OpKernel {
             "got data.shape = ", (*data)->shape().DebugString(),
             ", partitions.shape = ", (*partitions)->shape().DebugString()));
 
-    // Count how many occurrences of each partition id we have in partitions
-    gtl::InlinedVector<int, 32> partition_count(num_partitions_);
     auto e_partitions = (*partitions)->flat<int32>();
     const int64 N = e_partitions.dimension(0);
-    for (int64 i = 0; i < N; i++) {
-      const int32 p = internal::SubtleMustCopy(e_partitions(i));
-      OP_REQUIRES(c, FastBoundsCheck(p, num_partitions_),
+    const int64 slice_size =
+        N == 0 ? 1 : std::max<int64>((*data)->NumElements() / N, 1);
+    auto worker_threads = c->device()->tensorflow_cpu_worker_threads();
+    // Blocks are large enough to amortize counting their partitions, and
+    // there are no more of them than threads to copy them.
+    const int64 min_block_size = std::max<int64>(
+        num_partitions_,
+        std::max<int64>(kMinPartitionBlockElements / slice_size, 1));
+    const int64 num_blocks = std::max<int64>(
+        std::min<int64>(worker_threads->num_threads, N / min_block_size), 1);
+    *block_size = (N + num_blocks - 1) / num_blocks;
+
+    // Count how many occurrences of each partition id we have in each block.
+    block_offsets->assign(num_blocks * num_partitions_, 0);
+    std::vector<int64> bad_index(num_blocks, -1);
+    std::vector<int32> bad_partition(num_blocks);
+    auto count_blocks = [&](int64 start, int64 limit) {
+      for (int64 b = start; b < limit; ++b) {
+        int64* counts = block_offsets->data() + b * num_partitions_;
+        const int64 end = std::min(N, (b + 1) * *block_size);
+        for (int64 i = b * *block_size; i < end; i++) {
+          const int32 p = internal::SubtleMustCopy(e_partitions(i));
+          if (!FastBoundsCheck(p, num_partitions_)) {
+            bad_index[b] = i;
+            bad_partition[b] = p;
+            break;
+          }
+          counts[p]++;
+        }
+      }
+    };
+    Shard(worker_threads->num_threads, worker_threads->workers, num_blocks,
+          *block_size * kCostPerPartitionId, count_blocks);
+    for (int64 b = 0; b < num_blocks; ++b) {
+      if (bad_index[b] < 0) continue;
+      const int64 i = bad_index[b];
+      OP_REQUIRES(c, false,
                   errors::InvalidArgument(
                       "partitions", SliceDebugString((*partitions)->shape(), i),
-                      " = ", p, " is not in [0, ", num_partitions_, ")"));
-      partition_count[p]++;
+                      " = ", bad_partition[b], " is not in [0, ",
+                      num_partitions_, ")"));
+    }
+
+    // Turn the counts into the offsets of the blocks in each output.
+    gtl::InlinedVector<int64, 32> partition_count(num_partitions_);
+    for (int64 b = 0; b < num_blocks; ++b) {
+      int64* offsets = block_offsets->data() + b * num_partitions_;
+      for (int p = 0; p < num_partitions_; p++) {
+        const int64 count = offsets[p];
+        offsets[p] = partition_count[p];
+        partition_count[p] += count;
+      }
     }
 
     // Allocate output tensors of the right size
@@ -79,6 +130,11 @@ class DynamicPartitionOp_Shared : public OpKernel {
   }
 
  protected:
+  // Blocks of partition ids hold at least this many elements of data.
+  static constexpr int64 kMinPartitionBlockElements = 32 * 1024;
+  // Estimated cycles to count one partition id.
+  static constexpr int64 kCostPerPartitionId = 5;
+
   int num_partitions_;
 };
 
@@ -91,13 +147,26 @@ class DynamicPartitionOp : public DynamicPartitionOp_Shared {
     const Tensor* data;
     const Tensor* partitions;
     OpOutputList outputs;
-    ValidateAndAllocateOutputs(c, &data, &partitions, &outputs);
+    int64 block_size;
+    std::vector<int64> block_offsets;
+    ValidateAndAllocateOutputs(c, &data, &partitions, &outputs, &block_size,
+                               &block_offsets);
     if (!c->status().ok()) return;
     if (num_partitions_ == 0 || data->NumElements() == 0) return;
 
     auto e_partitions = partitions->flat<int32>();
     const int64 N = e_partitions.dimension(0);
-    gtl::InlinedVector<int, 32> output_index(num_partitions_);
+    const int64 num_blocks = block_offsets.size() / num_partitions_;
+    std::vector<Status> block_status(num_blocks);
+    const int64 slice_size = data->NumElements() / N;
+    auto worker_threads = c->device()->tensorflow_cpu_worker_threads();
+
+    // Returns the row after the last one of output p written by block b.
+    auto block_limit = [&](int64 b, int32 p) {
+      return b + 1 < num_blocks
+                 ? block_offsets[(b + 1) * num_partitions_ + p]
+                 : outputs[p]->dim_size(0);
+    };
 
     if (partitions->dims() == data->dims()) {
       // Walk through data and copy the data to the appropriate output tensor
@@ -109,19 +178,33 @@ class DynamicPartitionOp : public DynamicPartitionOp_Shared {
       for (int p = 0; p < num_partitions_; p++) {
         out_vec.push_back(outputs[p]->vec<T>());
       }
-      for (int64 i = 0; i < N; i++) {
-        const int32 p = internal::SubtleMustCopy(e_partitions(i));
-        OP_REQUIRES(
-            c, FastBoundsCheck(p, num_partitions_),
-            errors::InvalidArgument("indices[", i, "] is out of range"));
-        auto oi = output_index[p];
-        OP_REQUIRES(c, FastBoundsCheck(oi, out_vec[p].size()),
-                    errors::InvalidArgument(
-                        "out_vec[", p, "] size: ", out_vec[p].size(),
-                        " is not LTE output_index[", p, "] : ", oi));
-        out_vec[p](oi) = data_flat(i);
-        output_index[p]++;
-      }
+      auto copy_blocks = [&](int64 start, int64 limit) {
+        for (int64 b = start; b < limit; ++b) {
+          gtl::InlinedVector<int64, 32> output_index(
+              block_offsets.begin() + b * num_partitions_,
+              block_offsets.begin() + (b + 1) * num_partitions_);
+          const int64 end = std::min(N, (b + 1) * block_size);
+          for (int64 i = b * block_size; i < end; i++) {
+            const int32 p = internal::SubtleMustCopy(e_partitions(i));
+            if (!FastBoundsCheck(p, num_partitions_)) {
+              block_status[b] = errors::InvalidArgument("indices[", i,
+                                                        "] is out of range");
+              break;
+            }
+            auto oi = output_index[p];
+            if (oi >= block_limit(b, p)) {
+              block_status[b] = errors::InvalidArgument(
+                  "out_vec[", p, "] size: ", out_vec[p].size(),
+                  " is not LTE output_index[", p, "] : ", oi);
+              break;
+            }
+            out_vec[p](oi) = data_flat(i);
+            output_index[p]++;
+          }
+        }
+      };
+      Shard(worker_threads->num_threads, worker_threads->workers, num_blocks,
+            block_size * sizeof(T), copy_blocks);
     } else {
       // If data has extra dimensions, use Eigen slices
       std::vector<Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>,
@@ -133,27 +216,43 @@ class DynamicPartitionOp : public DynamicPartitionOp_Shared {
       }
 
       // Walk through data and copy the data to the appropriate output tensor
-      const int64 slice_size = data->NumElements() / N;
       const auto data_flat = data->shaped<T, 2>({N, slice_size});
       Eigen::DSizes<Eigen::DenseIndex, 2> sizes(1, slice_size);
-      for (int64 i = 0; i < N; i++) {
-        // outputs[p][output_index[p]++] = data[i]
-        const int32 p = internal::SubtleMustCopy(e_partitions(i));
-        OP_REQUIRES(
-            c, FastBoundsCheck(p, num_partitions_),
-            errors::InvalidArgument("indices[", i,
-                                    "] has been asynchronously overwitten and "
-                                    "is no longer in range!"));
-        auto oi = output_index[p];
-        OP_REQUIRES(c, FastBoundsCheck(oi, out_flat[p].dimension(0)),
-                    errors::InvalidArgument("Size of output_index: ", oi,
-                                            " is no longer in range."));
-        Eigen::DSizes<Eigen::DenseIndex, 2> out_indices(oi, 0);
-        Eigen::DSizes<Eigen::DenseIndex, 2> data_indices(i, 0);
-        out_flat[p].slice(out_indices, sizes) =
-            data_flat.slice(data_indices, sizes);
-        output_index[p]++;
-      }
+      auto copy_blocks = [&](int64 start, int64 limit) {
+        for (int64 b = start; b < limit; ++b) {
+          gtl::InlinedVector<int64, 32> output_index(
+              block_offsets.begin() + b * num_partitions_,
+              block_offsets.begin() + (b + 1) * num_partitions_);
+          const int64 end = std::min(N, (b + 1) * block_size);
+          for (int64 i = b * block_size; i < end; i++) {
+            // outputs[p][output_index[p]++] = data[i]
+            const int32 p = internal::SubtleMustCopy(e_partitions(i));
+            if (!FastBoundsCheck(p, num_partitions_)) {
+              block_status[b] = errors::InvalidArgument(
+                  "indices[", i,
+                  "] has been asynchronously overwitten and "
+                  "is no longer in range!");
+              break;
+            }
+            auto oi = output_index[p];
+            if (oi >= block_limit(b, p)) {
+              block_status[b] = errors::InvalidArgument(
+                  "Size of output_index: ", oi, " is no longer in range.");
+              break;
+            }
+            Eigen::DSizes<Eigen::DenseIndex, 2> out_indices(oi, 0);
+            Eigen::DSizes<Eigen::DenseIndex, 2> data_indices(i, 0);
+            out_flat[p].slice(out_indices, sizes) =
+                data_flat.slice(data_indices, sizes);
+            output_index[p]++;
+          }
+        }
+      };
+      Shard(worker_threads->num_threads, worker_threads->workers, num_blocks,
+            block_size * slice_size * sizeof(T), copy_blocks);
+    }
+    for (const Status& s : block_status) {
+      OP_REQUIRES_OK(c, s);
     }
   }
 };
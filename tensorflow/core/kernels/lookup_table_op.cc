@@ -24,17 +24,19 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/kernels/initializable_lookup_table.h"
+#include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/hash/hash.h"
 
 namespace tensorflow {
 namespace lookup {
 
-// Lookup table that wraps an unordered_map, where the key and value data type
+// Lookup table that wraps a FlatMap, where the key and value data type
 // is specified. Each individual value must be a scalar. If vector values are
 // required, use MutableHashTableOfTensors.
 //
 // This table is mutable and thread safe - Insert can be called at any time.
+// Lookups share the lock of the table, only insertions take it exclusively.
 //
 // Sample use case:
 //
@@ -50,7 +52,7 @@ class MutableHashTableOfScalars final : public LookupInterface {
   MutableHashTableOfScalars(OpKernelContext* ctx, OpKernel* kernel) {}
 
   size_t size() const override {
-    mutex_lock l(mu_);
+    tf_shared_lock l(mu_);
     return table_.size();
   }
 
@@ -59,11 +61,16 @@ class MutableHashTableOfScalars final : public LookupInterface {
     const V default_val = default_value.flat<V>()(0);
     const auto key_values = key.flat<K>();
     auto value_values = value->flat<V>();
+    const int64 num_keys = key_values.size();
 
-    mutex_lock l(mu_);
-    for (int64 i = 0; i < key_values.size(); ++i) {
-      value_values(i) = gtl::FindWithDefault(
-          table_, SubtleMustCopyIfIntegral(key_values(i)), default_val);
+    tf_shared_lock l(mu_);
+    for (int64 i = 0; i < num_keys; ++i) {
+      if (std::is_integral<K>::value &&
+          i + kLookupPrefetchDistance < num_keys) {
+        table_.prefetch_value(key_values(i + kLookupPrefetchDistance));
+      }
+      auto it = table_.find(SubtleMustCopyIfIntegral(key_values(i)));
+      value_values(i) = it == table_.end() ? default_val : it->second;
     }
 
     return Status::OK();
@@ -78,8 +85,8 @@ class MutableHashTableOfScalars final : public LookupInterface {
       table_.clear();
     }
     for (int64 i = 0; i < key_values.size(); ++i) {
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
-                          SubtleMustCopyIfIntegral(value_values(i)));
+      table_[SubtleMustCopyIfIntegral(key_values(i))] =
+          SubtleMustCopyIfIntegral(value_values(i));
     }
     return Status::OK();
   }
@@ -95,7 +102,7 @@ class MutableHashTableOfScalars final : public LookupInterface {
   }
 
   Status ExportValues(OpKernelContext* ctx) override {
-    mutex_lock l(mu_);
+    tf_shared_lock l(mu_);
     int64 size = table_.size();
 
     Tensor* keys;
@@ -124,26 +131,19 @@ class MutableHashTableOfScalars final : public LookupInterface {
   TensorShape value_shape() const override { return TensorShape(); }
 
   int64 MemoryUsed() const override {
-    int64 ret = 0;
-    mutex_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
-      }
-    }
-    return sizeof(MutableHashTableOfScalars) + ret;
+    tf_shared_lock l(mu_);
+    // Each slot holds a key, a value and a one-byte marker.
+    const int64 num_slots = table_.bucket_count();
+    return sizeof(MutableHashTableOfScalars) +
+           num_slots * (sizeof(K) + sizeof(V) + 1);
   }
 
  private:
-  // TODO(andreasst): consider using a read/write lock or a concurrent map
   mutable mutex mu_;
-  std::unordered_map<K, V> table_ GUARDED_BY(mu_);
+  gtl::FlatMap<K, V, LookupTableHash<K>> table_ GUARDED_BY(mu_);
 };
 
-// Lookup table that wraps an unordered_map. Behaves identical to
+// Lookup table that wraps a FlatMap. Behaves identical to
 // MutableHashTableOfScalars except that each value must be a vector.
 template <class K, class V>
 class MutableHashTableOfTensors final : public LookupInterface {
@@ -158,7 +158,7 @@ class MutableHashTableOfTensors final : public LookupInterface {
   }
 
   size_t size() const override {
-    mutex_lock l(mu_);
+    tf_shared_lock l(mu_);
     return table_.size();
   }
 
@@ -168,12 +168,17 @@ class MutableHashTableOfTensors final : public LookupInterface {
     const auto key_values = key.flat<K>();
     auto value_values = value->flat_inner_dims<V, 2>();
     int64 value_dim = value_shape_.dim_size(0);
+    const int64 num_keys = key_values.size();
 
-    mutex_lock l(mu_);
-    for (int64 i = 0; i < key_values.size(); ++i) {
-      ValueArray* value_vec =
-          gtl::FindOrNull(table_, SubtleMustCopyIfIntegral(key_values(i)));
-      if (value_vec != nullptr) {
+    tf_shared_lock l(mu_);
+    for (int64 i = 0; i < num_keys; ++i) {
+      if (std::is_integral<K>::value &&
+          i + kLookupPrefetchDistance < num_keys) {
+        table_.prefetch_value(key_values(i + kLookupPrefetchDistance));
+      }
+      auto it = table_.find(SubtleMustCopyIfIntegral(key_values(i)));
+      if (it != table_.end()) {
+        const ValueArray* value_vec = &it->second;
         for (int64 j = 0; j < value_dim; j++) {
           value_values(i, j) = value_vec->at(j);
         }
@@ -202,8 +207,7 @@ class MutableHashTableOfTensors final : public LookupInterface {
         V value = value_values(i, j);
         value_vec.push_back(value);
       }
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
-                          value_vec);
+      table_[SubtleMustCopyIfIntegral(key_values(i))] = std::move(value_vec);
     }
     return Status::OK();
   }
@@ -219,7 +223,7 @@ class MutableHashTableOfTensors final : public LookupInterface {
   }
 
   Status ExportValues(OpKernelContext* ctx) override {
-    mutex_lock l(mu_);
+    tf_shared_lock l(mu_);
     int64 size = table_.size();
     int64 value_dim = value_shape_.dim_size(0);
 
@@ -234,8 +238,8 @@ class MutableHashTableOfTensors final : public LookupInterface {
     auto values_data = values->matrix<V>();
     int64 i = 0;
     for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      K key = it->first;
-      ValueArray value = it->second;
+      const K& key = it->first;
+      const ValueArray& value = it->second;
       keys_data(i) = key;
       for (int64 j = 0; j < value_dim; j++) {
         values_data(i, j) = value[j];
@@ -253,25 +257,18 @@ class MutableHashTableOfTensors final : public LookupInterface {
   TensorShape value_shape() const override { return value_shape_; }
 
   int64 MemoryUsed() const override {
-    int64 ret = 0;
-    mutex_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
-      }
-    }
-    return sizeof(MutableHashTableOfTensors) + ret;
+    tf_shared_lock l(mu_);
+    // Each slot holds a key, a value and a one-byte marker.
+    const int64 num_slots = table_.bucket_count();
+    return sizeof(MutableHashTableOfTensors) +
+           num_slots * (sizeof(K) + sizeof(ValueArray) + 1);
   }
 
  private:
   TensorShape value_shape_;
-  // TODO(andreasst): consider using a read/write lock or a concurrent map
   mutable mutex mu_;
   typedef gtl::InlinedVector<V, 4> ValueArray;
-  std::unordered_map<K, ValueArray> table_ GUARDED_BY(mu_);
+  gtl::FlatMap<K, ValueArray, LookupTableHash<K>> table_ GUARDED_BY(mu_);
 };
 
 namespace {
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_KERNELS_LOOKUP_TABLE_OP_H_
 #define TENSORFLOW_KERNELS_LOOKUP_TABLE_OP_H_
 
+#include <type_traits>
+
 #include "tensorflow/core/framework/lookup_interface.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/resource_mgr.h"
@@ -25,7 +27,9 @@ limitations under the License.
 #include "tensorflow/core/kernels/lookup_util.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 
@@ -143,7 +147,32 @@ inline const Variant& SubtleMustCopyIfIntegral(const Variant& value) {
   return value;
 }
 
-// Lookup table that wraps an unordered_map, where the key and value data type
+// Hash function for the keys of the hash tables.  tensorflow::hash is the
+// identity on integers, which would put consecutive ids, the most common
+// keys, in overlapping probe sequences of a FlatMap, so their bits are mixed
+// first (with the finalizer of MurmurHash3).
+template <typename K, typename = void>
+struct LookupTableHash : hash<K> {};
+
+template <typename K>
+struct LookupTableHash<
+    K, typename std::enable_if<std::is_integral<K>::value>::type> {
+  size_t operator()(K key) const {
+    uint64 x = static_cast<uint64>(key);
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return static_cast<size_t>(x);
+  }
+};
+
+// Number of keys ahead of the current one whose slot a batched lookup
+// prefetches, to overlap the cache misses of large tables.
+constexpr int64 kLookupPrefetchDistance = 8;
+
+// Lookup table that wraps a FlatMap, where the key and value data type
 // is specified.
 //
 // This table is recommended for any variations to key values.
@@ -211,8 +240,7 @@ class HashTable : public InitializableLookupTable {
       return errors::Aborted("HashTable already initialized.");
     }
     if (!table_) {
-      table_ = std::unique_ptr<std::unordered_map<K, V>>(
-          new std::unordered_map<K, V>());
+      table_ = std::unique_ptr<TableType>(new TableType());
     }
     return Status::OK();
   };
@@ -232,8 +260,9 @@ class HashTable : public InitializableLookupTable {
     for (int64 i = 0; i < key_values.size(); ++i) {
       const K key = SubtleMustCopyIfIntegral(key_values(i));
       const V value = SubtleMustCopyIfIntegral(value_values(i));
-      const V& previous_value = gtl::LookupOrInsert(table_.get(), key, value);
-      if (previous_value != value) {
+      auto result = table_->insert({key, value});
+      const V& previous_value = result.first->second;
+      if (!result.second && previous_value != value) {
         return errors::FailedPrecondition(
             "HashTable has different value for same key. Key ", key, " has ",
             previous_value, " and trying to add value ", value);
@@ -248,24 +277,32 @@ class HashTable : public InitializableLookupTable {
     const auto key_values = key.flat<K>();
     auto value_values = value->flat<V>();
 
-    for (int64 i = 0; i < key_values.size(); ++i) {
-      value_values(i) = gtl::FindWithDefault(
-          *table_, SubtleMustCopyIfIntegral(key_values(i)), default_val);
+    const int64 num_keys = key_values.size();
+    for (int64 i = 0; i < num_keys; ++i) {
+      // Hashing a string key twice costs more than the cache miss it saves.
+      if (std::is_integral<K>::value &&
+          i + kLookupPrefetchDistance < num_keys) {
+        table_->prefetch_value(key_values(i + kLookupPrefetchDistance));
+      }
+      auto it = table_->find(SubtleMustCopyIfIntegral(key_values(i)));
+      value_values(i) = it == table_->end() ? default_val : it->second;
     }
     return Status::OK();
   }
 
   int64 MemoryUsed() const override {
     if (table_) {
-      const int64 num_elements = table_->size();
-      return num_elements * (sizeof(K) + sizeof(V));
+      // Each slot holds a key, a value and a one-byte marker.
+      const int64 num_slots = table_->bucket_count();
+      return num_slots * (sizeof(K) + sizeof(V) + 1);
     } else {
       return 0;
     }
   }
 
  private:
-  std::unique_ptr<std::unordered_map<K, V>> table_;
+  typedef gtl::FlatMap<K, V, LookupTableHash<K>> TableType;
+  std::unique_ptr<TableType> table_;
 };
 
 }  // namespace lookup
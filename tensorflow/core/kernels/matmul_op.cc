@@ -143,6 +143,23 @@ struct LaunchMatMulBase {
 template <typename T>
 struct LaunchMatMulCPU : LaunchMatMulBase<CPUDevice, T> {};
 
+// Products of bfloat16 values are accumulated in float. The contraction widens
+// the operands to float a block at a time as it packs them, so no float copy
+// of the inputs is made, and only the result is rounded back to bfloat16.
+template <>
+struct LaunchMatMulCPU<bfloat16> : LaunchMatMulBase<CPUDevice, bfloat16> {
+  static void launch(
+      OpKernelContext* ctx, const Tensor& a, const Tensor& b,
+      const Eigen::array<Eigen::IndexPair<Eigen::DenseIndex>, 1>& dim_pair,
+      std::vector<AlgorithmType>* algorithms, bool use_autotune, Tensor* out) {
+    out->matrix<bfloat16>().device(ctx->eigen_device<CPUDevice>()) =
+        a.matrix<bfloat16>()
+            .cast<float>()
+            .contract(b.matrix<bfloat16>().cast<float>(), dim_pair)
+            .cast<bfloat16>();
+  }
+};
+
 template <typename T, bool USE_CUBLAS>
 struct LaunchMatMul<CPUDevice, T, USE_CUBLAS> : public LaunchMatMulCPU<T> {};
 
@@ -553,12 +570,14 @@ struct MatMulFunctor<SYCLDevice, T> {
 
 #if defined(INTEL_MKL) && !defined(DO_NOT_USE_ML)
 
-// MKL does not support half and int32 types for matrix-multiplication, so
-// register the kernel to use default Eigen based implementations for these
-// types. Registration for NO-LABEL version is in mkl_matmul_op.cc
+// MKL does not support half, bfloat16 and int32 types for
+// matrix-multiplication, so register the kernel to use default Eigen based
+// implementations for these types. Registration for NO-LABEL version is in
+// mkl_matmul_op.cc
 TF_CALL_float(REGISTER_CPU_EIGEN);
 TF_CALL_double(REGISTER_CPU_EIGEN);
 TF_CALL_half(REGISTER_CPU);
+TF_CALL_bfloat16(REGISTER_CPU);
 
 TF_CALL_int32(REGISTER_CPU);
 TF_CALL_complex64(REGISTER_CPU_EIGEN);
@@ -567,6 +586,7 @@ TF_CALL_complex128(REGISTER_CPU_EIGEN);
 TF_CALL_float(REGISTER_CPU);
 TF_CALL_double(REGISTER_CPU);
 TF_CALL_half(REGISTER_CPU);
+TF_CALL_bfloat16(REGISTER_CPU);
 
 TF_CALL_int32(REGISTER_CPU);
 TF_CALL_complex64(REGISTER_CPU);
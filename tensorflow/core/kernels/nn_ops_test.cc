@@ -67,6 +67,9 @@ static void SetConstOp(const string& name, std::initializer_list<int64> dims,
       case DT_HALF:
         tensor.flat<Eigen::half>()(i) = Eigen::half(i / 10.0f);
         break;
+      case DT_BFLOAT16:
+        tensor.flat<bfloat16>()(i) = bfloat16(i / 10.0f);
+        break;
       default:
         LOG(FATAL) << "Unknown data type " << data_type;
     }
@@ -244,6 +247,20 @@ static void BM_ConvFloat(int iters, int batch, int rows, int cols, int in_depth,
                  strings::StrCat(BS, "_", R, "_", C, "_", ID, "_", OD, "_",    \
                                  KR, "_", KC, "_", STR, "_", PAD, "_f_cpu4")); \
   }                                                                            \
+  static void BM_ConvBFloat16FwdCPU1_##LABEL(int iters) {                      \
+    BM_ConvFloat(iters, BS, R, C, ID, OD, KR, KC, CONV_OP_FORWARD, 1, STR,     \
+                 PAD, false, DT_BFLOAT16,                                      \
+                 strings::StrCat(BS, "_", R, "_", C, "_", ID, "_", OD, "_",    \
+                                 KR, "_", KC, "_", STR, "_", PAD,              \
+                                 "_bf16_cpu1"));                               \
+  }                                                                            \
+  static void BM_ConvBFloat16FwdCPU4_##LABEL(int iters) {                      \
+    BM_ConvFloat(iters, BS, R, C, ID, OD, KR, KC, CONV_OP_FORWARD, 4, STR,     \
+                 PAD, false, DT_BFLOAT16,                                      \
+                 strings::StrCat(BS, "_", R, "_", C, "_", ID, "_", OD, "_",    \
+                                 KR, "_", KC, "_", STR, "_", PAD,              \
+                                 "_bf16_cpu4"));                               \
+  }                                                                            \
   static void BM_ConvFloatFusedCPU1_##LABEL(int iters) {                       \
     BM_ConvFloat(iters, BS, R, C, ID, OD, KR, KC, CONV_OP_FUSED, 1, STR, PAD,  \
                  false, DT_FLOAT,                                              \
@@ -270,6 +287,8 @@ static void BM_ConvFloat(int iters, int batch, int rows, int cols, int in_depth,
   }                                                                            \
   BENCHMARK(BM_ConvFloatFwdCPU1_##LABEL);                                      \
   BENCHMARK(BM_ConvFloatFwdCPU4_##LABEL);                                      \
+  BENCHMARK(BM_ConvBFloat16FwdCPU1_##LABEL);                                   \
+  BENCHMARK(BM_ConvBFloat16FwdCPU4_##LABEL);                                   \
   BENCHMARK(BM_ConvFloatFusedCPU1_##LABEL);                                    \
   BENCHMARK(BM_ConvFloatFusedCPU4_##LABEL);                                    \
   BENCHMARK(BM_ConvFloatFwdGPU_##LABEL);                                       \
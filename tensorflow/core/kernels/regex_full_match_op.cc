@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -47,9 +48,15 @@ class RegexFullMatchOp : public OpKernel {
     OP_REQUIRES_OK(ctx, ctx->allocate_output("output", input_tensor->shape(),
                                              &output_tensor));
     auto output_flat = output_tensor->flat<bool>();
-    for (size_t i = 0; i < input_flat.size(); ++i) {
-      output_flat(i) = RE2::FullMatch(input_flat(i), match);
-    }
+    // RE2 objects can be used to match from several threads at once.
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    static constexpr int64 kCostPerMatch = 1000;
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          input_flat.size(), kCostPerMatch, [&](int64 start, int64 limit) {
+            for (int64 i = start; i < limit; ++i) {
+              output_flat(i) = RE2::FullMatch(input_flat(i), match);
+            }
+          });
   }
 };
 
@@ -52,6 +52,10 @@ limitations under the License.
 #endif
 
 #include "tensorflow/core/kernels/resource_variable_ops.h"
+
+#include <algorithm>
+#include <vector>
+
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/resource_mgr.h"
@@ -64,6 +68,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/training_op_helpers.h"
 #include "tensorflow/core/kernels/variable_ops.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
@@ -590,6 +595,108 @@ REGISTER_KERNEL_BUILDER(Name("ResourceGather")
 #undef REGISTER_GATHER_ALL_INDICES
 #undef REGISTER_GATHER_FULL
 
+namespace {
+
+// Sums the rows of 'updates' that target the same index, so that an additive
+// scatter writes each row of the variable only once.  Sets 'deduplicated' to
+// false and leaves the other outputs untouched if 'indices' has no
+// duplicates.  Otherwise fills 'unique_indices' with the distinct indices in
+// order of first appearance, 'summed_updates' with the sum of their rows in
+// order of appearance, and 'first_positions' with the offset of the first
+// occurrence of each distinct index in 'indices'.  The first invalid entry of
+// 'unique_indices' thus maps back to the first invalid entry of 'indices'.
+template <typename T, typename Index>
+Status SumDuplicateUpdates(OpKernelContext* c, const Tensor& indices,
+                           const Tensor& updates, bool* deduplicated,
+                           Tensor* unique_indices, Tensor* summed_updates,
+                           std::vector<Index>* first_positions) {
+  *deduplicated = false;
+  const auto indices_flat = indices.flat<Index>();
+  const Index N = static_cast<Index>(indices_flat.size());
+  if (N < 2) return Status::OK();
+
+  // Strictly increasing indices cannot have duplicates, so they are let
+  // through after a single pass that allocates nothing.
+  bool increasing = true;
+  for (Index i = 1; i < N && increasing; ++i) {
+    increasing = internal::SubtleMustCopy(indices_flat(i - 1)) <
+                 internal::SubtleMustCopy(indices_flat(i));
+  }
+  if (increasing) return Status::OK();
+
+  // Maps each distinct index to its row in 'summed_updates'.
+  gtl::FlatMap<Index, Index> rows(N);
+  std::vector<Index> row_of(N);
+  first_positions->clear();
+  for (Index i = 0; i < N; ++i) {
+    const Index index = internal::SubtleMustCopy(indices_flat(i));
+    const Index next_row = static_cast<Index>(first_positions->size());
+    auto it = rows.insert({index, next_row}).first;
+    if (it->second == next_row) first_positions->push_back(i);
+    row_of[i] = it->second;
+  }
+  const Index num_unique = static_cast<Index>(first_positions->size());
+  if (num_unique == N) return Status::OK();
+
+  const int64 row_size = updates.NumElements() / N;
+  TF_RETURN_IF_ERROR(c->allocate_temp(DataTypeToEnum<Index>::v(),
+                                      TensorShape({num_unique}),
+                                      unique_indices));
+  TF_RETURN_IF_ERROR(c->allocate_temp(DataTypeToEnum<T>::v(),
+                                      TensorShape({num_unique, row_size}),
+                                      summed_updates));
+  auto unique_flat = unique_indices->flat<Index>();
+  for (const auto& index_and_row : rows) {
+    unique_flat(index_and_row.second) = index_and_row.first;
+  }
+  const T* input = updates.flat<T>().data();
+  T* output = summed_updates->flat<T>().data();
+  for (Index i = 0; i < N; ++i) {
+    const T* row = input + i * row_size;
+    T* sum = output + row_of[i] * row_size;
+    if ((*first_positions)[row_of[i]] == i) {
+      std::copy(row, row + row_size, sum);
+    } else {
+      for (int64 j = 0; j < row_size; ++j) sum[j] += row[j];
+    }
+  }
+  *deduplicated = true;
+  return Status::OK();
+}
+
+// Only additive updates on CPU are deduplicated, other updates depend on the
+// order in which they are applied.
+template <typename Device, typename T, typename Index, scatter_op::UpdateOp op>
+struct DuplicateUpdateSummer {
+  Status operator()(OpKernelContext* c, const Tensor& indices,
+                    const Tensor& updates, bool* deduplicated,
+                    Tensor* unique_indices, Tensor* summed_updates,
+                    std::vector<Index>* first_positions) {
+    *deduplicated = false;
+    return Status::OK();
+  }
+};
+
+#define SUM_DUPLICATE_UPDATES(op)                                           \
+  template <typename T, typename Index>                                     \
+  struct DuplicateUpdateSummer<CPUDevice, T, Index, op> {                   \
+    Status operator()(OpKernelContext* c, const Tensor& indices,            \
+                      const Tensor& updates, bool* deduplicated,            \
+                      Tensor* unique_indices, Tensor* summed_updates,       \
+                      std::vector<Index>* first_positions) {                \
+      return SumDuplicateUpdates<T, Index>(c, indices, updates,             \
+                                           deduplicated, unique_indices,    \
+                                           summed_updates, first_positions); \
+    }                                                                       \
+  };
+
+SUM_DUPLICATE_UPDATES(scatter_op::UpdateOp::ADD);
+SUM_DUPLICATE_UPDATES(scatter_op::UpdateOp::SUB);
+
+#undef SUM_DUPLICATE_UPDATES
+
+}  // namespace
+
 template <typename Device, typename T, typename Index, scatter_op::UpdateOp op>
 class ResourceScatterUpdateOp : public OpKernel {
  public:
@@ -599,9 +706,6 @@ class ResourceScatterUpdateOp : public OpKernel {
     Var* v = nullptr;
     OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
     core::ScopedUnref unref_v(v);
-    mutex_lock ml(*v->mu());
-    Tensor* params = v->tensor();
-    OP_REQUIRES_OK(c, PrepareToUpdateVariable<Device, T>(c, params));
     const Tensor& indices = c->input(1);
     const Tensor& updates = c->input(2);
 
@@ -614,6 +718,33 @@ class ResourceScatterUpdateOp : public OpKernel {
                                 " indexing: ", N_big, " > ",
                                 std::numeric_limits<Index>::max()));
     const Index N = static_cast<Index>(N_big);
+    const bool scalar_update = TensorShapeUtils::IsScalar(updates.shape());
+    if (N > 0 && !scalar_update) {
+      OP_REQUIRES(c, updates.NumElements() % N == 0,
+                  errors::InvalidArgument(
+                      "shape of indices (", indices.shape().DebugString(),
+                      ") is not compatible with the shape of updates (",
+                      updates.shape().DebugString(), ")"));
+    }
+
+    // Additions to the same row commute, so on CPU the updates of duplicate
+    // indices are summed before taking the lock of the variable, which
+    // concurrent updates of hot rows (e.g. embeddings on a parameter server)
+    // contend on.
+    bool deduplicated = false;
+    Tensor unique_indices;
+    Tensor summed_updates;
+    std::vector<Index> first_positions;
+    if (!scalar_update) {
+      DuplicateUpdateSummer<Device, T, Index, op> summer;
+      OP_REQUIRES_OK(c, summer(c, indices, updates, &deduplicated,
+                               &unique_indices, &summed_updates,
+                               &first_positions));
+    }
+
+    mutex_lock ml(*v->mu());
+    Tensor* params = v->tensor();
+    OP_REQUIRES_OK(c, PrepareToUpdateVariable<Device, T>(c, params));
     OP_REQUIRES(
         c, params->dim_size(0) <= std::numeric_limits<Index>::max(),
         errors::InvalidArgument("params.shape[0] too large for ",
@@ -624,7 +755,7 @@ class ResourceScatterUpdateOp : public OpKernel {
     if (N > 0) {
       auto indices_flat = indices.flat<Index>();
       auto params_flat = params->flat_outer_dims<T>();
-      if (TensorShapeUtils::IsScalar(updates.shape())) {
+      if (scalar_update) {
         const auto update = updates.scalar<T>();
 
         functor::ScatterScalarFunctor<Device, T, Index, op> functor;
@@ -636,17 +767,20 @@ class ResourceScatterUpdateOp : public OpKernel {
                         " = ", indices_flat(bad_i), " is not in [0, ",
                         params->dim_size(0), ")"));
       } else {
-        int64 num_updates = updates.NumElements();
-        OP_REQUIRES(c, num_updates % N == 0,
-                    errors::InvalidArgument(
-                        "shape of indices (", indices.shape().DebugString(),
-                        ") is not compatible with the shape of updates (",
-                        updates.shape().DebugString(), ")"));
-        auto updates_flat = updates.shaped<T, 2>({N, num_updates / N});
+        const Tensor& scatter_indices =
+            deduplicated ? unique_indices : indices;
+        const Tensor& scatter_updates =
+            deduplicated ? summed_updates : updates;
+        const Index num_rows = scatter_indices.NumElements();
+        auto scatter_indices_flat = scatter_indices.flat<Index>();
+        auto updates_flat = scatter_updates.shaped<T, 2>(
+            {num_rows, scatter_updates.NumElements() / num_rows});
 
         functor::ScatterFunctor<Device, T, Index, op> functor;
-        const Index bad_i = functor(c, c->template eigen_device<Device>(),
-                                    params_flat, updates_flat, indices_flat);
+        Index bad_i =
+            functor(c, c->template eigen_device<Device>(), params_flat,
+                    updates_flat, scatter_indices_flat);
+        if (deduplicated && bad_i >= 0) bad_i = first_positions[bad_i];
         OP_REQUIRES(c, bad_i < 0,
                     errors::InvalidArgument(
                         "indices", SliceDebugString(indices.shape(), bad_i),
@@ -16,7 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_KERNELS_SCATTER_FUNCTOR_H_
 #define TENSORFLOW_KERNELS_SCATTER_FUNCTOR_H_
 
+#include <algorithm>
 #include <type_traits>
+#include <vector>
 
 #include "third_party/eigen3/Eigen/Core"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -184,6 +186,57 @@ struct AssignSYCL<scatter_op::UpdateOp::MAX> {
 };
 #endif  // TENSORFLOW_USE_SYCL
 
+// Scatters with fewer than this many updated elements are applied serially.
+constexpr int64 kMinParallelScatterSize = 64 * 1024;
+
+// Calls apply(i, indices(i)) for every i on the CPU worker threads.  The rows
+// of params are split into one contiguous range per thread, and the updates
+// of each range are applied by a single thread in the order of 'indices', so
+// that no two threads write to the same row and repeated indices are combined
+// in the same order as by a serial scatter.
+//
+// Returns the position of the first index outside [0, limit), in which case
+// no update is applied, or -1.
+template <typename Index, typename ApplyUpdate>
+Index ScatterByRowRanges(const CPUDevice& d,
+                         typename TTypes<Index>::ConstFlat indices,
+                         Index limit, int64 cost_per_update,
+                         const ApplyUpdate& apply) {
+  const Index N = static_cast<Index>(indices.size());
+  const int64 num_ranges = std::min<int64>(d.numThreads(), limit);
+  // Bucket the positions of the updates by the range of their row, keeping
+  // the positions of each range sorted.
+  std::vector<Index> safe_indices(N);
+  std::vector<Index> range_start(num_ranges + 1, 0);
+  for (Index i = 0; i < N; i++) {
+    // Grab the index and check its validity.  Do this carefully,
+    // to avoid checking the value and grabbing it again from
+    // memory a second time (a security risk since it may change in between).
+    const Index index = ::tensorflow::internal::SubtleMustCopy(indices(i));
+    if (!FastBoundsCheck(index, limit)) return i;
+    safe_indices[i] = index;
+    ++range_start[static_cast<int64>(index) * num_ranges / limit + 1];
+  }
+  for (int64 r = 0; r < num_ranges; ++r) {
+    range_start[r + 1] += range_start[r];
+  }
+  std::vector<Index> order(N);
+  {
+    std::vector<Index> next(range_start.begin(), range_start.end() - 1);
+    for (Index i = 0; i < N; i++) {
+      order[next[static_cast<int64>(safe_indices[i]) * num_ranges / limit]++] =
+          i;
+    }
+  }
+  const Eigen::TensorOpCost cost(0, 0, cost_per_update * N / num_ranges);
+  d.parallelFor(num_ranges, cost, [&](int64 begin, int64 end) {
+    for (Index k = range_start[begin]; k < range_start[end]; k++) {
+      apply(order[k], safe_indices[order[k]]);
+    }
+  });
+  return -1;
+}
+
 }  // namespace internal
 }  // namespace scatter_op
 
@@ -319,8 +372,27 @@ struct ScatterFunctorBase<CPUDevice, T, Index, scatter_op::UpdateOp::ASSIGN> {
 };
 
 template <typename T, typename Index, scatter_op::UpdateOp op>
-struct ScatterFunctor<CPUDevice, T, Index, op>
-    : ScatterFunctorBase<CPUDevice, T, Index, op> {};
+struct ScatterFunctor<CPUDevice, T, Index, op> {
+  Index operator()(OpKernelContext* c, const CPUDevice& d,
+                   typename TTypes<T>::Matrix params,
+                   typename TTypes<T>::ConstMatrix updates,
+                   typename TTypes<Index>::ConstFlat indices) {
+    const int64 cols = params.dimension(1);
+    const int64 size = static_cast<int64>(indices.size()) * cols;
+    if (d.numThreads() <= 1 ||
+        size < scatter_op::internal::kMinParallelScatterSize) {
+      return ScatterFunctorBase<CPUDevice, T, Index, op>()(c, d, params,
+                                                           updates, indices);
+    }
+    return scatter_op::internal::ScatterByRowRanges<Index>(
+        d, indices, static_cast<Index>(params.dimension(0)),
+        cols * sizeof(T), [&](Index i, Index index) {
+          // Copy last Ndim-1 dimensions of updates[i] to params[index]
+          scatter_op::internal::Assign<op>::Run(
+              params.template chip<0>(index), updates.template chip<0>(i));
+        });
+  }
+};
 
 #ifdef TENSORFLOW_USE_SYCL
 template <typename T, typename Index, scatter_op::UpdateOp op>
@@ -460,8 +532,27 @@ struct ScatterScalarFunctorBase<CPUDevice, T, Index,
 };
 
 template <typename T, typename Index, scatter_op::UpdateOp op>
-struct ScatterScalarFunctor<CPUDevice, T, Index, op>
-    : ScatterScalarFunctorBase<CPUDevice, T, Index, op> {};
+struct ScatterScalarFunctor<CPUDevice, T, Index, op> {
+  Index operator()(OpKernelContext* c, const CPUDevice& d,
+                   typename TTypes<T>::Matrix params,
+                   const typename TTypes<T>::ConstScalar update,
+                   typename TTypes<Index>::ConstFlat indices) {
+    const int64 cols = params.dimension(1);
+    const int64 size = static_cast<int64>(indices.size()) * cols;
+    if (d.numThreads() <= 1 ||
+        size < scatter_op::internal::kMinParallelScatterSize) {
+      return ScatterScalarFunctorBase<CPUDevice, T, Index, op>()(
+          c, d, params, update, indices);
+    }
+    return scatter_op::internal::ScatterByRowRanges<Index>(
+        d, indices, static_cast<Index>(params.dimension(0)),
+        cols * sizeof(T), [&](Index i, Index index) {
+          // Broadcast update to params[index]
+          scatter_op::internal::Assign<op>::RunScalar(
+              params.template chip<0>(index), update());
+        });
+  }
+};
 
 #ifdef TENSORFLOW_USE_SYCL
 template <typename T, typename Index, scatter_op::UpdateOp op>
@@ -23,6 +23,7 @@ limitations under the License.
 #include "third_party/eigen3/Eigen/Core"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/kernels/segment_reduction_ops.h"
+#include <algorithm>
 #include <vector>
 #include "tensorflow/core/framework/numeric_op.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -34,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
@@ -68,6 +70,67 @@ static bool SegmentReductionDoValidation(OpKernelContext* c,
   return c->status().ok();
 }
 
+// Checks that sorted segment ids are increasing and in [0, output_rows).
+template <typename Index>
+static void SortedSegmentIdsValidationHelper(OpKernelContext* context,
+                                             const Index* segment_ids,
+                                             int64 num_indices,
+                                             int64 output_rows) {
+  if (num_indices == 0) return;
+  Index out_index = internal::SubtleMustCopy(segment_ids[0]);
+  for (int64 i = 1; i <= num_indices; ++i) {
+    Index next_index = 0;
+    if (i < num_indices) {
+      next_index = internal::SubtleMustCopy(segment_ids[i]);
+      if (next_index == out_index) continue;
+      OP_REQUIRES(context, out_index < next_index,
+                  errors::InvalidArgument("segment ids are not increasing"));
+    }
+    OP_REQUIRES(
+        context, FastBoundsCheck(out_index, output_rows),
+        errors::InvalidArgument(
+            "Segment id ", out_index, " out of range [0, ", output_rows,
+            "), possibly because 'segment_ids' input is not sorted."));
+    out_index = next_index;
+  }
+}
+
+template <typename Index>
+static bool ValidateSortedSegmentIds(OpKernelContext* context,
+                                     const Index* segment_ids,
+                                     int64 num_indices, int64 output_rows) {
+  SortedSegmentIdsValidationHelper(context, segment_ids, num_indices,
+                                   output_rows);
+  return context->status().ok();
+}
+
+// Calls reduce_segment(out_index, start, end) for every output row of a
+// sorted segment reduction, where [start, end) is the range of the sorted
+// 'segment_ids' equal to out_index, which is empty if no input row has that
+// id.  The output rows are split into ranges reduced on the CPU worker
+// threads, so that each output row is written by a single thread.
+template <typename Index, typename ReduceSegment>
+static void ForEachSortedSegment(OpKernelContext* context,
+                                 const Index* segment_ids, int64 num_indices,
+                                 int64 output_rows, int64 num_col,
+                                 const ReduceSegment& reduce_segment) {
+  auto work = [&](int64 begin_row, int64 end_row) {
+    int64 start = std::lower_bound(segment_ids, segment_ids + num_indices,
+                                   begin_row) -
+                  segment_ids;
+    for (int64 out_index = begin_row; out_index < end_row; ++out_index) {
+      int64 end = start;
+      while (end < num_indices && segment_ids[end] == out_index) ++end;
+      reduce_segment(out_index, start, end);
+      start = end;
+    }
+  };
+  const int64 rows_per_segment = std::max<int64>(num_indices / output_rows, 1);
+  auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers, output_rows,
+        rows_per_segment * num_col, work);
+}
+
 // This operator handles reducing segments along the first dimension.
 // See core/ops/math_ops.cc for more details.
 template <typename Device, class T, class Index, typename Reducer,
@@ -111,69 +174,39 @@ class SegmentReductionOp : public OpKernel {
                 errors::InvalidArgument("segment ids must be >= 0"));
     auto output_flat = output->flat_outer_dims<T>();
 
+    const Index* segment_ids_data = segment_vec.data();
+    if (!ValidateSortedSegmentIds(context, segment_ids_data, num_indices,
+                                  output_rows)) {
+      return;
+    }
+
 #if !defined(EIGEN_HAS_INDEX_LIST)
     Eigen::DSizes<Eigen::DenseIndex, 1> dims_to_reduce;
     dims_to_reduce[0] = 0;
 #else
     Eigen::IndexList<Eigen::type2index<0> > dims_to_reduce;
 #endif
-    Index start = 0, end = 1;
-
-    Index uninitialized_index = 0;  // Index from which the output is not set.
-    Index out_index = internal::SubtleMustCopy(segment_vec(start));
-
-    // TODO(agarwal): if this loop becomes a bottleneck, consider sharding it
-    // across threads.
+    typedef Eigen::TensorMap<Eigen::Tensor<T, 1, Eigen::RowMajor>,
+                             Eigen::Unaligned>
+        OutT;
     Eigen::DSizes<Eigen::DenseIndex, 1> out_slice_shape(num_col);
-    while (end <= num_indices) {
-      // We initialize next_index to 0 to avoid "warning: 'next_index' may be
-      // used uninitialized in this function" in the Mac build (since the
-      // compiler isn't smart enough to realize the code is safe).
-      Index next_index = 0;
-      if (end < num_indices) {
-        next_index = internal::SubtleMustCopy(segment_vec(end));
-        if (out_index == next_index) {
-          ++end;
-          continue;
-        }
-        // We have a new segment here.  Verify that the segment ids are growing.
-        OP_REQUIRES(context, out_index < next_index,
-                    errors::InvalidArgument("segment ids are not increasing"));
-      }
-
-      // Process segment [start, end)
-      const T* in_slice_ptr = &input_flat(start, 0);
-      typedef Eigen::TensorMap<Eigen::Tensor<T, 1, Eigen::RowMajor>,
-                               Eigen::Unaligned>
-          OutT;
-
-      OP_REQUIRES(
-          context, FastBoundsCheck(out_index, output_rows),
-          errors::InvalidArgument(
-              "Segment id ", out_index, " out of range [0, ", output_rows,
-              "), possibly because 'segment_ids' input is not sorted."));
-
-      // If there is a gap between two indices, we need to set that gap to the
-      // default value.
-      if (out_index > uninitialized_index) {
-        Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
-            out_index - uninitialized_index, num_col);
-        Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>, Eigen::Unaligned>
-            gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
-        gap_slice.setConstant(T(default_value));
-      }
 
-      T* out_slice_ptr = &output_flat(out_index, 0);
-      OutT out_slice(out_slice_ptr, out_slice_shape);
+    // Reduces the rows [start, end) of the input, whose segment id is
+    // out_index, into row out_index of the output.
+    auto reduce_segment = [&](int64 out_index, int64 start, int64 end) {
+      OutT out_slice(&output_flat(out_index, 0), out_slice_shape);
       // We don't use out_slice.device(context->eigen_device<Device>)
       // because these pieces of work are likely to be very small and
       // the context switching overhead dwarfs any benefit we get from
       // using another thread to do this work.
-      if (start == end - 1) {
+      if (start == end) {
+        // Segment ids may skip some rows, which get the default value.
+        out_slice.setConstant(T(default_value));
+      } else if (start == end - 1) {
         typedef Eigen::TensorMap<Eigen::Tensor<const T, 1, Eigen::RowMajor>,
                                  Eigen::Unaligned>
             InT;
-        InT in_slice(in_slice_ptr, out_slice_shape);
+        InT in_slice(&input_flat(start, 0), out_slice_shape);
         out_slice = in_slice;
       } else {
         Eigen::DSizes<Eigen::DenseIndex, 2> in_slice_shape(end - start,
@@ -181,16 +214,13 @@ class SegmentReductionOp : public OpKernel {
         typedef Eigen::TensorMap<Eigen::Tensor<const T, 2, Eigen::RowMajor>,
                                  Eigen::Unaligned>
             InT;
-        InT in_slice(in_slice_ptr, in_slice_shape);
+        InT in_slice(&input_flat(start, 0), in_slice_shape);
 
         out_slice = in_slice.reduce(dims_to_reduce, Reducer());
       }
-      if (end >= num_indices) break;
-      start = end;
-      ++end;
-      uninitialized_index = out_index + 1;
-      out_index = next_index;
-    }
+    };
+    ForEachSortedSegment(context, segment_ids_data, num_indices, output_rows,
+                         num_col, reduce_segment);
   }
 };
 
@@ -377,19 +407,38 @@ struct UnsortedSegmentFunctor<CPUDevice, T, Index, InitialValueF, ReductionF> {
       return;
     }
     const int64 N = segment_ids.dimension(0);
-    ReductionF reduction;
-    auto data_flat = typename TTypes<T, 2>::ConstTensor(data, N, data_size / N);
     for (int64 i = 0; i < N; ++i) {
       Index j = internal::SubtleMustCopy(segment_ids(i));
-      if (j < 0) {
-        continue;
-      }
-      OP_REQUIRES(ctx, FastBoundsCheck(j, num_segments),
+      OP_REQUIRES(ctx, j < 0 || FastBoundsCheck(j, num_segments),
                   errors::InvalidArgument(
                       "segment_ids", SliceDebugString(segment_ids_shape, i),
                       " = ", j, " is out of range [0, ", num_segments, ")"));
-      reduction(data_flat.template chip<0>(i), output.template chip<0>(j));
     }
+    // All the segment ids are negative, so there is nothing to reduce.
+    if (num_segments == 0) return;
+
+    const int64 num_col = data_size / N;
+    auto data_flat = typename TTypes<T, 2>::ConstTensor(data, N, num_col);
+    // Each shard owns a range of output rows and scans all the segment ids
+    // for the input rows that reduce into them, so no two threads write to
+    // the same row and no partial results need to be merged.  The rows of
+    // each segment are still reduced in order.
+    auto work = [&](int64 begin_segment, int64 end_segment) {
+      ReductionF reduction;
+      for (int64 i = 0; i < N; ++i) {
+        const Index j = segment_ids(i);
+        if (j < begin_segment || j >= end_segment) continue;
+        reduction(data_flat.template chip<0>(i), output.template chip<0>(j));
+      }
+    };
+    // Scanning the segment ids costs about as much as reducing one column of
+    // the data, so more shards than columns would not pay off.
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    const int max_parallelism =
+        std::min<int64>(worker_threads->num_threads, num_col);
+    const int64 rows_per_segment = std::max<int64>(N / num_segments, 1);
+    Shard(max_parallelism, worker_threads->workers, num_segments,
+          rows_per_segment * num_col, work);
   }
 };
 
@@ -691,67 +740,35 @@ class SparseSegmentReductionOpBase : public OpKernel {
                 errors::InvalidArgument("segment ids must be >= 0"));
     auto output_flat = output->flat_outer_dims<T>();
 
-    int64 start = 0, end = 1;
-    // Index from which the output is not initialized.
-    OutputRow uninitialized_index = 0;
-    OutputRow out_index = internal::SubtleMustCopy(segment_vec(start));
-
-    while (true) {
-      // We initialize next_index to 0 to avoid "warning: 'next_index' may be
-      // used uninitialized in this function" in the Mac build (since the
-      // compiler isn't smart enough to realize the code is safe).
-      OutputRow next_index = 0;
-      if (end < num_indices) {
-        next_index = internal::SubtleMustCopy(segment_vec(end));
-        if (out_index == next_index) {
-          ++end;
-          continue;
-        }
-        // We have a new segment here.  Verify that the segment ids are growing.
-        OP_REQUIRES(context, out_index < next_index,
-                    errors::InvalidArgument("segment ids are not increasing"));
-      }
-
-      OP_REQUIRES(
-          context, FastBoundsCheck(out_index, output_rows),
-          errors::InvalidArgument(
-              "Segment id ", out_index, " out of range [0, ", output_rows,
-              "), possibly because 'segment_ids' input is not sorted."));
-
-      // If there is a gap between two indices, we need to set that gap to the
-      // default value.
-      if (out_index > uninitialized_index) {
-        Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
-            out_index - uninitialized_index, num_col);
-        Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>, Eigen::Unaligned>
-            gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
-        gap_slice.setConstant(default_value_);
-      }
+    const OutputRow* segment_ids_data = segment_vec.data();
+    if (!ValidateSortedSegmentIds(context, segment_ids_data, num_indices,
+                                  output_rows)) {
+      return;
+    }
 
+    // The first index out of range in indices, if any.
+    mutex mu;
+    int64 bad_index = num_indices;
+    auto reduce_segment = [&](int64 out_index, int64 start, int64 end) {
       auto out = output_flat.template chip<0>(out_index);
-      const int bad_offset =
+      if (start == end) {
+        // Segment ids may skip some rows, which get the default value.
+        out.setConstant(default_value_);
+        return;
+      }
+      const int64 bad_offset =
           Reduce(input_flat, indices_vec, start, end - start, out);
-      OP_REQUIRES(context, bad_offset < 0,
-                  errors::InvalidArgument(
-                      "Bad: indices[", start + bad_offset,
-                      "] == ", indices_vec(start + bad_offset),
-                      " out of range [0, ", input_flat.dimension(0), ")"));
-
-      start = end;
-      ++end;
-      uninitialized_index = out_index + 1;
-      out_index = next_index;
-      if (end > num_indices) break;
-    }
-
-    // Fill the gap at the end with the default value.
-    if (uninitialized_index < output_rows) {
-      Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
-          output_rows - uninitialized_index, num_col);
-      Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>, Eigen::Unaligned>
-          gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
-      gap_slice.setConstant(default_value_);
-    }
+      if (bad_offset >= 0) {
+        mutex_lock l(mu);
+        bad_index = std::min(bad_index, start + bad_offset);
+      }
+    };
+    ForEachSortedSegment(context, segment_ids_data, num_indices, output_rows,
+                         num_col, reduce_segment);
+    OP_REQUIRES(context, bad_index == num_indices,
+                errors::InvalidArgument(
+                    "Bad: indices[", bad_index, "] == ", indices_vec(bad_index),
+                    " out of range [0, ", input_flat.dimension(0), ")"));
   }
 
  private:
@@ -166,4 +166,46 @@ static void BM_SparseSegmentMeanGrad_High(int iters, int size) {
 BENCHMARK(BM_SparseSegmentMeanGrad_Low)->Arg(1000)->Arg(100000);
 BENCHMARK(BM_SparseSegmentMeanGrad_High)->Arg(1000)->Arg(100000);
 
+static void UnsortedSegmentSumHelper(int iters, int num_segments,
+                                     int embedding_size) {
+  testing::StopTiming();
+  Graph* g = new Graph(OpRegistry::Global());
+
+  const int kNumRows = 100000;
+  Tensor input(DT_FLOAT, TensorShape({kNumRows, embedding_size}));
+  input.flat<float>().setRandom();
+  Tensor segment_ids(DT_INT32, TensorShape({kNumRows}));
+  auto segment_ids_flat = segment_ids.flat<int32>();
+  for (int i = 0; i < kNumRows; ++i) {
+    segment_ids_flat(i) = (i * 31) % num_segments;
+  }
+  Tensor num_segments_t(DT_INT32, TensorShape({}));
+  num_segments_t.scalar<int32>()() = num_segments;
+
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "UnsortedSegmentSum")
+                  .Input(test::graph::Constant(g, input))
+                  .Input(test::graph::Constant(g, segment_ids))
+                  .Input(test::graph::Constant(g, num_segments_t))
+                  .Attr("T", DT_FLOAT)
+                  .Finalize(g, &node));
+
+  testing::UseRealTime();
+  testing::BytesProcessed(static_cast<int64>(iters) * kNumRows *
+                          embedding_size * sizeof(float));
+  testing::StartTiming();
+  test::Benchmark("cpu", g).Run(iters);
+}
+
+static void BM_UnsortedSegmentSum_Dim16(int iters, int num_segments) {
+  return UnsortedSegmentSumHelper(iters, num_segments, 16);
+}
+
+static void BM_UnsortedSegmentSum_Dim128(int iters, int num_segments) {
+  return UnsortedSegmentSumHelper(iters, num_segments, 128);
+}
+
+BENCHMARK(BM_UnsortedSegmentSum_Dim16)->Arg(10)->Arg(1000)->Arg(100000);
+BENCHMARK(BM_UnsortedSegmentSum_Dim128)->Arg(10)->Arg(1000)->Arg(100000);
+
 }  // namespace tensorflow
@@ -43,6 +43,7 @@ class RecvOp : public AsyncOpKernel {
   string key_prefix_;
   Rendezvous::ParsedKey parsed_key_;
   bool hostmem_sendrecv_;
+  bool allow_tensor_compression_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(RecvOp);
 };
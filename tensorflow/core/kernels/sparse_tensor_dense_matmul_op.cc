@@ -19,6 +19,9 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/sparse_tensor_dense_matmul_op.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/kernels/bounds_check.h"
@@ -243,6 +246,11 @@ template <typename T, typename Tindices, bool ADJ_A, bool ADJ_B>
 struct SparseTensorDenseMatMulFunctor<CPUDevice, T, Tindices, ADJ_A, ADJ_B> {
   // Vectorize certain operations above this size.
   static const std::size_t kNumVectorize = 32;
+  // Below this many multiply-adds, the product is computed on one thread.
+  static const int64 kMinParallelWork = 64 * 1024;
+  // Number of columns of the output updated together by the parallel
+  // implementation, so that they stay in cache across the entries of a row.
+  static const int64 kColumnBlock = 1024;
 
   static Status Compute(const CPUDevice& d, typename TTypes<T>::Matrix out,
                         typename TTypes<Tindices>::ConstMatrix a_indices,
@@ -254,11 +262,12 @@ struct SparseTensorDenseMatMulFunctor<CPUDevice, T, Tindices, ADJ_A, ADJ_B> {
     const int lhs_index_a = ADJ_A ? 1 : 0;
     const int rhs_index_a = ADJ_A ? 0 : 1;
 
-    out.setZero();
+    if (d.numThreads() > 1 && out.dimension(0) > 1 &&
+        static_cast<int64>(nnz * rhs_right) >= kMinParallelWork) {
+      return ComputeParallel(d, out, a_indices, a_values, b);
+    }
 
-    // TODO(ebrevdo): After many failed experiments, can't find a multi-threaded
-    // approach that achieves the performance of the single threaded
-    // one.  Perhaps Eigen threadpool implementation is just too slow?
+    out.setZero();
 
     if (rhs_right < kNumVectorize) {
       // Disable vectorization if the RHS of output is too small
@@ -312,6 +321,117 @@ struct SparseTensorDenseMatMulFunctor<CPUDevice, T, Tindices, ADJ_A, ADJ_B> {
     }
     return Status::OK();
   }
+
+ private:
+  // Converts a to CSR, sorting its entries by output row, then computes the
+  // rows of the output in parallel.  The entries of each row keep their
+  // order, so the results are the same as with the serial loop above.
+  static Status ComputeParallel(
+      const CPUDevice& d, typename TTypes<T>::Matrix out,
+      typename TTypes<Tindices>::ConstMatrix a_indices,
+      typename TTypes<T>::ConstVec a_values,
+      typename TTypes<T>::ConstMatrix b) {
+    const int64 nnz = a_values.size();
+    const int64 out_rows = out.dimension(0);
+    const int64 rhs_right = (ADJ_B ? b.dimension(0) : b.dimension(1));
+    const int64 lhs_right = (ADJ_B ? b.dimension(1) : b.dimension(0));
+    const int lhs_index_a = ADJ_A ? 1 : 0;
+    const int rhs_index_a = ADJ_A ? 0 : 1;
+
+    std::vector<Tindices> entry_rows(nnz);
+    std::vector<Tindices> entry_cols(nnz);
+    std::vector<int64> row_start(out_rows + 1, 0);
+    for (int64 i = 0; i < nnz; ++i) {
+      const Tindices m = internal::SubtleMustCopy(a_indices(i, lhs_index_a));
+      const Tindices k = internal::SubtleMustCopy(a_indices(i, rhs_index_a));
+      if (!FastBoundsCheck(k, lhs_right)) {
+        return KOutOfBoundsError(k, i, rhs_index_a, lhs_right);
+      }
+      if (!FastBoundsCheck(m, out_rows)) {
+        return MOutOfBoundsError(m, i, lhs_index_a, out_rows);
+      }
+      entry_rows[i] = m;
+      entry_cols[i] = k;
+      ++row_start[m + 1];
+    }
+    for (int64 m = 0; m < out_rows; ++m) {
+      row_start[m + 1] += row_start[m];
+    }
+    std::vector<Tindices> cols(nnz);
+    std::vector<T> values(nnz);
+    {
+      std::vector<int64> next(row_start.begin(), row_start.end() - 1);
+      for (int64 i = 0; i < nnz; ++i) {
+        const int64 e = next[entry_rows[i]]++;
+        cols[e] = entry_cols[i];
+        values[e] = ADJ_A ? MaybeConj(a_values(i)) : a_values(i);
+      }
+    }
+
+    const double nnz_per_row = static_cast<double>(nnz) / out_rows;
+    const Eigen::TensorOpCost cost(
+        /*bytes_loaded=*/nnz_per_row * rhs_right * sizeof(T),
+        /*bytes_stored=*/rhs_right * sizeof(T),
+        /*compute_cycles=*/nnz_per_row * rhs_right *
+            (Eigen::TensorOpCost::MulCost<T>() +
+             Eigen::TensorOpCost::AddCost<T>()));
+
+    if (rhs_right < static_cast<int64>(kNumVectorize)) {
+      auto maybe_adjoint_b = MaybeAdjoint<decltype(b), ADJ_B>(b);
+      d.parallelFor(out_rows, cost, [&](int64 begin, int64 end) {
+        for (int64 m = begin; m < end; ++m) {
+          for (int64 n = 0; n < rhs_right; ++n) out(m, n) = T(0);
+          for (int64 e = row_start[m]; e < row_start[m + 1]; ++e) {
+            for (int64 n = 0; n < rhs_right; ++n) {
+              out(m, n) += values[e] * maybe_adjoint_b(cols[e], n);
+            }
+          }
+        }
+      });
+    } else if (ADJ_B) {
+      // Perform transpose and conjugation on B once, since we chip out B's
+      // columns in the row loop.
+      Eigen::array<int, 2> shuffle(1, 0);  // preserve dimension order
+      Eigen::Tensor<T, 2, Eigen::ColMajor> col_major_conj_b(b.dimension(1),
+                                                            b.dimension(0));
+      col_major_conj_b.device(d) = b.swap_layout().shuffle(shuffle).conjugate();
+      MultiplyRows<1>(d, cost, row_start, cols, values, col_major_conj_b, out);
+    } else {
+      MultiplyRows<0>(d, cost, row_start, cols, values, b, out);
+    }
+    return Status::OK();
+  }
+
+  // Computes each row of the output as the sum of the chips of b selected
+  // by the columns of the row of a, one block of columns at a time.
+  template <int b_chip_index, typename BMatrix>
+  static void MultiplyRows(const CPUDevice& d, const Eigen::TensorOpCost& cost,
+                           const std::vector<int64>& row_start,
+                           const std::vector<Tindices>& cols,
+                           const std::vector<T>& values, const BMatrix& b,
+                           typename TTypes<T>::Matrix out) {
+    const int64 rhs_right = out.dimension(1);
+    // A local copy, so that std::min doesn't bind a reference to the static
+    // member.
+    const int64 column_block = kColumnBlock;
+    d.parallelFor(out.dimension(0), cost, [&](int64 begin, int64 end) {
+      for (int64 m = begin; m < end; ++m) {
+        auto out_row = out.template chip<0>(m);
+        for (int64 c = 0; c < rhs_right; c += column_block) {
+          const Eigen::array<Eigen::DenseIndex, 1> offset = {c};
+          const Eigen::array<Eigen::DenseIndex, 1> extent = {
+              std::min(column_block, rhs_right - c)};
+          auto out_block = out_row.slice(offset, extent);
+          out_block.setZero();
+          for (int64 e = row_start[m]; e < row_start[m + 1]; ++e) {
+            out_block += b.template chip<b_chip_index>(cols[e])
+                             .slice(offset, extent) *
+                         values[e];
+          }
+        }
+      }
+    });
+  }
 };
 
 }  // namespace functor
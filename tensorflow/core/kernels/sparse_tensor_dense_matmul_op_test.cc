@@ -112,6 +112,13 @@ BM_SparseTensorDenseMatmul(16384, 128, 1024, 16, false, false);
 BM_SparseTensorDenseMatmul(16384, 4096, 4096, 128, false, false);
 BM_SparseTensorDenseMatmul(16384, 4096, 4096, 1024, false, false);
 
+// 0.1%, 1% and 10% dense 4096 x 4096 matrices.
+BM_SparseTensorDenseMatmul(16777, 4096, 4096, 128, false, false);
+BM_SparseTensorDenseMatmul(167772, 4096, 4096, 128, false, false);
+BM_SparseTensorDenseMatmul(1677721, 4096, 4096, 128, false, false);
+BM_SparseTensorDenseMatmul(167772, 4096, 4096, 128, true, false);
+BM_SparseTensorDenseMatmul(167772, 4096, 4096, 128, false, true);
+
 BM_SparseTensorDenseMatmul(16384, 4096, 4096, 4096, false, false);
 BM_SparseTensorDenseMatmul(16384, 4096, 4096, 4096, false, true);
 BM_SparseTensorDenseMatmul(16384, 4096, 4096, 4096, true, false);
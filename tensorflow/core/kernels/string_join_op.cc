@@ -22,7 +22,6 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
-#include "tensorflow/core/lib/strings/str_util.h"
 
 namespace tensorflow {
 
@@ -62,12 +61,21 @@ class StringJoinOp : public OpKernel {
                                                      &output_tensor));
     auto output_flat = output_tensor->flat<string>();
 
+    // Each output string is built in place with a single allocation.
     std::vector<StringPiece> strings(input_list.size());
     for (size_t i = 0; i < input_shape.num_elements(); ++i) {
+      size_t output_size = 0;
       for (int j = 0; j < input_list.size(); ++j) {
         strings[j] = (is_scalar[j]) ? inputs[j](0) : inputs[j](i);
+        if (j > 0) output_size += separator_.size();
+        output_size += strings[j].size();
+      }
+      string& output = output_flat(i);
+      output.reserve(output_size);
+      for (int j = 0; j < input_list.size(); ++j) {
+        if (j > 0) output.append(separator_);
+        output.append(strings[j].data(), strings[j].size());
       }
-      output_flat(i) = str_util::Join(strings, separator_.c_str());
     }
   }
 
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include <string>
+#include <utility>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/kernel_def_builder.h"
@@ -25,7 +26,9 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/bounds_check.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/util/bcast.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -63,28 +66,18 @@ class SubstrOp : public OpKernel {
             tensorflow::internal::SubtleMustCopy(pos_tensor.scalar<T>()());
         const T len =
             tensorflow::internal::SubtleMustCopy(len_tensor.scalar<T>()());
-        for (size_t i = 0; i < input_tensor.NumElements(); ++i) {
-          string in = input(i);
-          OP_REQUIRES(
-              context, FastBoundsCheck(pos, in.size() + 1),
-              errors::InvalidArgument("pos ", pos, " out of range for string",
-                                      "b'", in, "' at index ", i));
-          output(i) = in.substr(pos, len);
-        }
+        ElementwiseSubstr(context, input, output, [pos, len](int64 i) {
+          return std::make_pair(pos, len);
+        });
       } else {
         // Perform Op element-wise with tensor pos/len
         auto pos_flat = pos_tensor.flat<T>();
         auto len_flat = len_tensor.flat<T>();
-        for (size_t i = 0; i < input_tensor.NumElements(); ++i) {
-          string in = input(i);
-          const T pos = tensorflow::internal::SubtleMustCopy(pos_flat(i));
-          const T len = tensorflow::internal::SubtleMustCopy(len_flat(i));
-          OP_REQUIRES(
-              context, FastBoundsCheck(pos, in.size() + 1),
-              errors::InvalidArgument("pos ", pos, " out of range for string",
-                                      "b'", in, "' at index ", i));
-          output(i) = in.substr(pos, len);
-        }
+        ElementwiseSubstr(context, input, output, [&](int64 i) {
+          return std::make_pair(
+              tensorflow::internal::SubtleMustCopy(pos_flat(i)),
+              tensorflow::internal::SubtleMustCopy(len_flat(i)));
+        });
       }
     } else {
       // Perform op with broadcasting
@@ -213,6 +206,46 @@ class SubstrOp : public OpKernel {
       }
     }
   }
+
+ private:
+  // Sets output(i) to the substring of input(i) at the position and length
+  // returned by pos_len(i), on the CPU worker threads.  Reports the first
+  // position that is out of range, as a serial loop would.
+  template <typename PosLenFn>
+  static void ElementwiseSubstr(OpKernelContext* context,
+                                TTypes<string>::ConstFlat input,
+                                TTypes<string>::Flat output,
+                                const PosLenFn& pos_len) {
+    mutex mu;
+    int64 bad_index = input.size();
+    T bad_pos = 0;
+    auto work = [&](int64 start, int64 limit) {
+      for (int64 i = start; i < limit; ++i) {
+        const string& in = input(i);
+        const std::pair<T, T> pos_and_len = pos_len(i);
+        if (!FastBoundsCheck(pos_and_len.first, in.size() + 1)) {
+          mutex_lock l(mu);
+          if (i < bad_index) {
+            bad_index = i;
+            bad_pos = pos_and_len.first;
+          }
+          return;
+        }
+        output(i) = in.substr(pos_and_len.first, pos_and_len.second);
+      }
+    };
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, input.size(),
+          kCostPerSubstr, work);
+    OP_REQUIRES(context, bad_index == input.size(),
+                errors::InvalidArgument("pos ", bad_pos,
+                                        " out of range for string", "b'",
+                                        input(bad_index), "' at index ",
+                                        bad_index));
+  }
+
+  // Estimated cycles to copy out a typical substring.
+  static constexpr int64 kCostPerSubstr = 200;
 };
 
 #define REGISTER_SUBSTR(type)                                      \
@@ -26,7 +26,8 @@ namespace tensorflow {
 
 namespace internal {
 
-// Device-specific naive implementation for tile.
+// Device-specific implementation for tile, used for the ranks that are not
+// handled by Eigen and, on the CPU, for all non-scalar inputs.
 template <typename Device, typename T>
 void TileSimple(const Device& d, Tensor* out, const Tensor& in);
 
@@ -63,6 +64,13 @@ template <typename Device, typename T, typename Tmultiples>
 struct Tile {
   void operator()(const Device& d, Tensor* out, const Tensor& in,
                   const gtl::ArraySlice<Tmultiples> broadcast_array) const {
+    // The CPU copies whole rows and slabs of the output, which is faster than
+    // broadcasting element by element.
+    if (Eigen::internal::is_same<Device, Eigen::ThreadPoolDevice>::value &&
+        in.dims() > 0) {
+      internal::TileSimple<Device, T>(d, out, in);
+      return;
+    }
     switch (in.dims()) {
       case 0:
         internal::TileUsingEigen<Device, T, Tmultiples>(d, out, in,
@@ -15,6 +15,8 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/kernels/ops_util.h"
@@ -24,24 +26,106 @@ namespace tensorflow {
 
 namespace internal {
 
+namespace {
+
 template <typename Device, typename T>
-void TileSimple(const Device& d, Tensor* out, const Tensor& in) {
-  const int ndims = in.dims();
-  const int64 nelem = out->NumElements();
-  gtl::InlinedVector<int64, 8> in_strides = ComputeStride<int64>(in.shape());
-  gtl::InlinedVector<int64, 8> out_strides = ComputeStride<int64>(out->shape());
-  const T* p = in.flat<T>().data();
-  T* q = out->flat<T>().data();
-
-  for (int64 o_idx = 0; o_idx < nelem; ++o_idx) {
-    int64 i_idx = 0;
-    int64 t = o_idx;
-    for (int i = 0; i < ndims; ++i) {
-      i_idx += t / out_strides[i] % in.dim_size(i) * in_strides[i];
-      t %= out_strides[i];
+struct TileImpl {
+  static void Run(const Device& d, Tensor* out, const Tensor& in) {
+    const int ndims = in.dims();
+    const int64 nelem = out->NumElements();
+    gtl::InlinedVector<int64, 8> in_strides = ComputeStride<int64>(in.shape());
+    gtl::InlinedVector<int64, 8> out_strides =
+        ComputeStride<int64>(out->shape());
+    const T* p = in.flat<T>().data();
+    T* q = out->flat<T>().data();
+
+    for (int64 o_idx = 0; o_idx < nelem; ++o_idx) {
+      int64 i_idx = 0;
+      int64 t = o_idx;
+      for (int i = 0; i < ndims; ++i) {
+        i_idx += t / out_strides[i] % in.dim_size(i) * in_strides[i];
+        t %= out_strides[i];
+      }
+      q[o_idx] = p[i_idx];
+    }
+  }
+};
+
+// Returns the offset in 'out' of the element at the given index in the first
+// 'ndims' dimensions of 'in', with all other indices zero.
+inline int64 TileOffset(const Tensor& in,
+                        const gtl::InlinedVector<int64, 8>& out_strides,
+                        int ndims, int64 index) {
+  int64 offset = 0;
+  for (int i = ndims - 1; i >= 0; --i) {
+    offset += index % in.dim_size(i) * out_strides[i];
+    index /= in.dim_size(i);
+  }
+  return offset;
+}
+
+// Tiles by copying contiguous runs of elements on the CPU worker threads.
+// First every row of 'in' is copied, repeated along the innermost dimension,
+// into the corner of 'out' that holds the first copy of each dimension.  Then,
+// from the innermost dimension outwards, the slabs of 'out' that were filled
+// are copied along their dimension.
+template <typename T>
+struct TileImpl<Eigen::ThreadPoolDevice, T> {
+  static void Run(const Eigen::ThreadPoolDevice& d, Tensor* out,
+                  const Tensor& in) {
+    const int ndims = in.dims();
+    if (out->NumElements() == 0) return;
+    gtl::InlinedVector<int64, 8> out_strides =
+        ComputeStride<int64>(out->shape());
+    const T* p = in.flat<T>().data();
+    T* q = out->flat<T>().data();
+
+    const int64 row_size = in.dim_size(ndims - 1);
+    const int64 row_multiple = out->dim_size(ndims - 1) / row_size;
+    const int64 num_rows = in.NumElements() / row_size;
+    auto copy_rows = [&](int64 begin, int64 end) {
+      for (int64 row = begin; row < end; ++row) {
+        const T* src = p + row * row_size;
+        T* dst = q + TileOffset(in, out_strides, ndims - 1, row);
+        for (int64 m = 0; m < row_multiple; ++m) {
+          dst = std::copy(src, src + row_size, dst);
+        }
+      }
+    };
+    const int64 row_bytes = row_size * row_multiple * sizeof(T);
+    d.parallelFor(num_rows,
+                  Eigen::TensorOpCost(row_bytes / row_multiple, row_bytes,
+                                      /*compute_cycles=*/0),
+                  copy_rows);
+
+    for (int dim = ndims - 2; dim >= 0; --dim) {
+      const int64 multiple = out->dim_size(dim) / in.dim_size(dim);
+      if (multiple == 1) continue;
+      const int64 slab_size = in.dim_size(dim) * out_strides[dim];
+      int64 num_slabs = 1;
+      for (int i = 0; i < dim; ++i) num_slabs *= in.dim_size(i);
+      auto copy_slabs = [&](int64 begin, int64 end) {
+        for (int64 unit = begin; unit < end; ++unit) {
+          const int64 slab = unit / (multiple - 1);
+          const int64 copy = unit % (multiple - 1) + 1;
+          T* src = q + TileOffset(in, out_strides, dim, slab);
+          std::copy(src, src + slab_size, src + copy * slab_size);
+        }
+      };
+      const int64 slab_bytes = slab_size * sizeof(T);
+      d.parallelFor(num_slabs * (multiple - 1),
+                    Eigen::TensorOpCost(slab_bytes, slab_bytes,
+                                        /*compute_cycles=*/0),
+                    copy_slabs);
     }
-    q[o_idx] = p[i_idx];
   }
+};
+
+}  // namespace
+
+template <typename Device, typename T>
+void TileSimple(const Device& d, Tensor* out, const Tensor& in) {
+  TileImpl<Device, T>::Run(d, out, in);
 }
 
 }  // end namespace internal
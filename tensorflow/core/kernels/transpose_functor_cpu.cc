@@ -15,6 +15,7 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <complex>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -65,12 +66,136 @@ void TransposeSimple(const CPUDevice& device, const Tensor& in,
   device.parallelFor(in.NumElements(), cost, std::move(transpose_fn));
 }
 
+// Transposes a tile of rows [0, NumRows) and columns [0, NumCols) of a
+// matrix with row stride in_stride into a matrix with row stride out_stride.
+// Full tiles have compile-time bounds so that the compiler can unroll them.
+template <typename T, bool conjugate, int64 NumRows, int64 NumCols>
+inline void TransposeTile(const T* in, int64 in_stride, T* out,
+                          int64 out_stride) {
+  for (int64 c = 0; c < NumCols; ++c) {
+    for (int64 r = 0; r < NumRows; ++r) {
+      const T& value = in[r * in_stride + c];
+      out[c * out_stride + r] = conjugate ? Eigen::numext::conj(value) : value;
+    }
+  }
+}
+
+template <typename T, bool conjugate>
+inline void TransposeTile(const T* in, int64 in_stride, T* out,
+                          int64 out_stride, int64 num_rows, int64 num_cols) {
+  for (int64 c = 0; c < num_cols; ++c) {
+    for (int64 r = 0; r < num_rows; ++r) {
+      const T& value = in[r * in_stride + c];
+      out[c * out_stride + r] = conjugate ? Eigen::numext::conj(value) : value;
+    }
+  }
+}
+
+// Transposes 'in' one cache-line sized tile at a time when the permutation
+// moves the innermost dimension, so that both the input and the output are
+// accessed a cache line at a time.  The tiles of each outer index and block
+// of output rows are transposed on the CPU worker threads.  Returns false,
+// without touching 'out', if the transpose is better left to Eigen.
+template <typename T, bool conjugate>
+bool TransposeTiled(const CPUDevice& device, const Tensor& in,
+                    const gtl::ArraySlice<int32> perm, Tensor* out) {
+  static constexpr int64 kTile = sizeof(T) >= 16 ? 4 : 64 / sizeof(T);
+
+  internal::TransposePermsVec new_perm;
+  internal::TransposeDimsVec new_dims;
+  internal::ReduceTransposeDimensions(in.shape(), perm, &new_perm, &new_dims);
+  const int ndims = new_dims.size();
+  if (ndims < 2) return false;
+
+  // The input is viewed as a batch of [num_rows, num_cols] matrices, where
+  // the columns are the innermost input dimension and the rows are the input
+  // dimension that becomes the innermost output dimension.
+  const int col_dim = ndims - 1;
+  const int row_dim = new_perm[ndims - 1];
+  if (row_dim == col_dim) return false;
+  const int64 num_rows = new_dims[row_dim];
+  const int64 num_cols = new_dims[col_dim];
+  if (num_rows < kTile || num_cols < kTile) return false;
+
+  internal::TransposeDimsVec in_strides(ndims);
+  internal::TransposeDimsVec out_strides(ndims);
+  internal::TransposePermsVec out_position(ndims);
+  in_strides[ndims - 1] = 1;
+  out_strides[ndims - 1] = 1;
+  for (int i = ndims - 2; i >= 0; --i) {
+    in_strides[i] = in_strides[i + 1] * new_dims[i + 1];
+    out_strides[i] = out_strides[i + 1] * new_dims[new_perm[i + 1]];
+  }
+  for (int i = 0; i < ndims; ++i) out_position[new_perm[i]] = i;
+  const int64 in_row_stride = in_strides[row_dim];
+  const int64 out_row_stride = out_strides[out_position[col_dim]];
+
+  // The remaining input dimensions index the batch of matrices.
+  gtl::InlinedVector<int, 8> outer_dims;
+  int64 num_outer = 1;
+  for (int i = 0; i < ndims; ++i) {
+    if (i != row_dim && i != col_dim) {
+      outer_dims.push_back(i);
+      num_outer *= new_dims[i];
+    }
+  }
+
+  const T* p = reinterpret_cast<const T*>(in.tensor_data().data());
+  T* q = reinterpret_cast<T*>(const_cast<char*>((out->tensor_data().data())));
+  // Each unit of work transposes a block of kRowBlock rows by kTile columns
+  // of one matrix, so that tall and skinny matrices are still split over
+  // all the threads.
+  static constexpr int64 kRowBlock = 32 * kTile;
+  const int64 num_col_blocks = (num_cols + kTile - 1) / kTile;
+  const int64 num_row_blocks = (num_rows + kRowBlock - 1) / kRowBlock;
+  auto transpose_fn = [&](int64 begin, int64 end) {
+    for (int64 unit = begin; unit < end; ++unit) {
+      const int64 c0 = (unit % num_col_blocks) * kTile;
+      const int64 c1 = std::min(c0 + kTile, num_cols);
+      const int64 row_block = unit / num_col_blocks;
+      const int64 r_begin = (row_block % num_row_blocks) * kRowBlock;
+      const int64 r_end = std::min(r_begin + kRowBlock, num_rows);
+      int64 outer = row_block / num_row_blocks;
+      int64 in_offset = 0;
+      int64 out_offset = 0;
+      for (int i = outer_dims.size() - 1; i >= 0; --i) {
+        const int dim = outer_dims[i];
+        const int64 index = outer % new_dims[dim];
+        outer /= new_dims[dim];
+        in_offset += index * in_strides[dim];
+        out_offset += index * out_strides[out_position[dim]];
+      }
+      const T* in_tile = p + in_offset + c0;
+      T* out_tile = q + out_offset + c0 * out_row_stride;
+      int64 r0 = r_begin;
+      if (c1 - c0 == kTile) {
+        for (; r0 + kTile <= r_end; r0 += kTile) {
+          TransposeTile<T, conjugate, kTile, kTile>(
+              in_tile + r0 * in_row_stride, in_row_stride, out_tile + r0,
+              out_row_stride);
+        }
+      }
+      TransposeTile<T, conjugate>(in_tile + r0 * in_row_stride, in_row_stride,
+                                  out_tile + r0, out_row_stride, r_end - r0,
+                                  c1 - c0);
+    }
+  };
+  const int64 elements_per_unit = kTile * std::min(kRowBlock, num_rows);
+  Eigen::TensorOpCost cost(/*bytes_loaded=*/elements_per_unit * sizeof(T),
+                           /*bytes_stored=*/elements_per_unit * sizeof(T),
+                           /*compute_cycles=*/elements_per_unit);
+  device.parallelFor(num_outer * num_row_blocks * num_col_blocks, cost,
+                     transpose_fn);
+  return true;
+}
+
 }  // namespace
 
 template <typename T, bool conjugate>
 struct Transpose<CPUDevice, T, conjugate> {
   static void run(const CPUDevice& d, const Tensor& in,
                   const gtl::ArraySlice<int32> perm, Tensor* out) {
+    if (TransposeTiled<T, conjugate>(d, in, perm, out)) return;
     switch (in.dims()) {
       case 2:
         internal::TransposeUsingEigen<CPUDevice, T, 2>(d, in, perm, conjugate,
@@ -13,10 +13,18 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#define EIGEN_USE_THREADS
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/common_runtime/eigen_thread_pool.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/kernels/transpose_functor.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 
@@ -64,6 +72,12 @@ TEST_F(TransposeUtilTest, NormalDimensionReduction) {
   TestDimensionReduction({2, 3, 4, 5, 6}, {3, 4, 1, 2, 0}, {2, 1, 0},
                          {2, 12, 30});
 
+  TestDimensionReduction({2, 3, 4, 5}, {1, 3, 0, 2}, {1, 3, 0, 2},
+                         {2, 3, 4, 5});
+
+  TestDimensionReduction({2, 3, 4, 5, 6}, {3, 0, 4, 1, 2}, {2, 0, 3, 1},
+                         {2, 12, 5, 6});
+
   TestDimensionReduction({2, 3}, {1, 0}, {1, 0}, {2, 3});
 
   TestDimensionReduction({2, 3, 4}, {2, 0, 1}, {1, 0}, {6, 4});
@@ -130,4 +144,95 @@ TEST_F(TransposeUtilTest, NonSingletonDimensionAlignment) {
                                                      {0, 1, 2, 5, 4, 3}));
 }
 
+// Transposes a tensor counting up from 0 with DoTranspose on the CPU, and
+// checks that the result matches the Eigen shuffle.
+template <typename T, int NDIMS>
+void TestTransposeMatchesEigen(const TensorShape& shape,
+                               const gtl::ArraySlice<int32> perm) {
+  thread::ThreadPool threadpool(Env::Default(), "test", 4 /* num_threads */);
+  EigenThreadPoolWrapper wrapper(&threadpool);
+  Eigen::ThreadPoolDevice device(&wrapper, 4 /* num_threads */);
+
+  Tensor in(DataTypeToEnum<T>::value, shape);
+  auto in_flat = in.flat<T>();
+  for (int64 i = 0; i < in_flat.size(); ++i) in_flat(i) = static_cast<T>(i);
+  TensorShape out_shape;
+  for (const int32 dim : perm) out_shape.AddDim(shape.dim_size(dim));
+  Tensor out(DataTypeToEnum<T>::value, out_shape);
+  Tensor expected(DataTypeToEnum<T>::value, out_shape);
+  TF_ASSERT_OK(DoTranspose(device, in, perm, &out));
+  internal::TransposeUsingEigen<Eigen::ThreadPoolDevice, T, NDIMS>(
+      device, in, perm, /*conjugate=*/false, &expected);
+  test::ExpectTensorEqual<T>(expected, out);
+}
+
+TEST(TransposeFunctorTest, MatchesEigen) {
+  // Tall and skinny matrices, split into several blocks of rows.
+  TestTransposeMatchesEigen<float, 3>({2, 5000, 32}, {0, 2, 1});
+  TestTransposeMatchesEigen<int8, 3>({2, 32, 5001}, {0, 2, 1});
+  TestTransposeMatchesEigen<double, 2>({3001, 7}, {1, 0});
+  // Permutations that are not their own inverse.
+  TestTransposeMatchesEigen<float, 4>({8, 9, 10, 11}, {1, 3, 0, 2});
+  TestTransposeMatchesEigen<int8, 4>({2, 30, 40, 64}, {0, 2, 3, 1});
+  TestTransposeMatchesEigen<double, 5>({7, 8, 9, 10, 11}, {3, 0, 4, 1, 2});
+}
+
+// Times the CPU transpose (use_eigen == 0) against the Eigen shuffle it
+// replaces for permutations that move the innermost dimension.
+template <typename T, int NDIMS>
+void RunTransposeBenchmark(int iters, const TensorShape& shape,
+                           const gtl::ArraySlice<int32> perm, bool use_eigen) {
+  testing::StopTiming();
+  const int num_threads = port::NumSchedulableCPUs();
+  thread::ThreadPool threadpool(Env::Default(), "test", num_threads);
+  EigenThreadPoolWrapper wrapper(&threadpool);
+  Eigen::ThreadPoolDevice device(&wrapper, num_threads);
+
+  Tensor in(DataTypeToEnum<T>::value, shape);
+  in.flat<T>().setZero();
+  TensorShape out_shape;
+  for (const int32 dim : perm) out_shape.AddDim(shape.dim_size(dim));
+  Tensor out(DataTypeToEnum<T>::value, out_shape);
+  testing::BytesProcessed(static_cast<int64>(iters) * in.TotalBytes() * 2);
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    if (use_eigen) {
+      internal::TransposeUsingEigen<Eigen::ThreadPoolDevice, T, NDIMS>(
+          device, in, perm, /*conjugate=*/false, &out);
+    } else {
+      TF_CHECK_OK(DoTranspose(device, in, perm, &out));
+    }
+  }
+  testing::StopTiming();
+}
+
+static void BM_TransposeNHWCToNCHW(int iters, int use_eigen) {
+  RunTransposeBenchmark<float, 4>(iters, {2, 300, 300, 32}, {0, 3, 1, 2},
+                                  use_eigen);
+}
+BENCHMARK(BM_TransposeNHWCToNCHW)->Arg(0)->Arg(1);
+
+static void BM_TransposeNCHWToNHWC(int iters, int use_eigen) {
+  RunTransposeBenchmark<float, 4>(iters, {2, 32, 300, 300}, {0, 2, 3, 1},
+                                  use_eigen);
+}
+BENCHMARK(BM_TransposeNCHWToNHWC)->Arg(0)->Arg(1);
+
+static void BM_TransposeTallSkinny(int iters, int use_eigen) {
+  RunTransposeBenchmark<float, 3>(iters, {2, 100000, 32}, {0, 2, 1},
+                                  use_eigen);
+}
+BENCHMARK(BM_TransposeTallSkinny)->Arg(0)->Arg(1);
+
+static void BM_TransposeTallSkinnyInt8(int iters, int use_eigen) {
+  RunTransposeBenchmark<int8, 3>(iters, {2, 100000, 64}, {0, 2, 1},
+                                 use_eigen);
+}
+BENCHMARK(BM_TransposeTallSkinnyInt8)->Arg(0)->Arg(1);
+
+static void BM_TransposeSquare(int iters, int use_eigen) {
+  RunTransposeBenchmark<float, 2>(iters, {2048, 2048}, {1, 0}, use_eigen);
+}
+BENCHMARK(BM_TransposeSquare)->Arg(0)->Arg(1);
+
 }  // namespace tensorflow
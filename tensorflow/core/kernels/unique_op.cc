@@ -13,9 +13,11 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <functional>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -23,7 +25,9 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/kernels/bounds_check.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -106,6 +110,14 @@ class UniqueOp : public OpKernel {
       auto Tin = input.flat<T>();
       const int64 N = static_cast<int64>(Tin.size());
 
+      auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+      const int num_partitions = static_cast<int>(std::min<int64>(
+          worker_threads->num_threads, N / kMinElementsPerPartition));
+      if (num_partitions > 1) {
+        ComputeParallel(context, input, num_partitions, idx_vec);
+        return;
+      }
+
       std::unordered_map<T, TIndex> uniq;
       uniq.reserve(2 * N);
       for (int64 i = 0, j = 0; i < N; ++i) {
@@ -191,6 +203,118 @@ class UniqueOp : public OpKernel {
       }
     }
   }
+
+ private:
+  // Below this many elements per thread, the vector case is not worth
+  // parallelizing.
+  static constexpr int64 kMinElementsPerPartition = 32 * 1024;
+
+  // Returns the partition in [0, num_partitions) that handles 'value'.  The
+  // hash is mixed so that the partitions are balanced even for small integers,
+  // whose hash is the identity.
+  static int Partition(const T& value, int num_partitions) {
+    const uint64 h =
+        static_cast<uint64>(hash<T>{}(value)) * 0x9E3779B97F4A7C15ULL;
+    return static_cast<int>(((h >> 32) * num_partitions) >> 32);
+  }
+
+  // Computes unique over the elements of a vector on the CPU worker threads,
+  // giving the same results as the serial implementation.
+  //
+  // The input is split into as many contiguous blocks as there are
+  // partitions, and the values into partitions by hash.  Each partition finds
+  // the first occurrence of its values, in input order, with its own hash
+  // map.  Unique values are then numbered by first occurrence, block by block.
+  void ComputeParallel(OpKernelContext* context, const Tensor& input,
+                       int num_partitions,
+                       typename TTypes<TIndex>::Vec idx_vec) {
+    auto Tin = input.flat<T>();
+    const int64 N = static_cast<int64>(Tin.size());
+    const int64 block_size = (N + num_partitions - 1) / num_partitions;
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    auto parallel_for = [&](const std::function<void(int)>& fn) {
+      Shard(worker_threads->num_threads, worker_threads->workers,
+            num_partitions, block_size * 50,
+            [&fn](int64 start, int64 limit) {
+              for (int64 i = start; i < limit; ++i) fn(i);
+            });
+    };
+
+    // The positions of each block that fall in each partition, in order.
+    std::vector<std::vector<std::vector<TIndex>>> positions(
+        num_partitions, std::vector<std::vector<TIndex>>(num_partitions));
+    parallel_for([&](int block) {
+      const int64 end = std::min(N, (block + 1) * block_size);
+      for (int64 i = block * block_size; i < end; ++i) {
+        positions[block][Partition(Tin(i), num_partitions)].push_back(i);
+      }
+    });
+
+    // Maps each value to its first position and its number of occurrences,
+    // and each position to the first position of its value.
+    std::vector<gtl::FlatMap<T, std::pair<TIndex, TIndex>>> uniqs(
+        num_partitions);
+    std::vector<TIndex> first_positions(N);
+    parallel_for([&](int partition) {
+      auto& uniq = uniqs[partition];
+      for (int block = 0; block < num_partitions; ++block) {
+        for (const TIndex i : positions[block][partition]) {
+          auto it = uniq.insert({Tin(i), {i, 0}}).first;
+          ++it->second.second;
+          first_positions[i] = it->second.first;
+        }
+      }
+    });
+    positions.clear();
+
+    // Number the unique values by first occurrence.
+    std::vector<int64> block_offsets(num_partitions + 1, 0);
+    parallel_for([&](int block) {
+      const int64 end = std::min(N, (block + 1) * block_size);
+      for (int64 i = block * block_size; i < end; ++i) {
+        if (first_positions[i] == i) ++block_offsets[block + 1];
+      }
+    });
+    for (int block = 0; block < num_partitions; ++block) {
+      block_offsets[block + 1] += block_offsets[block];
+    }
+    const int64 uniq_size = block_offsets[num_partitions];
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(
+                                0, TensorShape({uniq_size}), &output));
+    auto Tout = output->flat<T>();
+    parallel_for([&](int block) {
+      const int64 end = std::min(N, (block + 1) * block_size);
+      int64 j = block_offsets[block];
+      for (int64 i = block * block_size; i < end; ++i) {
+        if (first_positions[i] == i) {
+          idx_vec(i) = j;
+          Tout(j) = Tin(i);
+          ++j;
+        }
+      }
+    });
+    // The first occurrences are numbered, the other positions can now be.
+    parallel_for([&](int block) {
+      const int64 end = std::min(N, (block + 1) * block_size);
+      for (int64 i = block * block_size; i < end; ++i) {
+        if (first_positions[i] != i) idx_vec(i) = idx_vec(first_positions[i]);
+      }
+    });
+
+    if (num_outputs() > 2) {
+      Tensor* count_output = nullptr;
+      OP_REQUIRES_OK(context, context->allocate_output(
+                                  2, TensorShape({uniq_size}), &count_output));
+      auto count_output_vec = count_output->template vec<TIndex>();
+      parallel_for([&](int partition) {
+        for (const auto& entry : uniqs[partition]) {
+          count_output_vec(idx_vec(entry.second.first)) = entry.second.second;
+        }
+      });
+    }
+  }
 };
 
 #define REGISTER_UNIQUE(type)                                    \
@@ -23,8 +23,11 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/where_op.h"
 
+#include <algorithm>
 #include <memory>
 #include <numeric>
+#include <vector>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -36,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
@@ -89,10 +93,13 @@ struct Where<CPUDevice, DIMS, T, TIndex> {
     }
   }
 
-  EIGEN_ALWAYS_INLINE static Status Compute(
-      OpKernelContext* ctx, const CPUDevice& d,
-      typename TTypes<T, DIMS>::ConstTensor input,
-      typename TTypes<int64>::Matrix output, TIndex* found_true) {
+  // Writes the indices of the true values among the elements [begin, end) of
+  // input into the rows of output starting at first_true, without writing
+  // past row end_true.  Returns the number of true values found.
+  static TIndex ComputeRange(typename TTypes<T, DIMS>::ConstTensor input,
+                             Eigen::DenseIndex begin, Eigen::DenseIndex end,
+                             typename TTypes<int64>::Matrix output,
+                             TIndex first_true, TIndex end_true) {
     Eigen::DSizes<Eigen::DenseIndex, DIMS> dims = input.dimensions();
     Eigen::DSizes<TIndex, DIMS> strides;
 
@@ -105,15 +112,24 @@ struct Where<CPUDevice, DIMS, T, TIndex> {
       strides[i] = strides[i + 1] * dims[i + 1];
     }
 
-    Eigen::DenseIndex output_size = output.dimension(0);
-    for (Eigen::DenseIndex n = 0; n < input.size(); ++n) {
+    TIndex true_n = first_true;
+    for (Eigen::DenseIndex n = begin; n < end; ++n) {
       if (input.data()[n] != T(0)) {
-        if (FastBoundsCheck(*found_true, output_size)) {
-          WriteIndexRowMajor(output, strides, *found_true, n);
+        if (true_n < end_true) {
+          WriteIndexRowMajor(output, strides, true_n, n);
         }
-        ++*found_true;
+        ++true_n;
       }
     }
+    return true_n - first_true;
+  }
+
+  EIGEN_ALWAYS_INLINE static Status Compute(
+      OpKernelContext* ctx, const CPUDevice& d,
+      typename TTypes<T, DIMS>::ConstTensor input,
+      typename TTypes<int64>::Matrix output, TIndex* found_true) {
+    *found_true += ComputeRange(input, 0, input.size(), output, *found_true,
+                                output.dimension(0));
     return Status::OK();
   }
 };
@@ -135,33 +151,46 @@ class WhereCPUOp : public OpKernel {
                               "creating costly copies from device."));
 
     const int input_dims = input.dims();
+    OP_REQUIRES(context, input_dims >= 1 && input_dims <= 5,
+                errors::InvalidArgument(
+                    "WhereOp : Unhandled input dimensions: ", input_dims));
+
+    // The input is split into blocks whose true values are counted, and then
+    // written, on the CPU worker threads.  block_true[b] is the number of true
+    // values before block b.
+    const int64 num_elements = input.NumElements();
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    const int64 num_blocks = std::max<int64>(
+        std::min<int64>(worker_threads->num_threads,
+                        num_elements / kMinBlockSize),
+        1);
+    const int64 block_size = (num_elements + num_blocks - 1) / num_blocks;
+    std::vector<int64> block_true(num_blocks + 1, 0);
+    const T* input_data = input.flat<T>().data();
+    Shard(worker_threads->num_threads, worker_threads->workers, num_blocks,
+          block_size, [&](int64 start, int64 limit) {
+            for (int64 b = start; b < limit; ++b) {
+              const int64 begin = b * block_size;
+              const int64 end = std::min(num_elements, begin + block_size);
+              block_true[b + 1] = functor::CountAccumulator<T>(
+                  input_data + begin, input_data + end);
+            }
+          });
+    for (int64 b = 0; b < num_blocks; ++b) {
+      block_true[b + 1] += block_true[b];
+    }
 
-    Tensor num_true;
-    OP_REQUIRES_OK(
-        context, context->allocate_temp(DT_INT64, TensorShape({}), &num_true));
-    auto num_true_t = num_true.scalar<int64>();
-
-    Status s = functor::NumTrue<CPUDevice, T, int64>::Compute(
-        context, context->eigen_device<CPUDevice>(), input.flat<T>(),
-        num_true_t);
-    OP_REQUIRES_OK(context, s);
-    TensorShape output_shape({num_true_t(), input_dims});
+    TensorShape output_shape({block_true[num_blocks], input_dims});
     Tensor* output = nullptr;
     OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
 
-    // TODO(ebrevdo): Replace single-threaded copy with a
-    // multithreaded block copy by getting block counts above instead
-    // of a global NumTrue, then having each block filled in in
-    // separate threads below.
-    int64 found_true = 0;
-
-#define HANDLE_DIM(NDIM)                                                      \
-  case NDIM: {                                                                \
-    Status s = functor::Where<CPUDevice, NDIM, T, int64>::Compute(            \
-        context, context->eigen_device<CPUDevice>(), input.tensor<T, NDIM>(), \
-        output->matrix<int64>(), &found_true);                                \
-    OP_REQUIRES_OK(context, s);                                               \
-  } break;
+    std::vector<int64> block_found_true(num_blocks);
+
+#define HANDLE_DIM(NDIM)                                               \
+  case NDIM:                                                           \
+    WriteIndices<NDIM>(context, input, block_size, block_true, output, \
+                       &block_found_true);                             \
+    break;
 
     switch (input_dims) {
       HANDLE_DIM(1);
@@ -169,24 +198,52 @@ class WhereCPUOp : public OpKernel {
       HANDLE_DIM(3);
       HANDLE_DIM(4);
       HANDLE_DIM(5);
-
-      default:
-        OP_REQUIRES(context, false,
-                    errors::InvalidArgument(
-                        "WhereOp : Unhandled input dimensions: ", input_dims));
     }
 #undef HANDLE_DIM
 
-    OP_REQUIRES(
-        context, found_true == num_true_t(),
-        errors::InvalidArgument(
-            "WhereOp: Race condition between counting the number of true "
-            "elements and writing them.  When counting, saw ",
-            num_true_t(), " elements; but when writing their indices, saw ",
-            found_true, " elements."));
+    for (int64 b = 0; b < num_blocks; ++b) {
+      const int64 num_true = block_true[b + 1] - block_true[b];
+      OP_REQUIRES(
+          context, block_found_true[b] == num_true,
+          errors::InvalidArgument(
+              "WhereOp: Race condition between counting the number of true "
+              "elements and writing them.  When counting, saw ",
+              num_true, " elements; but when writing their indices, saw ",
+              block_found_true[b], " elements."));
+    }
   }
 
  private:
+  // Inputs are split into blocks of at least this many elements.
+  static constexpr int64 kMinBlockSize = 32 * 1024;
+
+  // Writes the indices of the true values of each block of input at the rows
+  // of output given by block_true, and the number of true values actually
+  // found in each block into block_found_true.
+  template <int NDIM>
+  static void WriteIndices(OpKernelContext* context, const Tensor& input,
+                           int64 block_size,
+                           const std::vector<int64>& block_true,
+                           Tensor* output,
+                           std::vector<int64>* block_found_true) {
+    auto input_t = input.tensor<T, NDIM>();
+    auto output_t = output->matrix<int64>();
+    const int64 num_elements = input.NumElements();
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          block_found_true->size(), block_size * NDIM,
+          [&](int64 start, int64 limit) {
+            for (int64 b = start; b < limit; ++b) {
+              const int64 begin = b * block_size;
+              const int64 end = std::min(num_elements, begin + block_size);
+              (*block_found_true)[b] =
+                  functor::Where<CPUDevice, NDIM, T, int64>::ComputeRange(
+                      input_t, begin, end, output_t, block_true[b],
+                      block_true[b + 1]);
+            }
+          });
+  }
+
   TF_DISALLOW_COPY_AND_ASSIGN(WhereCPUOp);
 };
 
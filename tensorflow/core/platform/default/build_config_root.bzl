@@ -53,6 +53,14 @@ def tf_additional_gdr_deps():
       "//conditions:default": [],
   })
 
+def tf_additional_shm_deps():
+  return select({
+      str(Label("//tensorflow:with_shm_support")): [
+          str(Label("//tensorflow/contrib/shm:shm_server_lib")),
+      ],
+      "//conditions:default": [],
+  })
+
 def if_static(extra_deps, otherwise=[]):
   return select({
       str(Label("//tensorflow:framework_shared_object")): otherwise,
@@ -117,6 +117,16 @@ class DecodeCSVOpTest(test.TestCase):
 
     self._test(args, expected_out)
 
+  def testEscapedQuotesInSeveralFields(self):
+    args = {
+        "records": ['"a""b""",x,"""c"', '"d",y,"e""""f"'],
+        "record_defaults": [[""], [""], [""]]
+    }
+
+    expected_out = [[b'a"b"', b"d"], [b"x", b"y"], [b'"c', b'e""f']]
+
+    self._test(args, expected_out)
+
   def testMultiRecords(self):
     args = {
         "records": ["1.0,4,aa", "0.2,5,bb", "3,6,cc"],
@@ -297,6 +297,20 @@ class DynamicPartitionTest(test.TestCase):
       with self.assertRaisesOpError(r"partitions\[2\] = 99 is not in \[0, 4\)"):
         sess.run(partitions)
 
+  def testLargeErrorIndexOutOfRange(self):
+    num = 1000000
+    indices_list = np.zeros(num, dtype=np.int32)
+    indices_list[700000] = 7
+    indices_list[300001] = 5
+    with self.test_session() as sess:
+      data = constant_op.constant(np.arange(num), dtype=dtypes.float32)
+      indices = constant_op.constant(indices_list)
+      partitions = data_flow_ops.dynamic_partition(
+          data, indices, num_partitions=4)
+      with self.assertRaisesOpError(
+          r"partitions\[300001\] = 5 is not in \[0, 4\)"):
+        sess.run(partitions)
+
   def testScalarIndexOutOfRange(self):
     with self.test_session() as sess:
       bad = 17
@@ -207,6 +207,47 @@ class ResourceVariableOpsTest(test_util.TensorFlowTestCase):
     read = resource_variable_ops.read_variable_op(handle, dtype=dtypes.int32)
     self.assertEqual(self.evaluate(read), [[3]])
 
+  @test_util.run_in_graph_and_eager_modes()
+  def testScatterAddDuplicateIndices(self):
+    handle = resource_variable_ops.var_handle_op(
+        dtype=dtypes.float32, shape=[3, 2])
+    self.evaluate(
+        resource_variable_ops.assign_variable_op(
+            handle, constant_op.constant([[1, 1], [1, 1], [1, 1]],
+                                         dtype=dtypes.float32)))
+    self.evaluate(
+        resource_variable_ops.resource_scatter_add(
+            handle, [2, 0, 2, 2],
+            constant_op.constant([[1, 2], [3, 4], [5, 6], [7, 8]],
+                                 dtype=dtypes.float32)))
+    read = resource_variable_ops.read_variable_op(handle, dtype=dtypes.float32)
+    self.assertAllEqual(self.evaluate(read), [[4, 5], [1, 1], [14, 17]])
+    with self.assertRaisesRegexp(errors.InvalidArgumentError,
+                                 r"indices\[3\] = 3 is not in \[0, 3\)"):
+      self.evaluate(
+          resource_variable_ops.resource_scatter_sub(
+              handle, [0, 0, 1, 3, 3],
+              constant_op.constant([[1, 2]] * 5, dtype=dtypes.float32)))
+
+  @test_util.run_in_graph_and_eager_modes()
+  def testScatterAddReportsFirstBadIndex(self):
+    handle = resource_variable_ops.var_handle_op(
+        dtype=dtypes.float32, shape=[3, 2])
+    self.evaluate(
+        resource_variable_ops.assign_variable_op(
+            handle, constant_op.constant([[1, 1], [1, 1], [1, 1]],
+                                         dtype=dtypes.float32)))
+    for indices, message in [([5, 4], r"indices\[0\] = 5"),
+                             ([5, 4, 4], r"indices\[0\] = 5"),
+                             ([0, 4, 5, 4, 0], r"indices\[1\] = 4")]:
+      with self.assertRaisesRegexp(errors.InvalidArgumentError,
+                                   message + r" is not in \[0, 3\)"):
+        self.evaluate(
+            resource_variable_ops.resource_scatter_add(
+                handle, indices,
+                constant_op.constant([[1, 2]] * len(indices),
+                                     dtype=dtypes.float32)))
+
   @test_util.run_in_graph_and_eager_modes()
   def testScatterSub(self):
     handle = resource_variable_ops.var_handle_op(
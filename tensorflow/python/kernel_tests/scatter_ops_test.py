@@ -288,6 +288,29 @@ class ScatterTest(test.TestCase):
 
         self.assertAllEqual([False, True], var.eval())
 
+  def testLargeRepeatIndicesCpu(self):
+    # Large enough to be scattered by several threads.
+    np.random.seed(8)
+    indices = np.random.randint(500, size=2000)
+    updates = np.random.uniform(0.5, 1.5, size=(2000, 64))
+    old = np.random.randn(500, 64)
+    for tf_scatter, np_scatter in _TF_OPS_TO_NUMPY.items():
+      with self.test_session(use_gpu=False):
+        new = old.copy()
+        np_scatter(new, indices, updates)
+        ref = variables.Variable(old)
+        ref.initializer.run()
+        tf_scatter(ref, indices, updates).eval()
+        self.assertAllClose(ref.eval(), new)
+    for tf_scatter, np_scatter in _TF_OPS_TO_NUMPY_SCALAR.items():
+      with self.test_session(use_gpu=False):
+        new = old.copy()
+        np_scatter(new, indices, 1.25)
+        ref = variables.Variable(old)
+        ref.initializer.run()
+        tf_scatter(ref, indices, 1.25).eval()
+        self.assertAllClose(ref.eval(), new)
+
   def testScatterOutOfRangeCpu(self):
     for op, _ in _TF_OPS_TO_NUMPY.items():
       params = np.array([1, 2, 3, 4, 5, 6]).astype(np.float32)
@@ -72,6 +72,17 @@ class SegmentReductionHelper(test.TestCase):
     output = [o.reshape(slice_shape) for o in output]
     return np.array(output)
 
+  def _segmentReduceAt(self, segment_ids, x, ufunc, initial, num_segments,
+                       empty_value=None):
+    """Reduces the rows of x with a numpy ufunc, skipping negative ids."""
+    output = np.full((num_segments,) + x.shape[1:], initial, dtype=x.dtype)
+    valid = segment_ids >= 0
+    ufunc.at(output, segment_ids[valid], x[valid])
+    if empty_value is not None:
+      counts = np.bincount(segment_ids[valid], minlength=num_segments)
+      output[counts == 0] = empty_value
+    return output
+
   def _mean_cum_op(self, x, y):
     return (x[0] + y, x[1] + 1) if isinstance(x, tuple) else (x + y, 2)
 
@@ -126,6 +137,32 @@ class SegmentReductionOpTest(SegmentReductionHelper):
             # and may therefore vary dynamically.
             self.assertAllEqual(np_ans.shape[1:], tf_ans.shape[1:])
 
+  def testShardedValues(self):
+    # Large enough for the CPU kernel to split the output rows over several
+    # threads, with segment ids that skip some rows.
+    np.random.seed(0)
+    num_rows, num_col = 4000, 32
+    segment_ids = np.sort(np.random.randint(0, 1500, num_rows))
+    num_segments = segment_ids[-1] + 1
+    counts = np.bincount(segment_ids, minlength=num_segments)
+    np_x = np.random.randint(-100, 100, [num_rows, num_col]).astype(np.float64)
+    sums = self._segmentReduceAt(segment_ids, np_x, np.add, 0, num_segments)
+    means = sums / np.maximum(counts, 1)[:, np.newaxis]
+    expected = [
+        (math_ops.segment_sum, sums),
+        (math_ops.segment_mean, means),
+        (math_ops.segment_max,
+         self._segmentReduceAt(segment_ids, np_x, np.maximum, -np.inf,
+                               num_segments, empty_value=0)),
+        (math_ops.segment_min,
+         self._segmentReduceAt(segment_ids, np_x, np.minimum, np.inf,
+                               num_segments, empty_value=0)),
+    ]
+    with self.test_session(use_gpu=False):
+      for tf_op, np_ans in expected:
+        tf_ans = tf_op(data=np_x, segment_ids=segment_ids).eval()
+        self.assertAllClose(np_ans, tf_ans)
+
   def testSegmentIdsShape(self):
     shape = [4, 4]
     tf_x, _ = self._input(shape)
@@ -403,6 +440,37 @@ class UnsortedSegmentTest(SegmentReductionHelper):
       self.assertAllClose(unsorted_jacob_t, sorted_jacob_t)
       self.assertAllClose(unsorted_jacob_n, sorted_jacob_n)
 
+  def testShardedValues(self):
+    # Large enough for the CPU kernel to split the output segments over
+    # several threads, each of which scans all the segment ids.
+    np.random.seed(0)
+    num_rows, num_col, num_segments = 5000, 32, 700
+    segment_ids = np.random.randint(-1, num_segments, num_rows)
+    np_x = np.random.randint(-100, 100, [num_rows, num_col]).astype(np.float64)
+    lowest = np.finfo(np.float64).min
+    highest = np.finfo(np.float64).max
+    expected = [
+        (math_ops.unsorted_segment_sum,
+         self._segmentReduceAt(segment_ids, np_x, np.add, 0, num_segments)),
+        (math_ops.unsorted_segment_max,
+         self._segmentReduceAt(segment_ids, np_x, np.maximum, lowest,
+                               num_segments)),
+        (math_ops.unsorted_segment_min,
+         self._segmentReduceAt(segment_ids, np_x, np.minimum, highest,
+                               num_segments)),
+    ]
+    with self.test_session(use_gpu=False):
+      for tf_op, np_ans in expected:
+        tf_ans = tf_op(np_x, segment_ids, num_segments).eval()
+        self.assertAllEqual(np_ans, tf_ans)
+
+  def testZeroSegmentsAllDropped(self):
+    with self.test_session(use_gpu=False):
+      for _, _, tf_op, _ in self.ops_list:
+        data = np.ones([3, 2], dtype=np.float32)
+        s = tf_op(data, [-1, -1, -1], num_segments=0)
+        self.assertAllEqual(np.zeros([0, 2]), s.eval())
+
   def testBadIndices(self):
     # Note: GPU kernel does not return the out-of-range error needed for this
     # test, so this test is marked as cpu-only.
@@ -507,6 +575,35 @@ class SparseSegmentReductionOpTest(SparseSegmentReductionHelper):
           # and may therefore vary dynamically.
           self.assertAllEqual(np_ans.shape[1:], tf_ans.shape[1:])
 
+  def testShardedValues(self):
+    # Large enough for the CPU kernel to split the output rows over several
+    # threads, with segment ids that skip some rows.
+    np.random.seed(0)
+    num_rows, num_col, num_indices = 1000, 32, 4000
+    np_x = np.random.randint(-100, 100, [num_rows, num_col]).astype(np.float64)
+    indices = np.random.randint(0, num_rows, num_indices)
+    segment_ids = np.sort(np.random.randint(0, 1500, num_indices))
+    num_segments = segment_ids[-1] + 1
+    counts = np.bincount(segment_ids, minlength=num_segments)
+    sums = self._segmentReduceAt(segment_ids, np_x[indices], np.add, 0,
+                                 num_segments)
+    means = sums / np.maximum(counts, 1)[:, np.newaxis]
+    with self.test_session(use_gpu=False):
+      for tf_op, np_ans in [(math_ops.sparse_segment_sum, sums),
+                            (math_ops.sparse_segment_mean, means)]:
+        tf_ans = tf_op(
+            data=np_x, indices=indices, segment_ids=segment_ids).eval()
+        self.assertAllClose(np_ans, tf_ans)
+
+      # The error names the first bad index, whichever thread finds it.
+      indices[100] = num_rows
+      indices[3000] = -1
+      s = math_ops.sparse_segment_sum(
+          data=np_x, indices=indices, segment_ids=segment_ids)
+      with self.assertRaisesOpError(
+          r"indices\[100\] == 1000 out of range \[0, 1000\)"):
+        s.eval()
+
   def testSegmentIdsHole(self):
     tf_x, np_x = self._input([10, 4], dtype=dtypes_lib.float32)
     ops_list = [(np.add, None, math_ops.sparse_segment_sum), (
@@ -243,6 +243,19 @@ class SparseTensorDenseMatMulTest(test.TestCase):
             y = y.transpose() if adjoint_b else y
             self._testMatmul(x, y, adjoint_a, adjoint_b)
 
+  # Tests outputs wider than the column blocks of the parallel CPU kernel.
+  def testWideOutput(self):
+    np.random.seed(127)  # Repeatable results
+    for np_dtype in [np.float32, np.complex64]:
+      x = _maybe_complex(np.random.rand(50, 40).astype(np_dtype))
+      x[np.abs(x) < 0.7] = 0
+      y = _maybe_complex(np.random.randn(40, 2500).astype(np_dtype))
+      for adjoint_a in [True, False]:
+        for adjoint_b in [True, False]:
+          self._testMatmul(x.transpose() if adjoint_a else x,
+                           y.transpose() if adjoint_b else y, adjoint_a,
+                           adjoint_b)
+
 
 def _sparse_tensor_dense_vs_dense_matmul_benchmark_dense(x, y, adjoint_a,
                                                          adjoint_b):
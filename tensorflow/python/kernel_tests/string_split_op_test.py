@@ -25,6 +25,33 @@ from tensorflow.python.framework import errors_impl
 from tensorflow.python.ops import array_ops
 from tensorflow.python.ops import string_ops
 from tensorflow.python.platform import test
+from tensorflow.python.util import compat
+
+# Enough strings for the kernels to split them on several threads.
+_LARGE_BATCH_SIZE = 1000
+
+
+def _tokens(i):
+  """Returns the tokens of the i-th string of a large batch.
+
+  Some tokens are empty, and some contain the characters of the multi-character
+  separators used below.
+  """
+  return [
+      "" if (i + j) % 5 == 0 else "%d<%d>" % (i, j) if j % 3 == 0 else str(j)
+      for j in range(i % 9)
+  ]
+
+
+def _sparse_tokens(token_lists):
+  """Returns the indices, values and shape of the tokens of each string."""
+  indices = [[i, j]
+             for i, tokens in enumerate(token_lists)
+             for j in range(len(tokens))]
+  values = [compat.as_bytes(token) for tokens in token_lists
+            for token in tokens]
+  shape = [len(token_lists), max(len(tokens) for tokens in token_lists)]
+  return indices, values, shape
 
 
 class StringSplitOpTest(test.TestCase):
@@ -145,6 +172,35 @@ class StringSplitOpTest(test.TestCase):
       self.assertAllEqual(indices, [[0, 0], [1, 0], [2, 0]])
       self.assertAllEqual(shape, [3, 1])
 
+  def testStringSplitLargeBatchWithDelimiters(self):
+    # The tokens of each string are separated by "," or "|" in turn.
+    strings = []
+    for i in range(_LARGE_BATCH_SIZE):
+      tokens = _tokens(i)
+      strings.append("".join(
+          (",|"[(i + j) % 2] if j else "") + token
+          for j, token in enumerate(tokens)))
+
+    for skip_empty in (True, False):
+      expected = []
+      for i, string in enumerate(strings):
+        if not string:
+          expected.append([])
+        elif skip_empty:
+          expected.append([token for token in _tokens(i) if token])
+        else:
+          expected.append(_tokens(i))
+      expected_indices, expected_values, expected_shape = _sparse_tokens(
+          expected)
+
+      with self.test_session() as sess:
+        tokens = string_ops.string_split(
+            strings, delimiter=",|", skip_empty=skip_empty)
+        indices, values, shape = sess.run(tokens)
+        self.assertAllEqual(indices, expected_indices)
+        self.assertAllEqual(values.tolist(), expected_values)
+        self.assertAllEqual(shape, expected_shape)
+
 
 class StringSplitV2OpTest(test.TestCase):
 
@@ -241,6 +297,30 @@ class StringSplitV2OpTest(test.TestCase):
       self.assertAllEqual(values, [b"1", b"2 3", b"4", b"5    6  "])
       self.assertAllEqual(shape, [2, 2])
 
+  def testSplitV2LargeBatchMultiCharSeparator(self):
+    strings = ["<>".join(_tokens(i)) for i in range(_LARGE_BATCH_SIZE)]
+    expected_indices, expected_values, expected_shape = _sparse_tokens(
+        [string.split("<>") for string in strings])
+
+    with self.test_session() as sess:
+      tokens = string_ops.string_split_v2(strings, sep="<>")
+      indices, values, shape = sess.run(tokens)
+      self.assertAllEqual(indices, expected_indices)
+      self.assertAllEqual(values.tolist(), expected_values)
+      self.assertAllEqual(shape, expected_shape)
+
+  def testSplitV2LargeBatchMaxSplit(self):
+    strings = [",".join(_tokens(i)) for i in range(_LARGE_BATCH_SIZE)]
+    expected_indices, expected_values, expected_shape = _sparse_tokens(
+        [string.split(",", 2) for string in strings])
+
+    with self.test_session() as sess:
+      tokens = string_ops.string_split_v2(strings, sep=",", maxsplit=2)
+      indices, values, shape = sess.run(tokens)
+      self.assertAllEqual(indices, expected_indices)
+      self.assertAllEqual(values.tolist(), expected_values)
+      self.assertAllEqual(shape, expected_shape)
+
 
 if __name__ == "__main__":
   test.main()
@@ -182,6 +182,33 @@ class SubstrOpTest(test.TestCase):
       with self.assertRaises(errors_impl.InvalidArgumentError):
         substr = substr_op.eval()
 
+  def _testLargeElementWisePosLen(self, dtype):
+    # Enough strings for the kernel to take substrings on several threads.
+    test_string = [("string%d" % i).encode() for i in range(10000)]
+    position = np.array([i % 6 for i in range(10000)], dtype)
+    length = np.array([i % 4 for i in range(10000)], dtype)
+    expected_value = [
+        s[p:p + l] for s, p, l in zip(test_string, position, length)
+    ]
+
+    substr_op = string_ops.substr(test_string, position, length)
+    with self.test_session():
+      substr = substr_op.eval()
+      self.assertAllEqual(substr, expected_value)
+
+  def _testLargeOutOfRangeError(self, dtype):
+    # The out-of-range positions land in different shards; the error names the
+    # first of them.
+    test_string = [("string%d" % i).encode() for i in range(10000)]
+    position = np.zeros(10000, dtype)
+    position[[9876, 5000, 2345]] = 20
+    length = np.ones(10000, dtype)
+    substr_op = string_ops.substr(test_string, position, length)
+    with self.test_session():
+      with self.assertRaisesRegexp(errors_impl.InvalidArgumentError,
+                                   r"at index 2345\b"):
+        substr_op.eval()
+
   def _testMismatchPosLenShapes(self, dtype):
     test_string = [[b"ten", b"eleven", b"twelve"],
                    [b"thirteen", b"fourteen", b"fifteen"],
@@ -203,9 +230,11 @@ class SubstrOpTest(test.TestCase):
     self._testVectorStrings(dtype)
     self._testMatrixStrings(dtype)
     self._testElementWisePosLen(dtype)
+    self._testLargeElementWisePosLen(dtype)
     self._testBroadcast(dtype)
     self._testBadBroadcast(dtype)
     self._testOutOfRangeError(dtype)
+    self._testLargeOutOfRangeError(dtype)
     self._testMismatchPosLenShapes(dtype)
 
   def testInt32(self):
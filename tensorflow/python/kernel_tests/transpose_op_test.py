@@ -256,6 +256,28 @@ class TransposeTest(test.TestCase):
       self.assertAllEqual(np_ans, tf_ans)
       self.assertShapeEqual(np_ans, y)
 
+  def testLargeSizeCpu(self):
+    # Permutations that move the innermost dimension, for every element size.
+    # The last one stays a permutation that is not its own inverse after
+    # adjacent dimensions are merged.
+    large_shapes = [[300, 200, 3], [3, 500, 400], [2, 40, 30, 50],
+                    [20, 30, 40, 50], [2, 30000, 32], [8, 9, 10, 11]]
+    perms = [[1, 0, 2], [2, 1, 0], [0, 3, 1, 2], [2, 3, 0, 1], [0, 2, 1],
+             [1, 3, 0, 2]]
+    for dtype in [np.int8, np.float16, np.float32, np.float64, np.complex128]:
+      for input_shape, perm in zip(large_shapes, perms):
+        total_size = np.prod(input_shape)
+        inp = np.arange(total_size).astype(dtype).reshape(input_shape)
+        np_ans = self._np_transpose(inp, perm)
+        with self.test_session(use_gpu=False):
+          tf_ans = array_ops.transpose(inp, perm).eval()
+          self.assertAllEqual(np_ans, tf_ans)
+    inp = np.arange(20 * 30 * 40).reshape([20, 30, 40]) * (1 + 1j)
+    inp = inp.astype(np.complex64)
+    with self.test_session(use_gpu=False):
+      tf_ans = array_ops.transpose(inp, [2, 0, 1], conjugate=True).eval()
+      self.assertAllEqual(np.conj(self._np_transpose(inp, [2, 0, 1])), tf_ans)
+
   def testRandomizedSmallDimLargeSizeGPU(self):
     # If no GPU available, skip the test
     if not test.is_gpu_available(cuda_only=True):
@@ -88,6 +88,17 @@ class UniqueTest(test.TestCase):
     for i in range(len(x)):
       self.assertEqual(x[i], tf_y[tf_idx[i]])
 
+  def testLargeInt64(self):
+    # Large enough to be partitioned across threads.
+    x = np.random.randint(0, high=50000, size=300000).astype(np.int64)
+    with self.test_session() as sess:
+      y, idx = array_ops.unique(x)
+      tf_y, tf_idx = sess.run([y, idx])
+
+    _, first_positions = np.unique(x, return_index=True)
+    self.assertAllEqual(x[np.sort(first_positions)], tf_y)
+    self.assertAllEqual(x, tf_y[tf_idx])
+
 
 class UniqueWithCountsTest(test.TestCase):
 
@@ -166,6 +177,21 @@ class UniqueWithCountsTest(test.TestCase):
     for value, count in zip(tf_y, tf_count):
       self.assertEqual(count, np.sum(x == value))
 
+  def testLargeString(self):
+    # Large enough to be partitioned across threads.
+    indx = np.random.randint(0, high=1000, size=100000)
+    x = [str(i) for i in indx]
+    with self.test_session() as sess:
+      y, idx, count = array_ops.unique_with_counts(x)
+      tf_y, tf_idx, tf_count = sess.run([y, idx, count])
+
+    uniq, first_positions, counts = np.unique(
+        indx, return_index=True, return_counts=True)
+    order = np.argsort(first_positions)
+    self.assertAllEqual([str(i).encode('ascii') for i in uniq[order]], tf_y)
+    self.assertAllEqual(counts[order], tf_count)
+    self.assertAllEqual(x, [tf_y[i].decode('ascii') for i in tf_idx])
+
 
 if __name__ == '__main__':
   test.main()
@@ -153,6 +153,23 @@ class TransposeBenchmark(test.Benchmark):
       for ishape, perm in zip(small_dim_small_shapes, small_dim_perms):
         self._run_graph("gpu", ishape, perm, num_iters, datatype)
 
+  def benchmark_transpose_cpu(self):
+    # The blocked CPU transpose is timed against the Eigen shuffle it replaces
+    # by the BM_Transpose* benchmarks in core/kernels/transpose_util_test.cc.
+    print("transpose cpu benchmark:")
+
+    datatypes = [np.complex128, np.float64, np.float32, np.float16, np.int8]
+
+    shapes = [[2, 40, 40, 40, 32], [2, 300, 300, 32], [2, 300, 300, 32],
+              [2, 100000, 32], [2048, 2048], [8, 90, 100, 110]]
+    perms = [[0, 2, 3, 4, 1], [0, 3, 1, 2], [0, 2, 3, 1], [0, 2, 1], [1, 0],
+             [1, 3, 0, 2]]
+
+    num_iters = 10
+    for datatype in datatypes:
+      for ishape, perm in zip(shapes, perms):
+        self._run_graph("cpu", ishape, perm, num_iters, datatype)
+
 
 if __name__ == "__main__":
   test.main()